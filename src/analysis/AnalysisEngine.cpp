@@ -39,6 +39,7 @@ using namespace casita::io;
 
 AnalysisEngine::AnalysisEngine( uint32_t mpiRank, uint32_t mpiSize ) :
   mpiAnalysis( mpiRank, mpiSize ),
+  graphStore( NULL ),
   maxMetricClassId( 0 ),
   maxMetricMemberId( 0 ),
   maxAttributeId( 0 ),
@@ -85,12 +86,41 @@ AnalysisEngine::getMPIAnalysis()
   return mpiAnalysis;
 }
 
+/**
+ * Get the number of bytes held by the analysis data of the current interval
+ * (graph and pending MPI records).
+ * 
+ * @return number of bytes
+ */
+uint64_t
+AnalysisEngine::getMemoryUsage() const
+{
+  return getGraphBytes() + mpiAnalysis.getPendingBytes();
+}
+
 void
 AnalysisEngine::setDefinitionHandler( OTF2DefinitionHandler* defHandler )
 {
   this->defHandler = defHandler;
 }
 
+void
+AnalysisEngine::setGraphStore( GraphStore* store )
+{
+  this->graphStore = store;
+}
+
+/**
+ * Get the store of the analyzed graph.
+ * 
+ * @return graph store or NULL, if the graph is not stored
+ */
+GraphStore*
+AnalysisEngine::getGraphStore()
+{
+  return graphStore;
+}
+
 //\todo: not implemented for MPI
 void 
 AnalysisEngine::addDetectedParadigm( Paradigm paradigm )
@@ -260,8 +290,11 @@ AnalysisEngine::runAnalysis()
 
   UTILS_MSG( printStatus, "[0] 100%%" );
   
-  // apply rules on pending nodes
-  //analysis.processDeferredNodes( paradigm );
+  // match the registered MPI operations (collectives, and point-to-point 
+  // operations in bulk mode) and apply the MPI rules again on these nodes
+  mpiAnalysis.exchangePendingCommunication();
+  processDeferredNodes();
+  mpiAnalysis.clearPendingCommunication();
 
 //#ifdef DEBUG
 //  clock_t time_sanity_check = clock();
@@ -483,16 +516,39 @@ AnalysisEngine::addNewGraphNode( uint64_t            time,
   return node;
 }
 
+/**
+ * Delete the graph of the current interval and start a new one with the last
+ * MPI nodes as atomic begin nodes.
+ * 
+ * @param deferRelease keep the nodes and edges of the interval (e.g. for the 
+ *                     trace writer) until releaseInterval() is called
+ */
 void 
-AnalysisEngine::createIntermediateBegin()
+AnalysisEngine::createIntermediateBegin( bool deferRelease )
 {
 #if defined(SCOREP_USER_ENABLE)
   SCOREP_USER_REGION( "createIntermediateBegin", SCOREP_USER_REGION_TYPE_FUNCTION )
 #endif
+  
+  if( deferRelease )
+  {
+    // clean all lists in the graph, edges are deleted in releaseInterval()
+    graph.detachEdges( retiredEdgeEnds );
     
-  // clean all lists in the graph and delete edges, 
-  // node objects are deleted via the streams
-  graph.cleanup( true );
+    // the global source node is linked to the begin nodes of every interval
+    globalSourceNode->getOutEdgeList().clear();
+  }
+  else
+  {
+    // clean all lists in the graph and delete edges, 
+    // node objects are deleted via the streams
+    graph.cleanup( true );
+
+    // all edges are deleted now, hence the edges of the next interval can be 
+    // placed from the beginning of the edge slabs
+    Edge::getAllocator().reset();
+    Edge::getBlameAllocator().reset();
+  }
   
   // reset MPI-related objects (before deleting nodes!)
   this->getMPIAnalysis().reset();
@@ -520,6 +576,14 @@ AnalysisEngine::createIntermediateBegin()
     // \todo check for > 1
     if ( nodes.size() > 0 )
     {
+      // the node list is rebuilt, hence nodes that are kept must not refer
+      // to deleted stream predecessors
+      for ( EventStream::SortedGraphNodeList::const_iterator nIter = 
+              nodes.begin(); nIter != nodes.end(); ++nIter )
+      {
+        ( *nIter )->setStreamPredecessor( NULL );
+      }
+      
       //do not remove the last MPI collective leave node
       if( nodes.back()->isMPI() )
       {
@@ -535,6 +599,11 @@ AnalysisEngine::createIntermediateBegin()
       // keep the first node (stream begin node) for MPI processes
       if( p->isMpiStream() )
       {
+        if( deferRelease )
+        {
+          retiredKeptNodes.push_back( *it );
+        }
+        
         ++it;
       }
       else if( p->isDeviceStream() )
@@ -632,7 +701,14 @@ AnalysisEngine::createIntermediateBegin()
         //UTILS_MSG( true , 
         //  "[%"PRIu64"] Delete node %s", p->getId(), getNodeInfo(*it).c_str() );
         
-        delete( *it );
+        if( deferRelease )
+        {
+          retiredNodes.push_back( *it );
+        }
+        else
+        {
+          delete( *it );
+        }
       }
 
       //check stream (e.g. pending MPI and other members)
@@ -647,6 +723,13 @@ AnalysisEngine::createIntermediateBegin()
     //if ( p->isHostStream() )
     {
       GraphNode* lastNode = p->getLastNode();
+      
+      // the node is still used as leave node, continue with a copy
+      if( deferRelease )
+      {
+        retiredNodes.push_back( lastNode );
+        lastNode = lastNode->copyNode();
+      }
 
       // set the stream's last node to type atomic (the collective end node)
       lastNode->setRecordType( RECORD_ATOMIC );
@@ -680,6 +763,30 @@ AnalysisEngine::createIntermediateBegin()
   }
 }
 
+/**
+ * Delete the nodes and edges of an interval that has been detached with 
+ * createIntermediateBegin( true ). 
+ */
+void
+AnalysisEngine::releaseInterval()
+{
+  Graph::releaseEdges( retiredEdgeEnds );
+  
+  for ( Graph::NodeList::const_iterator iter = retiredKeptNodes.begin();
+        iter != retiredKeptNodes.end(); ++iter )
+  {
+    ( *iter )->getOutEdgeList().clear();
+  }
+  retiredKeptNodes.clear();
+  
+  for ( Graph::NodeList::const_iterator iter = retiredNodes.begin();
+        iter != retiredNodes.end(); ++iter )
+  {
+    delete( *iter );
+  }
+  retiredNodes.clear();
+}
+
 void
 AnalysisEngine::reset()
 {
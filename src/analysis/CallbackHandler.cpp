@@ -22,7 +22,9 @@ using namespace casita::omp;
 
 CallbackHandler::CallbackHandler( AnalysisEngine& analysis ) :
   analysis( analysis ),
-  mpiRank( analysis.getMPIRank() )
+  mpiRank( analysis.getMPIRank() ),
+  nextCutTime( 0 ),
+  cutInterval( 0 )
 {
   
 }
@@ -39,6 +41,39 @@ CallbackHandler::setDefinitionHandler( OTF2DefinitionHandler* defHandler )
   this->defHandler = defHandler;
 }
 
+/**
+ * Cut the analysis intervals by trace time instead of at global collectives.
+ * 
+ * @param ticks time between two cuts in timer ticks (0 disables the cuts)
+ */
+void
+CallbackHandler::setCutInterval( uint64_t ticks )
+{
+  cutInterval = ticks;
+  nextCutTime = ticks;
+}
+
+/**
+ * @return time (in ticks) of the next interval cut
+ */
+uint64_t
+CallbackHandler::getNextCutTime() const
+{
+  return nextCutTime;
+}
+
+/**
+ * Set the time of the next interval cut, e.g. to the time all processes 
+ * agreed on.
+ * 
+ * @param time time of the next interval cut in ticks
+ */
+void
+CallbackHandler::setNextCutTime( uint64_t time )
+{
+  nextCutTime = time;
+}
+
 void
 CallbackHandler::printNode( GraphNode* node, EventStream* stream )
 {
@@ -315,6 +350,12 @@ CallbackHandler::handleEnter( OTF2TraceReader*  reader,
     stream->getPeriod().second = time;
   }
 
+  // region instances are stored for critical path predictions
+  if( analysis.getGraphStore() )
+  {
+    analysis.getGraphStore()->addRegionEnter( streamId, functionId, time );
+  }
+
   const RegionInfo& regionInfo = handler->defHandler->getRegionInfo( functionId );
   const char* funcName   = regionInfo.name;
   
@@ -346,9 +387,9 @@ CallbackHandler::handleEnter( OTF2TraceReader*  reader,
   FunctionDescriptor functionDesc;
   functionDesc.recordType = RECORD_ENTER; // needed to determine correct function type
   bool generateNode = 
-    FunctionTable::getAPIFunctionType( &functionDesc, funcName, regionInfo.paradigm,
+    handler->defHandler->getFunctionType( functionId, 
     stream->isDeviceStream(), analysis.getStreamGroup().deviceWithNullStreamOnly(), 
-    analysis.getMPISize() == 1 );
+    &functionDesc );
 
   // do not create nodes for CPU events and MPI events in 1-Process-Programs
   if( !generateNode )
@@ -416,6 +457,11 @@ CallbackHandler::handleLeave( OTF2TraceReader*  reader,
     stream->getPeriod().second = time;
   }
 
+  if( analysis.getGraphStore() )
+  {
+    analysis.getGraphStore()->addRegionLeave( streamId, functionId, time );
+  }
+
   const RegionInfo& regionInfo = handler->defHandler->getRegionInfo( functionId );
   const char* funcName   = regionInfo.name;
   
@@ -434,9 +480,9 @@ CallbackHandler::handleLeave( OTF2TraceReader*  reader,
   FunctionDescriptor regionDesc;
   regionDesc.recordType = RECORD_LEAVE; // needed to determine correct function type
   bool generateNode = 
-    FunctionTable::getAPIFunctionType( &regionDesc, funcName, regionInfo.paradigm,
+    handler->defHandler->getFunctionType( functionId, 
     stream->isDeviceStream(), analysis.getStreamGroup().deviceWithNullStreamOnly(),
-    analysis.getMPISize() == 1 );
+    &regionDesc );
 
   // do not create nodes for CPU events and MPI events in 1-Process-Programs
   if( !generateNode )
@@ -511,8 +557,9 @@ CallbackHandler::handleLeave( OTF2TraceReader*  reader,
     const MPIAnalysis::MPICommGroup& mpiCommGroup =
       analysis.getMPIAnalysis().getMPICommGroup( mpiGroupId ); 
 
-    // if the collective is global (collective group size == number of analysis ranks)
-    if ( mpiCommGroup.procs.size() == analysis.getMPISize() )
+    // if the collective is global (collective group size == number of MPI ranks)
+    if ( mpiCommGroup.procs.size() == 
+         analysis.getMPIAnalysis().getNumTracedRanks() )
     {
       // mark as global operation over all processes
       leaveNode->addType( MPI_ALLRANKS );
@@ -523,10 +570,32 @@ CallbackHandler::handleLeave( OTF2TraceReader*  reader,
                  "[%u] Global collective: %s", 
                  streamId, leaveNode->getUniqueName().c_str() );
       
-      return true;
+      // intervals are cut by time instead
+      if( handler->cutInterval == 0 )
+      {
+        return true;
+      }
     }
   }
   
+  // cut by trace time: every process stops at its first MPI leave after the
+  // cut time, which becomes the begin node of the next interval
+  if ( handler->cutInterval && analysis.getMPISize() > 1 && 
+       time >= handler->nextCutTime && leaveNode->isMPI() && 
+       !( leaveNode->isMPIInit() ) && !( leaveNode->isMPIFinalize() ) )
+  {
+    // the next cut is after the current time, as a long phase without MPI 
+    // would otherwise cut at every following MPI leave
+    handler->nextCutTime = 
+      ( time / handler->cutInterval + 1 ) * handler->cutInterval;
+    
+    UTILS_MSG( Parser::getInstance().getVerboseLevel() >= VERBOSE_ANNOY, 
+               "[%u] Interval cut at %s", 
+               streamId, leaveNode->getUniqueName().c_str() );
+    
+    return true;
+  }
+  
   return false;
 }
 
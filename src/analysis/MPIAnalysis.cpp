@@ -12,9 +12,13 @@
  * This class glues the analysis engines for all processes together.
  * - create communicators
  * - create remoteEdges
+ * - match MPI operations of several ranks per analysis process (M:N mode)
  *
  */
 
+#include <algorithm>
+#include <string.h>
+
 #include "MPIAnalysis.hpp"
 #include "AnalysisEngine.hpp"
 #include "common.hpp"
@@ -23,7 +27,8 @@ using namespace casita;
 
 MPIAnalysis::MPIAnalysis( uint32_t mpiRank, uint32_t mpiSize ) :
   mpiRank( mpiRank ),
-  mpiSize( mpiSize )
+  mpiSize( mpiSize ),
+  numTracedRanks( mpiSize )
 {
   globalCollectiveCounter = 0;
 }
@@ -101,6 +106,38 @@ MPIAnalysis::getMPIRank( uint64_t            streamId,
                      streamId );
 }
 
+/**
+ * Get the rank of a stream in a communicator of the trace, which is the 
+ * position of its MPI rank in the members of the communicator.
+ * 
+ * @param streamId MPI stream ID
+ * @param comRef OTF2 communicator reference
+ * 
+ * @return rank in the communicator (UINT32_MAX, if the stream is no member)
+ */
+uint32_t
+MPIAnalysis::getTracedCommRank( uint64_t streamId, uint32_t comRef ) const
+{
+  uint32_t worldRank = getMPIRank( streamId );
+  
+  // comRef 0 is the MPI world group
+  if ( comRef == 0 )
+  {
+    return worldRank;
+  }
+  
+  const std::vector< uint32_t >& procs = getMPICommGroup( comRef ).procs;
+  for ( size_t i = 0; i < procs.size(); ++i )
+  {
+    if ( procs[ i ] == worldRank )
+    {
+      return i;
+    }
+  }
+  
+  return UINT32_MAX;
+}
+
 /**
  * Save the MPI comm world rank for a given stream ID. This is done for every
  * stream/location in the program trace.
@@ -142,6 +179,55 @@ MPIAnalysis::getStreamId( int rank, uint32_t comRef )
   }
 }
 
+/**
+ * @return number of MPI ranks in the trace
+ */
+uint32_t
+MPIAnalysis::getNumTracedRanks() const
+{
+  return numTracedRanks;
+}
+
+/**
+ * In M:N mode an analysis process handles the streams of several MPI ranks of
+ * the trace. Communication between these ranks is resolved locally.
+ * 
+ * @return true, if there are more traced MPI ranks than analysis processes
+ */
+bool
+MPIAnalysis::isMultiRankMode() const
+{
+  return numTracedRanks > mpiSize;
+}
+
+/**
+ * In bulk mode blocking point-to-point operations are not replayed message by
+ * message. Their records are exchanged once per interval with the analysis
+ * processes of the partners (see exchangePendingCommunication()).
+ * 
+ * @return true, if in M:N mode, if enabled with --bulk-p2p or if intervals
+ *         are cut by time (--time-interval)
+ */
+bool
+MPIAnalysis::isBulkP2PMode() const
+{
+  return isMultiRankMode() || Parser::getOptions().bulkP2P ||
+         Parser::getOptions().timeInterval > 0;
+}
+
+/**
+ * Get the analysis process that handles the given MPI rank of the trace.
+ * 
+ * @param tracedRank MPI world rank in the trace
+ * 
+ * @return rank of the analysis process
+ */
+uint32_t
+MPIAnalysis::getAnalysisRank( uint32_t tracedRank ) const
+{
+  return casita::getAnalysisRank( tracedRank, numTracedRanks, mpiSize );
+}
+
 /**
  * Store OTF2 communicator ID with its location members.
  * 
@@ -164,6 +250,12 @@ MPIAnalysis::addMPICommGroup( uint32_t comId, uint32_t numProcs,
   {
     mpiCommGroupMap[ comId ].procs.clear();
   }
+  
+  // comId 0 is the group of all MPI ranks in the trace
+  if ( comId == 0 && numProcs > 0 )
+  {
+    numTracedRanks = numProcs;
+  }
 }
 
 void
@@ -184,10 +276,26 @@ MPIAnalysis::createMPICommunicatorsFromMap()
                       "Create communicator for %u:", iter->first );
     
       // copy the global ranks into an integer array
-      int ranks[ group.procs.size() ];
-      for( size_t i = 0; i < group.procs.size(); ++i )
+      std::vector< int > ranks;
+      if ( isMultiRankMode() )
+      {
+        // the communicator contains the analysis processes of all members
+        // (members of communicator 0 are stored as locations)
+        std::set< uint32_t > owners;
+        for( size_t i = 0; i < group.procs.size(); ++i )
+        {
+          owners.insert( 
+            getAnalysisRank( iter->first == 0 ? i : group.procs[ i ] ) );
+        }
+        ranks.assign( owners.begin(), owners.end() );
+      }
+      else
+      {
+        ranks.assign( group.procs.begin(), group.procs.end() );
+      }
+      
+      for( size_t i = 0; i < ranks.size(); ++i )
       {
-        ranks[ i ] = group.procs[ i ];
         UTILS_MSG_NOBR( mpiRank == 0 && Parser::getVerboseLevel() >= VERBOSE_BASIC, 
                         " %i", ranks[ i ] );
       }
@@ -198,7 +306,7 @@ MPIAnalysis::createMPICommunicatorsFromMap()
       MPI_CHECK( MPI_Comm_group( MPI_COMM_WORLD, &worldGroup ) );
       
       // use worldGroup and take only members listed in ranks
-      MPI_CHECK( MPI_Group_incl( worldGroup, group.procs.size(), ranks,
+      MPI_CHECK( MPI_Group_incl( worldGroup, ranks.size(), &ranks[ 0 ],
                                  &commGroup ) );
       
       // create a new communicator from the parent communicator MPI_COMM_WORLD
@@ -281,12 +389,650 @@ MPIAnalysis::removeRemoteNode( GraphNode* localNode )
   remoteNodeMap.erase( localNode );
 }
 
+/**
+ * Register a blocking point-to-point operation for the bulk matching with its
+ * communication partner in exchangePendingCommunication(). An MPI_Sendrecv is
+ * registered once for each direction.
+ * 
+ * @param leave leave node of the MPI operation
+ * @param direction send or receive side of the message
+ * @param comRef OTF2 communicator reference
+ * @param partnerRank rank of the communication partner in the communicator
+ * @param tag message tag
+ */
+void
+MPIAnalysis::addPendingP2P( GraphNode* leave, MPIP2PDirection direction, 
+                            uint32_t comRef, int partnerRank, uint32_t tag )
+{
+  // a new entry is zero-initialized
+  PendingP2P& pending = pendingP2PMap[ leave ];
+  
+  GraphNode* enter = leave->getGraphPair().first;
+  uint64_t partnerStreamId = getStreamId( partnerRank, comRef );
+  
+  uint64_t* record = pending.record[ direction ];
+  record[ P2P_START ]    = enter->getTime();
+  record[ P2P_END ]      = leave->getTime();
+  record[ P2P_ENTER_ID ] = enter->getId();
+  record[ P2P_LEAVE_ID ] = leave->getId();
+  record[ P2P_COMM ]     = comRef;
+  record[ P2P_TAG ]      = tag;
+  record[ P2P_DIR ]      = direction;
+  
+  if ( leave->isMPISendRecv() )
+  {
+    record[ P2P_TYPE ] = MPI_SEND | MPI_RECV;
+  }
+  else
+  {
+    record[ P2P_TYPE ] = ( direction == MPI_P2P_SEND ) ? MPI_SEND : MPI_RECV;
+  }
+  
+  if ( direction == MPI_P2P_SEND )
+  {
+    record[ P2P_SRC ] = leave->getStreamId();
+    record[ P2P_DST ] = partnerStreamId;
+  }
+  else
+  {
+    record[ P2P_SRC ] = partnerStreamId;
+    record[ P2P_DST ] = leave->getStreamId();
+  }
+  
+  // messages between two streams with the same tag and communicator are 
+  // non-overtaking, hence the sequence number identifies the partner
+  P2PKey key;
+  key.comRef = comRef;
+  key.src    = record[ P2P_SRC ];
+  key.dst    = record[ P2P_DST ];
+  key.tag    = tag;
+  key.seq    = 0;
+  record[ P2P_SEQ ] = p2pSequenceMap[ direction ][ key ]++;
+  
+  pending.valid[ direction ]        = true;
+  pending.partnerOwner[ direction ] = 
+    getAnalysisRank( getMPIRank( partnerStreamId ) );
+}
+
+/**
+ * @param leave leave node of a blocking MPI point-to-point operation
+ * 
+ * @return true, if the operation has been registered with addPendingP2P()
+ */
+bool
+MPIAnalysis::hasPendingP2P( GraphNode* leave ) const
+{
+  return pendingP2PMap.count( leave ) > 0;
+}
+
+/**
+ * Get the record of the communication partner after the bulk matching. The 
+ * buffer has the same layout as in the MPI replay of the rules.
+ * 
+ * @param leave leave node of the local MPI operation
+ * @param direction side of the message that is handled by the local node
+ * @param buffer buffer for CASITA_MPI_P2P_BUF_SIZE elements
+ * 
+ * @return false, if no matching partner operation has been found
+ */
+bool
+MPIAnalysis::getP2PPartner( GraphNode* leave, MPIP2PDirection direction,
+                            uint64_t* buffer ) const
+{
+  PendingP2PMap::const_iterator iter = pendingP2PMap.find( leave );
+  
+  if ( iter == pendingP2PMap.end() || !iter->second.matched[ direction ] )
+  {
+    return false;
+  }
+  
+  memcpy( buffer, iter->second.partner[ direction ], 
+          CASITA_MPI_P2P_BUF_SIZE * sizeof( uint64_t ) );
+  
+  return true;
+}
+
+/**
+ * Register a collective operation for the bulk matching with all other
+ * members of the communicator in exchangePendingCommunication(). The n-th
+ * collective of a stream on a communicator is matched with the n-th
+ * collective of all other streams on this communicator. Instances of local
+ * streams are combined immediately.
+ * 
+ * @param leave leave node of the MPI collective
+ * @param comRef OTF2 communicator reference
+ */
+void
+MPIAnalysis::addPendingCollective( GraphNode* leave, uint32_t comRef )
+{
+  GraphNode* enter = leave->getGraphPair().first;
+  
+  // instances are counted over all intervals
+  uint32_t instance = 
+    collectiveCounterMap[ std::make_pair( leave->getStreamId(), comRef ) ]++;
+  
+  uint64_t base = collectiveBaseMap[ comRef ];
+  if ( instance < base )
+  {
+    UTILS_WARNING( "[%" PRIu32 "] Collective instance %" PRIu32 " on "
+                   "communicator %" PRIu32 " has already been completed!", 
+                   mpiRank, instance, comRef );
+    
+    pendingCollectiveMap[ leave ] = std::make_pair( comRef, UINT32_MAX );
+    return;
+  }
+  
+  // index of the instance in the data of this interval
+  instance -= base;
+  
+  std::vector< uint64_t >& data = collectiveDataMap[ comRef ];
+  while ( data.size() < ( instance + 1 ) * COLL_RECORD_SIZE )
+  {
+    addEmptyCollectiveInstance( data );
+  }
+  
+  uint64_t local[ COLL_RECORD_SIZE ];
+  local[ COLL_MAX_ENTER ]      = enter->getTime();
+  local[ COLL_LAST_STREAM ]    = leave->getStreamId();
+  local[ COLL_LAST_COMM_RANK ] = 
+    getTracedCommRank( leave->getStreamId(), comRef );
+  local[ COLL_LAST_ENTER_ID ]  = enter->getId();
+  local[ COLL_MIN_ENTER ]      = enter->getTime();
+  local[ COLL_OFFSET_SUM ]     = 0;
+  local[ COLL_COUNT ]          = 1;
+  
+  mergeCollectiveInstance( local, &data[ instance * COLL_RECORD_SIZE ] );
+  
+  pendingCollectiveMap[ leave ] = std::make_pair( comRef, instance );
+}
+
+/**
+ * @param leave leave node of an MPI collective
+ * 
+ * @return true, if the collective has been registered with addPendingCollective()
+ */
+bool
+MPIAnalysis::hasPendingCollective( GraphNode* leave ) const
+{
+  return pendingCollectiveMap.count( leave ) > 0;
+}
+
+/**
+ * Get the matched collective after exchangePendingCommunication().
+ * 
+ * @param leave leave node of the MPI collective
+ * @param result last entering stream and total waiting time of the collective
+ * 
+ * @return false, if the collective has not been registered
+ */
+bool
+MPIAnalysis::getCollectiveResult( GraphNode* leave, 
+                                  CollectiveResult& result ) const
+{
+  PendingCollectiveMap::const_iterator iter = pendingCollectiveMap.find( leave );
+  if ( iter == pendingCollectiveMap.end() )
+  {
+    return false;
+  }
+  
+  // no data available: the local stream is the last entering one
+  if ( iter->second.second == UINT32_MAX )
+  {
+    GraphNode* enter = leave->getGraphPair().first;
+    
+    result.lastEnterTime   = enter->getTime();
+    result.lastStreamId    = leave->getStreamId();
+    result.lastEnterNodeId = enter->getId();
+    result.totalBlame      = 0;
+    
+    return true;
+  }
+  
+  const uint64_t* data = 
+    &( collectiveDataMap.find( iter->second.first )->second[ iter->second.second * 
+                                                      COLL_RECORD_SIZE ] );
+  
+  result.lastEnterTime   = data[ COLL_MAX_ENTER ];
+  result.lastStreamId    = data[ COLL_LAST_STREAM ];
+  result.lastEnterNodeId = data[ COLL_LAST_ENTER_ID ];
+  
+  // sum of ( last enter time - enter time ) over all members
+  result.totalBlame = 
+    data[ COLL_COUNT ] * ( data[ COLL_MAX_ENTER ] - data[ COLL_MIN_ENTER ] ) -
+    data[ COLL_OFFSET_SUM ];
+  
+  return true;
+}
+
+/**
+ * Append an empty collective instance, which is the neutral element of 
+ * mergeCollectiveInstance().
+ * 
+ * @param data collective instances of a communicator
+ */
+void
+MPIAnalysis::addEmptyCollectiveInstance( std::vector< uint64_t >& data )
+{
+  data.push_back( 0 );          // COLL_MAX_ENTER
+  data.push_back( UINT64_MAX ); // COLL_LAST_STREAM
+  data.push_back( UINT64_MAX ); // COLL_LAST_COMM_RANK
+  data.push_back( 0 );          // COLL_LAST_ENTER_ID
+  data.push_back( UINT64_MAX ); // COLL_MIN_ENTER
+  data.push_back( 0 );          // COLL_OFFSET_SUM
+  data.push_back( 0 );          // COLL_COUNT
+}
+
+/**
+ * Combine two (partially reduced) instances of a collective operation. The 
+ * stream with the latest enter is the last entering stream. If the enter times
+ * are equal, the stream with the lowest rank in the communicator is used (the
+ * first one in rank order, as with the former MPI_Allgather per collective).
+ * 
+ * @param in collective instance
+ * @param inout collective instance that is updated
+ */
+void
+MPIAnalysis::mergeCollectiveInstance( const uint64_t* in, uint64_t* inout )
+{
+  if ( in[ COLL_COUNT ] == 0 )
+  {
+    return;
+  }
+  
+  if ( inout[ COLL_COUNT ] == 0 )
+  {
+    memcpy( inout, in, COLL_RECORD_SIZE * sizeof( uint64_t ) );
+    return;
+  }
+  
+  if ( in[ COLL_MAX_ENTER ] > inout[ COLL_MAX_ENTER ] ||
+       ( in[ COLL_MAX_ENTER ] == inout[ COLL_MAX_ENTER ] && 
+         in[ COLL_LAST_COMM_RANK ] < inout[ COLL_LAST_COMM_RANK ] ) )
+  {
+    inout[ COLL_MAX_ENTER ]      = in[ COLL_MAX_ENTER ];
+    inout[ COLL_LAST_STREAM ]    = in[ COLL_LAST_STREAM ];
+    inout[ COLL_LAST_COMM_RANK ] = in[ COLL_LAST_COMM_RANK ];
+    inout[ COLL_LAST_ENTER_ID ]  = in[ COLL_LAST_ENTER_ID ];
+  }
+  
+  // rebase the enter time offsets to the new minimum to avoid overflows
+  uint64_t minEnter = std::min( in[ COLL_MIN_ENTER ], inout[ COLL_MIN_ENTER ] );
+  
+  inout[ COLL_OFFSET_SUM ] = 
+    inout[ COLL_OFFSET_SUM ] + 
+    inout[ COLL_COUNT ] * ( inout[ COLL_MIN_ENTER ] - minEnter ) +
+    in[ COLL_OFFSET_SUM ] + in[ COLL_COUNT ] * ( in[ COLL_MIN_ENTER ] - minEnter );
+  
+  inout[ COLL_MIN_ENTER ] = minEnter;
+  inout[ COLL_COUNT ]    += in[ COLL_COUNT ];
+}
+
+/**
+ * User-defined MPI reduction for collective instances.
+ */
+void
+MPIAnalysis::collectiveReduceOp( void* in, void* inout, int* len,
+                                 MPI_Datatype* type )
+{
+  const uint64_t* inData    = ( const uint64_t* ) in;
+  uint64_t*       inoutData = ( uint64_t* ) inout;
+  
+  for ( int i = 0; i < *len; ++i )
+  {
+    mergeCollectiveInstance( inData + i * COLL_RECORD_SIZE, 
+                             inoutData + i * COLL_RECORD_SIZE );
+  }
+}
+
+/**
+ * Match all pending point-to-point and collective operations of the current
+ * analysis interval. Has to be called by all analysis processes.
+ */
+void
+MPIAnalysis::exchangePendingCommunication()
+{
+  // point-to-point operations are only deferred in bulk mode
+  if ( isBulkP2PMode() )
+  {
+    exchangePendingP2P();
+  }
+  
+  exchangePendingCollectives();
+}
+
+/**
+ * Send the records of all pending point-to-point operations to the analysis
+ * processes of their communication partners with a single MPI_Alltoallv and
+ * match them with the local records. Partners on the same analysis process
+ * are matched without communication.
+ */
+void
+MPIAnalysis::exchangePendingP2P()
+{
+  // records with the same key, separated by the side of the message
+  P2PRecordMap recordMap[ 2 ];
+  
+  std::vector< std::vector< uint64_t > > sendRecords( mpiSize );
+  
+  // records of previous intervals are offered to the partners again
+  for ( std::vector< CarriedP2P >::const_iterator iter = carriedP2P.begin();
+        iter != carriedP2P.end(); ++iter )
+  {
+    const uint64_t* record = iter->record;
+    
+    if ( iter->owner == mpiRank )
+    {
+      P2PKey key = { record[ P2P_COMM ], record[ P2P_SRC ], record[ P2P_DST ],
+                     record[ P2P_TAG ], record[ P2P_SEQ ] };
+      recordMap[ record[ P2P_DIR ] ][ key ] = record;
+    }
+    else
+    {
+      sendRecords[ iter->owner ].insert( sendRecords[ iter->owner ].end(), 
+                                         record, record + P2P_RECORD_SIZE );
+    }
+  }
+  
+  for ( PendingP2PMap::const_iterator iter = pendingP2PMap.begin();
+        iter != pendingP2PMap.end(); ++iter )
+  {
+    for ( int dir = MPI_P2P_SEND; dir <= MPI_P2P_RECV; ++dir )
+    {
+      if ( !iter->second.valid[ dir ] )
+      {
+        continue;
+      }
+      
+      const uint64_t* record = iter->second.record[ dir ];
+      uint32_t owner = iter->second.partnerOwner[ dir ];
+      
+      if ( owner == mpiRank )
+      {
+        P2PKey key = { record[ P2P_COMM ], record[ P2P_SRC ], record[ P2P_DST ],
+                       record[ P2P_TAG ], record[ P2P_SEQ ] };
+        recordMap[ dir ][ key ] = record;
+      }
+      else
+      {
+        sendRecords[ owner ].insert( sendRecords[ owner ].end(), record, 
+                                     record + P2P_RECORD_SIZE );
+      }
+    }
+  }
+  
+  // exchange the number of records
+  std::vector< int > sendCounts( mpiSize ), recvCounts( mpiSize );
+  std::vector< int > sendDispls( mpiSize ), recvDispls( mpiSize );
+  for ( uint32_t rank = 0; rank < mpiSize; ++rank )
+  {
+    sendCounts[ rank ] = sendRecords[ rank ].size() / P2P_RECORD_SIZE;
+  }
+  
+  MPI_CHECK( MPI_Alltoall( &sendCounts[ 0 ], 1, MPI_INT, 
+                           &recvCounts[ 0 ], 1, MPI_INT, MPI_COMM_WORLD ) );
+  
+  size_t sendTotal = 0, recvTotal = 0;
+  for ( uint32_t rank = 0; rank < mpiSize; ++rank )
+  {
+    sendDispls[ rank ] = sendTotal;
+    recvDispls[ rank ] = recvTotal;
+    sendTotal += sendCounts[ rank ];
+    recvTotal += recvCounts[ rank ];
+  }
+  
+  // concatenate the records and exchange them
+  std::vector< uint64_t > sendBuffer;
+  sendBuffer.reserve( sendTotal * P2P_RECORD_SIZE + 1 );
+  for ( uint32_t rank = 0; rank < mpiSize; ++rank )
+  {
+    sendBuffer.insert( sendBuffer.end(), sendRecords[ rank ].begin(),
+                       sendRecords[ rank ].end() );
+    std::vector< uint64_t >().swap( sendRecords[ rank ] );
+  }
+  
+  std::vector< uint64_t > recvBuffer( recvTotal * P2P_RECORD_SIZE + 1 );
+  
+  MPI_Datatype recordType;
+  MPI_CHECK( MPI_Type_contiguous( P2P_RECORD_SIZE, MPI_UINT64_T, &recordType ) );
+  MPI_CHECK( MPI_Type_commit( &recordType ) );
+  
+  sendBuffer.resize( sendTotal * P2P_RECORD_SIZE + 1 );
+  MPI_CHECK( MPI_Alltoallv( &sendBuffer[ 0 ], &sendCounts[ 0 ], 
+                            &sendDispls[ 0 ], recordType, 
+                            &recvBuffer[ 0 ], &recvCounts[ 0 ], 
+                            &recvDispls[ 0 ], recordType, MPI_COMM_WORLD ) );
+  
+  MPI_CHECK( MPI_Type_free( &recordType ) );
+  
+  for ( size_t i = 0; i < recvTotal; ++i )
+  {
+    const uint64_t* record = &recvBuffer[ i * P2P_RECORD_SIZE ];
+    P2PKey key = { record[ P2P_COMM ], record[ P2P_SRC ], record[ P2P_DST ],
+                   record[ P2P_TAG ], record[ P2P_SEQ ] };
+    recordMap[ record[ P2P_DIR ] ][ key ] = record;
+  }
+  
+  // carried records that still have no partner are kept (up to a maximum 
+  // number of intervals)
+  std::vector< CarriedP2P > stillCarried;
+  for ( std::vector< CarriedP2P >::const_iterator iter = carriedP2P.begin();
+        iter != carriedP2P.end(); ++iter )
+  {
+    const uint64_t* record = iter->record;
+    P2PKey key = { record[ P2P_COMM ], record[ P2P_SRC ], record[ P2P_DST ],
+                   record[ P2P_TAG ], record[ P2P_SEQ ] };
+    
+    if ( recordMap[ 1 - record[ P2P_DIR ] ].count( key ) == 0 && 
+         iter->age + 1 < P2P_MAX_CARRY_INTERVALS )
+    {
+      stillCarried.push_back( *iter );
+      stillCarried.back().age++;
+    }
+  }
+  
+  // match local records with the records of the opposite message side
+  size_t unmatched = 0;
+  for ( PendingP2PMap::iterator iter = pendingP2PMap.begin();
+        iter != pendingP2PMap.end(); ++iter )
+  {
+    PendingP2P& pending = iter->second;
+    for ( int dir = MPI_P2P_SEND; dir <= MPI_P2P_RECV; ++dir )
+    {
+      if ( !pending.valid[ dir ] )
+      {
+        continue;
+      }
+      
+      const uint64_t* record = pending.record[ dir ];
+      P2PKey key = { record[ P2P_COMM ], record[ P2P_SRC ], record[ P2P_DST ],
+                     record[ P2P_TAG ], record[ P2P_SEQ ] };
+      
+      // the partner handles the opposite side of the message
+      const P2PRecordMap& partnerMap = recordMap[ 1 - dir ];
+      P2PRecordMap::const_iterator partnerIter = partnerMap.find( key );
+      
+      if ( partnerIter != partnerMap.end() )
+      {
+        memcpy( pending.partner[ dir ], partnerIter->second, 
+                P2P_RECORD_SIZE * sizeof( uint64_t ) );
+        pending.matched[ dir ] = true;
+      }
+      else
+      {
+        unmatched++;
+        
+        // the partner might be in the next interval
+        CarriedP2P carried;
+        carried.owner = pending.partnerOwner[ dir ];
+        carried.age   = 0;
+        memcpy( carried.record, record, P2P_RECORD_SIZE * sizeof( uint64_t ) );
+        stillCarried.push_back( carried );
+      }
+    }
+  }
+  
+  // the received records are referenced in the record map until here
+  carriedP2P.swap( stillCarried );
+  
+  UTILS_MSG( unmatched > 0 && Parser::getVerboseLevel() >= VERBOSE_BASIC,
+             "[%" PRIu32 "] %lu MPI point-to-point operations without matching "
+             "partner operation in this interval", mpiRank, unmatched );
+}
+
+/**
+ * Reduce the pending collective instances over the analysis processes of each
+ * communicator with a single MPI_Allreduce per communicator.
+ */
+void
+MPIAnalysis::exchangePendingCollectives()
+{
+  // get the maximum number of collective instances per communicator
+  std::vector< uint64_t > numInstances( mpiCommGroupMap.size() + 1, 0 );
+  
+  size_t idx = 0;
+  for ( MPICommGroupMap::const_iterator iter = mpiCommGroupMap.begin();
+        iter != mpiCommGroupMap.end(); ++iter, ++idx )
+  {
+    CollectiveDataMap::const_iterator dataIter = 
+      collectiveDataMap.find( iter->first );
+    if ( dataIter != collectiveDataMap.end() )
+    {
+      numInstances[ idx ] = dataIter->second.size() / COLL_RECORD_SIZE;
+    }
+  }
+  
+  MPI_CHECK( MPI_Allreduce( MPI_IN_PLACE, &numInstances[ 0 ], 
+                            numInstances.size(), MPI_UINT64_T, MPI_MAX, 
+                            MPI_COMM_WORLD ) );
+  
+  MPI_Datatype instanceType;
+  MPI_CHECK( MPI_Type_contiguous( COLL_RECORD_SIZE, MPI_UINT64_T, &instanceType ) );
+  MPI_CHECK( MPI_Type_commit( &instanceType ) );
+  
+  MPI_Op reduceOp;
+  MPI_CHECK( MPI_Op_create( &collectiveReduceOp, 1, &reduceOp ) );
+  
+  idx = 0;
+  for ( MPICommGroupMap::const_iterator iter = mpiCommGroupMap.begin();
+        iter != mpiCommGroupMap.end(); ++iter, ++idx )
+  {
+    const MPICommGroup& group = iter->second;
+    
+    // ignore communicators without members or this process
+    if ( numInstances[ idx ] == 0 || group.comm == MPI_COMM_NULL || 
+         group.comm == MPI_COMM_SELF )
+    {
+      continue;
+    }
+    
+    std::vector< uint64_t >& data = collectiveDataMap[ iter->first ];
+    
+    // fill missing instances with empty instances
+    while ( data.size() < numInstances[ idx ] * COLL_RECORD_SIZE )
+    {
+      addEmptyCollectiveInstance( data );
+    }
+    
+    MPI_CHECK( MPI_Allreduce( MPI_IN_PLACE, &data[ 0 ], (int) numInstances[ idx ],
+                              instanceType, reduceOp, group.comm ) );
+    
+    // with time-based interval cuts, members of an instance can be in the next
+    // interval (cuts at global collectives complete all instances)
+    uint64_t complete = numInstances[ idx ];
+    if ( Parser::getOptions().timeInterval > 0 )
+    {
+      complete = 0;
+      while ( complete < numInstances[ idx ] && 
+              data[ complete * COLL_RECORD_SIZE + COLL_COUNT ] >= 
+                group.procs.size() )
+      {
+        complete++;
+      }
+    }
+    
+    // carry the incomplete instances, the partial data only on one process
+    if ( complete < numInstances[ idx ] )
+    {
+      int commRank = 0;
+      MPI_CHECK( MPI_Comm_rank( group.comm, &commRank ) );
+      
+      std::vector< uint64_t >& carried = carriedCollectives[ iter->first ];
+      if ( commRank == 0 )
+      {
+        carried.assign( data.begin() + complete * COLL_RECORD_SIZE, data.end() );
+      }
+      else
+      {
+        for ( uint64_t i = complete; i < numInstances[ idx ]; ++i )
+        {
+          addEmptyCollectiveInstance( carried );
+        }
+      }
+    }
+    
+    collectiveBaseMap[ iter->first ] += complete;
+  }
+  
+  MPI_CHECK( MPI_Op_free( &reduceOp ) );
+  MPI_CHECK( MPI_Type_free( &instanceType ) );
+}
+
+/**
+ * Remove all pending point-to-point and collective operations of the interval.
+ * Incomplete collective instances are kept for the next interval.
+ */
+void
+MPIAnalysis::clearPendingCommunication()
+{
+  pendingP2PMap.clear();
+  pendingCollectiveMap.clear();
+  
+  // sequence numbers and collective instances are counted over all intervals,
+  // as operations can be matched with operations of the previous interval
+  collectiveDataMap.clear();
+  collectiveDataMap.swap( carriedCollectives );
+}
+
+/**
+ * Estimate the number of bytes held by the pending MPI records of the current
+ * interval (remote nodes and operations that are matched in bulk). Each map
+ * entry is counted with the size of its value and the tree node overhead.
+ * 
+ * @return estimated number of bytes of the pending MPI records
+ */
+uint64_t
+MPIAnalysis::getPendingBytes() const
+{
+  // parent, left and right pointer plus color of a red-black tree node
+  const uint64_t MAP_NODE_BYTES = 4 * sizeof( void* );
+  
+  uint64_t bytes = 
+    remoteNodeMap.size() * 
+      ( sizeof( RemoteNodeMap::value_type ) + MAP_NODE_BYTES ) +
+    pendingP2PMap.size() * 
+      ( sizeof( PendingP2PMap::value_type ) + MAP_NODE_BYTES ) +
+    pendingCollectiveMap.size() * 
+      ( sizeof( PendingCollectiveMap::value_type ) + MAP_NODE_BYTES );
+  
+  for ( int dir = 0; dir < 2; ++dir )
+  {
+    bytes += p2pSequenceMap[ dir ].size() * 
+      ( sizeof( P2PSequenceMap::value_type ) + MAP_NODE_BYTES );
+  }
+  
+  bytes += carriedP2P.capacity() * sizeof( CarriedP2P );
+  
+  return bytes;
+}
+
 /**
  * Reset structures that are local to an interval in the trace.
  */
 void
 MPIAnalysis::reset()
 {
+  clearPendingCommunication();
+  
   // 
   if( remoteNodeMap.size() > 0 ) 
   {
@@ -27,6 +27,7 @@
 #include "omp/AnalysisParadigmOMP.hpp"
 
 #include "Statistics.hpp"
+#include "GraphStore.hpp"
 
 #include "otf/OTF2DefinitionHandler.hpp"
 #include "otf/OTF2TraceReader.hpp"
@@ -61,9 +62,18 @@ namespace casita
      MPIAnalysis&
      getMPIAnalysis();
      
+     uint64_t
+     getMemoryUsage() const;
+     
      void
      setDefinitionHandler( OTF2DefinitionHandler* defHandler );
      
+     void
+     setGraphStore( GraphStore* store );
+     
+     GraphStore*
+     getGraphStore();
+     
      void
      checkPendingMPIRequests();
      
@@ -107,7 +117,10 @@ namespace casita
      getAnalysis( Paradigm paradigm );
      
      void
-     createIntermediateBegin();
+     createIntermediateBegin( bool deferRelease = false );
+     
+     void
+     releaseInterval();
 
      void
      handlePostEnter( GraphNode* node );
@@ -179,6 +192,17 @@ namespace casita
      MPIAnalysis mpiAnalysis;
      
      Statistics statistics;
+     
+     //!< store of the analyzed graph (NULL, if the graph is not stored)
+     GraphStore* graphStore;
+
+     //!< nodes and edges (end nodes) of an interval that has been detached 
+     //!< with createIntermediateBegin( true ), but not yet deleted
+     Graph::NodeList retiredNodes;
+     Graph::NodeList retiredEdgeEnds;
+     
+     //!< nodes of a detached interval that are kept (out-edges are cleared)
+     Graph::NodeList retiredKeptNodes;
 
      // map of analysis paradigms
      typedef std::map< Paradigm, IAnalysisParadigm* > AnalysisParadigmsMap;
@@ -34,6 +34,15 @@ namespace casita
      
      void
      setDefinitionHandler( OTF2DefinitionHandler* defHandler);
+     
+     void
+     setCutInterval( uint64_t ticks );
+     
+     uint64_t
+     getNextCutTime() const;
+     
+     void
+     setNextCutTime( uint64_t time );
 
      void
      printNode( GraphNode* node, EventStream* stream );
@@ -146,6 +155,12 @@ namespace casita
      OTF2DefinitionHandler* defHandler;
      
      int mpiRank;
+     
+     //!< time (in ticks) of the next interval cut (--time-interval)
+     uint64_t nextCutTime;
+     
+     //!< time between two interval cuts in ticks (0, if not cut by time)
+     uint64_t cutInterval;
 
      /**
       * Get an uint32_t type attribute (or key-value) from the given key value list.
@@ -71,6 +71,22 @@ namespace casita
      } CriticalPathSection;
 
      typedef std::vector< CriticalPathSection > CriticalSectionsList;
+     
+     //<! side of a point-to-point message that is handled by a node
+     enum MPIP2PDirection
+     {
+       MPI_P2P_SEND = 0,
+       MPI_P2P_RECV = 1
+     };
+     
+     //<! result of a matched MPI collective
+     typedef struct
+     {
+       uint64_t lastEnterTime;   //<! enter time of the last entering stream
+       uint64_t lastStreamId;    //<! last entering stream
+       uint64_t lastEnterNodeId; //<! node ID of the last enter
+       uint64_t totalBlame;      //<! sum of all waiting times in the collective
+     } CollectiveResult;
 
      typedef std::map< uint64_t, MPIEdge > MPIIdEdgeMap;
      typedef std::map< uint64_t, MPIIdEdgeMap > MPIRemoteEdgeMap;
@@ -91,12 +107,27 @@ namespace casita
      
      uint32_t
      getMPIRank( uint64_t streamId, const MPICommGroup& commGroup ) const;
+     
+     uint32_t
+     getTracedCommRank( uint64_t streamId, uint32_t comRef ) const;
 
      void
      setMPIRank( uint64_t streamId, uint32_t rank );
      
      uint64_t
      getStreamId( int rank, uint32_t comRef );
+     
+     uint32_t
+     getNumTracedRanks() const;
+     
+     bool
+     isMultiRankMode() const;
+     
+     bool
+     isBulkP2PMode() const;
+     
+     uint32_t
+     getAnalysisRank( uint32_t tracedRank ) const;
 
      void
      addMPICommGroup( uint32_t        group,
@@ -124,18 +155,160 @@ namespace casita
      
      uint32_t
      getMpiPartnersRank( GraphNode* node );
+     
+     void
+     addPendingP2P( GraphNode* leave, MPIP2PDirection direction, 
+                    uint32_t comRef, int partnerRank, uint32_t tag );
+     
+     bool
+     hasPendingP2P( GraphNode* leave ) const;
+     
+     bool
+     getP2PPartner( GraphNode* leave, MPIP2PDirection direction,
+                    uint64_t* buffer ) const;
+     
+     void
+     addPendingCollective( GraphNode* leave, uint32_t comRef );
+     
+     bool
+     hasPendingCollective( GraphNode* leave ) const;
+     
+     bool
+     getCollectiveResult( GraphNode* leave, CollectiveResult& result ) const;
+     
+     void
+     exchangePendingCommunication();
+     
+     void
+     clearPendingCommunication();
+     
+     uint64_t
+     getPendingBytes() const;
 
      void
      reset();
 
    private:
+     //<! fields of an exchanged point-to-point record (the first fields 
+     //<! correspond to the MPI replay buffer, see CASITA_MPI_P2P_BUF_SIZE)
+     enum P2PRecordField
+     {
+       P2P_START = 0,
+       P2P_END,
+       P2P_ENTER_ID,
+       P2P_LEAVE_ID,
+       P2P_TYPE,
+       P2P_COMM,
+       P2P_SRC,   //<! sending stream
+       P2P_DST,   //<! receiving stream
+       P2P_TAG,
+       P2P_SEQ,   //<! message number for (comm, src, dst, tag)
+       P2P_DIR,
+       P2P_RECORD_SIZE
+     };
+     
+     //<! fields of a (partially) reduced collective instance
+     enum CollectiveField
+     {
+       COLL_MAX_ENTER = 0,
+       COLL_LAST_STREAM,
+       COLL_LAST_COMM_RANK, //<! communicator rank of the last entering stream
+       COLL_LAST_ENTER_ID,
+       COLL_MIN_ENTER,
+       COLL_OFFSET_SUM, //<! sum of all enter times relative to COLL_MIN_ENTER
+       COLL_COUNT,
+       COLL_RECORD_SIZE
+     };
+     
+     typedef struct P2PKey
+     {
+       uint64_t comRef;
+       uint64_t src;
+       uint64_t dst;
+       uint64_t tag;
+       uint64_t seq;
+       
+       bool
+       operator<( const P2PKey& other ) const
+       {
+         if ( comRef != other.comRef ) return comRef < other.comRef;
+         if ( src != other.src ) return src < other.src;
+         if ( dst != other.dst ) return dst < other.dst;
+         if ( tag != other.tag ) return tag < other.tag;
+         return seq < other.seq;
+       }
+     } P2PKey;
+     
+     typedef struct
+     {
+       bool     valid[ 2 ];
+       bool     matched[ 2 ];
+       uint32_t partnerOwner[ 2 ]; //<! analysis rank of the partner stream
+       uint64_t record[ 2 ][ P2P_RECORD_SIZE ];
+       uint64_t partner[ 2 ][ P2P_RECORD_SIZE ];
+     } PendingP2P;
+     
+     //<! record of an operation of a previous interval without partner
+     typedef struct
+     {
+       uint32_t owner; //<! analysis rank of the partner stream
+       uint32_t age;   //<! number of intervals the record has been carried
+       uint64_t record[ P2P_RECORD_SIZE ];
+     } CarriedP2P;
+     
+     typedef std::map< GraphNode*, PendingP2P > PendingP2PMap;
+     typedef std::map< P2PKey, uint64_t > P2PSequenceMap;
+     typedef std::map< P2PKey, const uint64_t* > P2PRecordMap;
+     typedef std::map< GraphNode*, std::pair< uint32_t, uint32_t > > PendingCollectiveMap;
+     typedef std::map< std::pair< uint64_t, uint32_t >, uint32_t > CollectiveCounterMap;
+     typedef std::map< uint32_t, std::vector< uint64_t > > CollectiveDataMap;
+     typedef std::map< uint32_t, uint64_t > CollectiveBaseMap;
+     
+     //<! number of intervals a point-to-point record waits for its partner
+     static const uint32_t P2P_MAX_CARRY_INTERVALS = 8;
+     
+     static void
+     addEmptyCollectiveInstance( std::vector< uint64_t >& data );
+     
+     static void
+     mergeCollectiveInstance( const uint64_t* in, uint64_t* inout );
+     
+     static void
+     collectiveReduceOp( void* in, void* inout, int* len, MPI_Datatype* type );
+     
+     void
+     exchangePendingP2P();
+     
+     void
+     exchangePendingCollectives();
+     
      uint32_t             mpiRank;
      uint32_t             mpiSize;
+     
+     //<! number of MPI ranks in the trace (>mpiSize in M:N mode)
+     uint32_t             numTracedRanks;
      TokenTokenMap        streamIdRankMap;
      MPICommGroupMap      mpiCommGroupMap;
      MPIRemoteEdgeMap     remoteMpiEdgeMap;
      
      //<! Map MPI nodes to remote nodes (stream ID, node ID), which represents an edge
      RemoteNodeMap remoteNodeMap;  
+     
+     //<! point-to-point operations that are matched in bulk
+     PendingP2PMap        pendingP2PMap;
+     P2PSequenceMap       p2pSequenceMap[ 2 ];
+     
+     //<! unmatched records of previous intervals (partner after the cut)
+     std::vector< CarriedP2P > carriedP2P;
+     
+     //<! collective operations that are matched in bulk (instances are 
+     //<! counted over all intervals, the data starts at the base instance)
+     PendingCollectiveMap pendingCollectiveMap;
+     CollectiveCounterMap collectiveCounterMap;
+     CollectiveDataMap    collectiveDataMap;
+     CollectiveBaseMap    collectiveBaseMap;
+     
+     //<! incomplete instances that are carried to the next interval
+     CollectiveDataMap    carriedCollectives;
  };
 }
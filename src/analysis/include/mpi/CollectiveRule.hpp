@@ -50,75 +50,55 @@ namespace casita
         }
 
         AnalysisEngine* analysis = mAnalysis->getAnalysisEngine();
+        MPIAnalysis& mpiAnalysis = analysis->getMPIAnalysis();
         
-        // count occurrences
-        analysis->getStatistics().countActivity( STAT_MPI_COLLECTIVE );
+        uint32_t mpiGroupId = colLeave->getReferencedStreamId();
+        const MPIAnalysis::MPICommGroup& mpiCommGroup =
+          mpiAnalysis.getMPICommGroup( mpiGroupId ); 
+
+        // The collective is registered at the first application of the rule 
+        // and matched in bulk with all collectives of the interval. The rule is 
+        // applied again on the deferred node with the matched data.
+        bool matched = mpiAnalysis.hasPendingCollective( colLeave );
         
-        // test for pending non-blocking MPI communication (to close open requests)
-        if ( !colLeave->isMPIInit() )
+        if ( !matched )
         {
-          analysis->getStreamGroup().getMpiStream( colLeave->getStreamId() )->testAllPendingMPIRequests();
+          // count occurrences
+          analysis->getStatistics().countActivity( STAT_MPI_COLLECTIVE );
+
+          // test for pending non-blocking MPI communication (to close open requests)
+          if ( !colLeave->isMPIInit() )
+          {
+            analysis->getStreamGroup().getMpiStream( colLeave->getStreamId() )->testAllPendingMPIRequests();
+          }
         }
-        
-        GraphNode* colEnter = colLeave->getGraphPair().first;
-        
-        uint32_t mpiGroupId = colLeave->getReferencedStreamId();
-        const MPIAnalysis::MPICommGroup& mpiCommGroup =
-          analysis->getMPIAnalysis().getMPICommGroup( mpiGroupId ); 
 
         if ( mpiCommGroup.comm == MPI_COMM_SELF )
         {
           return false;
         }
-
-        // Data about each collective is exchanged with everyone
-        const uint32_t BUFFER_SIZE = 4;
-        uint64_t sendBuffer[BUFFER_SIZE];
-
-        // receive buffer has to be dynamically allocated as it depends on the
-        // number of processes in this group
-        uint32_t recvBufferSize = mpiCommGroup.procs.size() * BUFFER_SIZE;
-        uint64_t *recvBuffer    = new uint64_t[recvBufferSize];
-        
-        UTILS_ASSERT( recvBuffer != NULL, "Could not allocate uint64_t[]!\n");
         
-        memset( recvBuffer, 0, recvBufferSize * sizeof( uint64_t ) );
-
-        uint64_t collStartTime = colEnter->getTime();
+        if ( !matched )
+        {
+          mpiAnalysis.addPendingCollective( colLeave, mpiGroupId );
+          analysis->addDeferredNode( colLeave );
+          return true;
+        }
         
-        // prepare send buffer
-        sendBuffer[0] = collStartTime;
-        sendBuffer[1] = colEnter->getId();
-        sendBuffer[2] = colLeave->getId();
-        sendBuffer[3] = colLeave->getStreamId();
+        GraphNode* colEnter = colLeave->getGraphPair().first;
         
-        /*UTILS_WARNING( "[%" PRIu64 "] MPI collective rule for %s (group %u)", 
-                       colLeave->getStreamId(), 
-                       colLeave->getUniqueName().c_str(),
-                       mpiGroupId );*/
-
-        //\todo: replace with a custom MPI_Allreduce
-        MPI_CHECK( MPI_Allgather( sendBuffer, BUFFER_SIZE, MPI_UINT64_T,
-                                  recvBuffer, BUFFER_SIZE, MPI_UINT64_T, 
-                                  mpiCommGroup.comm ) );
+        uint64_t collStartTime = colEnter->getTime();
 
         // get last enter event for collective
-        uint64_t lastEnterTime         = 0;
-        uint64_t lastEnterProcessId    = 0;
-        //uint64_t lastLeaveRemoteNodeId = 0;
-        uint64_t lastEnterRemoteNodeId = 0;
-        for ( size_t i = 0; i < recvBufferSize; i += BUFFER_SIZE )
-        {
-          uint64_t enterTime = recvBuffer[i];
-
-          if ( enterTime > lastEnterTime )
-          {
-            lastEnterTime         = enterTime;
-            lastEnterRemoteNodeId = recvBuffer[ i + 1 ];
-            //lastLeaveRemoteNodeId = recvBuffer[ i + 2 ];
-            lastEnterProcessId    = recvBuffer[ i + 3 ];
-          }
-        }
+        MPIAnalysis::CollectiveResult result;
+        mpiAnalysis.getCollectiveResult( colLeave, result );
+        
+        uint64_t lastEnterTime         = result.lastEnterTime;
+        uint64_t lastEnterProcessId    = result.lastStreamId;
+        uint64_t lastEnterRemoteNodeId = result.lastEnterNodeId;
+        
+        // aggregated blame of all other streams (blame for the last entering)
+        uint64_t total_blame           = result.totalBlame;
 
         // this is not the last -> blocking + remoteEdge to lastEnter
         if ( lastEnterProcessId != colLeave->getStreamId() ) // collStartTime < lastEnterTime )
@@ -130,7 +110,7 @@ namespace casita
             collRecordEdge->makeBlocking();
             
             // add remote edge as this activity is blocking (needed in CPA)
-            analysis->getMPIAnalysis().addRemoteMPIEdge(
+            mpiAnalysis.addRemoteMPIEdge(
               colLeave, // local leave node
               lastEnterRemoteNodeId, // remote leave node ID
               lastEnterProcessId );
@@ -150,14 +130,6 @@ namespace casita
         }
         else // this stream is entering the collective last
         {
-          // aggregate blame from all other streams
-          uint64_t total_blame = 0;
-          for ( size_t i = 0; i < recvBufferSize; i += BUFFER_SIZE )
-          {
-            // blame += last enter time - this enter time
-            total_blame += lastEnterTime - recvBuffer[i];
-          }
-
           distributeBlame( analysis,
                            colEnter,
                            total_blame,
@@ -165,8 +137,6 @@ namespace casita
                            REASON_MPI_COLLECTIVE );
         }
 
-        delete[] recvBuffer;
-
         return true;
       }
   };
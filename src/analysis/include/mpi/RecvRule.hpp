@@ -46,9 +46,6 @@ namespace casita
         
         //UTILS_OUT( "[%" PRIu64 "] %s", recvLeave->getStreamId(), commonAnalysis->getNodeInfo(recvLeave).c_str() );
         
-        // count occurrences
-        commonAnalysis->getStatistics().countActivity( STAT_MPI_P2P );
-        
         MPIAnalysis& mpiAnalysis = commonAnalysis->getMPIAnalysis();
 
         int partnerRank = (int) recvLeave->getReferencedStreamId();
@@ -56,18 +53,48 @@ namespace casita
         uint32_t* data  = (uint32_t*)( recvLeave->getData() );
         uint32_t mpiTag = data[ 0 ];
         uint32_t comRef = data[ 1 ];
-        MPI_Comm communicator = mpiAnalysis.getMPICommGroup( comRef ).comm;
+        
+        // bulk mode: the partner is matched after all operations of the 
+        // interval have been registered (the rule is applied again)
+        if ( mpiAnalysis.isBulkP2PMode() && 
+             !mpiAnalysis.hasPendingP2P( recvLeave ) )
+        {
+          mpiAnalysis.addPendingP2P( recvLeave, MPIAnalysis::MPI_P2P_RECV, 
+                                     comRef, partnerRank, mpiTag );
+          commonAnalysis->addDeferredNode( recvLeave );
+          return true;
+        }
+        
         delete[] data;
         
-        // replay receive and retrieve information from communication partner
+        // count occurrences
+        commonAnalysis->getStatistics().countActivity( STAT_MPI_P2P );
+        
+        MPI_Comm communicator = MPI_COMM_NULL;
         uint64_t buffer[ CASITA_MPI_P2P_BUF_SIZE ];
-        MPI_CHECK( MPI_Recv( buffer, 
-                             CASITA_MPI_P2P_BUF_SIZE, 
-                             CASITA_MPI_P2P_ELEMENT_TYPE,
-                             partnerRank, 
-                             mpiTag, //CASITA_MPI_REPLAY_TAG, 
-                             communicator, //MPI_COMM_WORLD, 
-                             MPI_STATUS_IGNORE ) );
+        
+        if ( mpiAnalysis.isBulkP2PMode() )
+        {
+          // get the send information from the bulk matching
+          if ( !mpiAnalysis.getP2PPartner( recvLeave, MPIAnalysis::MPI_P2P_RECV,
+                                           buffer ) )
+          {
+            return false;
+          }
+        }
+        else
+        {
+          communicator = mpiAnalysis.getMPICommGroup( comRef ).comm;
+          
+          // replay receive and retrieve information from communication partner
+          MPI_CHECK( MPI_Recv( buffer, 
+                               CASITA_MPI_P2P_BUF_SIZE, 
+                               CASITA_MPI_P2P_ELEMENT_TYPE,
+                               partnerRank, 
+                               mpiTag, //CASITA_MPI_REPLAY_TAG, 
+                               communicator, //MPI_COMM_WORLD, 
+                               MPI_STATUS_IGNORE ) );
+        }
         
         GraphNode* recvEnter     = recvLeave->getGraphPair().first;
         uint64_t   sendStartTime = buffer[ 0 ];
@@ -107,13 +134,17 @@ namespace casita
         buffer[3] = recvLeave->getId();
         buffer[CASITA_MPI_P2P_BUF_LAST] = MPI_RECV;
 
-        MPI_CHECK( MPI_Send( buffer, 
-                             CASITA_MPI_P2P_BUF_SIZE, 
-                             CASITA_MPI_P2P_ELEMENT_TYPE,
-                             partnerRank,
-                             mpiTag + CASITA_MPI_REVERS_REPLAY_TAG, 
-                             communicator //MPI_COMM_WORLD 
-        ) );
+        // the partner got this information from the bulk matching
+        if ( !mpiAnalysis.isBulkP2PMode() )
+        {
+          MPI_CHECK( MPI_Send( buffer, 
+                               CASITA_MPI_P2P_BUF_SIZE, 
+                               CASITA_MPI_P2P_ELEMENT_TYPE,
+                               partnerRank,
+                               mpiTag + CASITA_MPI_REVERS_REPLAY_TAG, 
+                               communicator //MPI_COMM_WORLD 
+          ) );
+        }
 
         // if send starts after receive starts, we found a late sender
         // no additional check for overlap needed, as MPI_Recv is always blocking
@@ -45,10 +45,6 @@ namespace casita
 
         AnalysisEngine* commonAnalysis = analysis->getAnalysisEngine();
         
-        // count occurrence
-        commonAnalysis->getStatistics().countActivity( STAT_MPI_P2P );
-        commonAnalysis->getStatistics().countActivity( STAT_MPI_P2P );
-        
         MPIAnalysis& mpiAnalysis = commonAnalysis->getMPIAnalysis();
 
         GraphNode* sendRecvEnter = sendRecvLeave->getGraphPair().first;
@@ -62,9 +58,27 @@ namespace casita
         int recvRank     = (int) data[ 2 ];
         uint32_t recvTag = data[ 3 ];
         
+        const uint32_t comRef = (uint32_t) sendRecvLeave->getReferencedStreamId();
+        
+        // bulk mode: both partners are matched after all operations of the 
+        // interval have been registered (the rule is applied again)
+        if ( mpiAnalysis.isBulkP2PMode() && 
+             !mpiAnalysis.hasPendingP2P( sendRecvLeave ) )
+        {
+          mpiAnalysis.addPendingP2P( sendRecvLeave, MPIAnalysis::MPI_P2P_SEND, 
+                                     comRef, sendRank, sendTag );
+          mpiAnalysis.addPendingP2P( sendRecvLeave, MPIAnalysis::MPI_P2P_RECV, 
+                                     comRef, recvRank, recvTag );
+          commonAnalysis->addDeferredNode( sendRecvLeave );
+          return true;
+        }
+        
         delete[] data;
         
-        const uint32_t comRef = (uint32_t) sendRecvLeave->getReferencedStreamId();
+        // count occurrence
+        commonAnalysis->getStatistics().countActivity( STAT_MPI_P2P );
+        commonAnalysis->getStatistics().countActivity( STAT_MPI_P2P );
+        
         MPI_Comm communicator = mpiAnalysis.getMPICommGroup( comRef ).comm;
 
         uint64_t sendBuffer[ CASITA_MPI_P2P_BUF_SIZE ];
@@ -81,11 +95,22 @@ namespace casita
         sendBuffer[CASITA_MPI_P2P_BUF_LAST] = MPI_SEND | MPI_RECV;
 
         // replay: get information from receive rank
-        MPI_CHECK( MPI_Sendrecv( sendBuffer, CASITA_MPI_P2P_BUF_SIZE, MPI_UINT64_T, 
-                                 sendRank, sendTag, //CASITA_MPI_REPLAY_TAG,
-                                 recvBuffer, CASITA_MPI_P2P_BUF_SIZE, MPI_UINT64_T, 
-                                 recvRank, recvTag, //CASITA_MPI_REPLAY_TAG,
-                                 communicator, MPI_STATUS_IGNORE ) );
+        if ( mpiAnalysis.isBulkP2PMode() )
+        {
+          if ( !mpiAnalysis.getP2PPartner( sendRecvLeave, 
+                                           MPIAnalysis::MPI_P2P_RECV, recvBuffer ) )
+          {
+            return false;
+          }
+        }
+        else
+        {
+          MPI_CHECK( MPI_Sendrecv( sendBuffer, CASITA_MPI_P2P_BUF_SIZE, MPI_UINT64_T, 
+                                   sendRank, sendTag, //CASITA_MPI_REPLAY_TAG,
+                                   recvBuffer, CASITA_MPI_P2P_BUF_SIZE, MPI_UINT64_T, 
+                                   recvRank, recvTag, //CASITA_MPI_REPLAY_TAG,
+                                   communicator, MPI_STATUS_IGNORE ) );
+        }
 
         // evaluate receive buffer
         const uint64_t recvRankStartTime = recvBuffer[0];
@@ -142,13 +167,24 @@ namespace casita
 
         // send and receive rank are distinct
         // reverse replay: get information from send rank
-        MPI_CHECK( MPI_Sendrecv( sendBuffer, CASITA_MPI_P2P_BUF_SIZE,
-                                 MPI_UINT64_T, recvRank, 
-                                 recvTag + CASITA_MPI_REVERS_REPLAY_TAG,
-                                 recvBuffer, CASITA_MPI_P2P_BUF_SIZE,
-                                 MPI_UINT64_T, sendRank, 
-                                 sendTag + CASITA_MPI_REVERS_REPLAY_TAG,
-                                 communicator, MPI_STATUS_IGNORE ) );
+        if ( mpiAnalysis.isBulkP2PMode() )
+        {
+          if ( !mpiAnalysis.getP2PPartner( sendRecvLeave, 
+                                           MPIAnalysis::MPI_P2P_SEND, recvBuffer ) )
+          {
+            return false;
+          }
+        }
+        else
+        {
+          MPI_CHECK( MPI_Sendrecv( sendBuffer, CASITA_MPI_P2P_BUF_SIZE,
+                                   MPI_UINT64_T, recvRank, 
+                                   recvTag + CASITA_MPI_REVERS_REPLAY_TAG,
+                                   recvBuffer, CASITA_MPI_P2P_BUF_SIZE,
+                                   MPI_UINT64_T, sendRank, 
+                                   sendTag + CASITA_MPI_REVERS_REPLAY_TAG,
+                                   communicator, MPI_STATUS_IGNORE ) );
+        }
 
         const uint64_t sendRankStartTime = recvBuffer[0];
         const uint64_t sendRankEnterId   = recvBuffer[2];
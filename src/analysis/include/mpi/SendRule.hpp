@@ -46,8 +46,6 @@ namespace casita
         
         //UTILS_OUT( "[%" PRIu64 "] %s", sendLeave->getStreamId(), commonAnalysis->getNodeInfo(sendLeave).c_str() );
         
-        commonAnalysis->getStatistics().countActivity(STAT_MPI_P2P);
-        
         MPIAnalysis& mpiAnalysis = commonAnalysis->getMPIAnalysis();
 
         GraphNode* sendEnter = sendLeave->getGraphPair().first;
@@ -60,37 +58,63 @@ namespace casita
         uint32_t* data        = (uint32_t*)( sendLeave->getData() );
         uint32_t mpiTag       = data[ 0 ];
         uint32_t comRef       = data[ 1 ];
-        MPI_Comm communicator = mpiAnalysis.getMPICommGroup( comRef ).comm;
+        
+        // bulk mode: the partner is matched after all operations of the 
+        // interval have been registered (the rule is applied again)
+        if ( mpiAnalysis.isBulkP2PMode() && 
+             !mpiAnalysis.hasPendingP2P( sendLeave ) )
+        {
+          mpiAnalysis.addPendingP2P( sendLeave, MPIAnalysis::MPI_P2P_SEND, 
+                                     comRef, partnerRank, mpiTag );
+          commonAnalysis->addDeferredNode( sendLeave );
+          return true;
+        }
 
         // delete data field allocated in class AnalysisParadigmMPI
         delete[] data;
         
+        commonAnalysis->getStatistics().countActivity(STAT_MPI_P2P);
+        
         // send
         uint64_t sendStartTime = sendEnter->getTime();
         uint64_t sendEndTime   = sendLeave->getTime();
 
-        // replay MPI_Send to transfer information on this MPI_Send activity
         uint64_t buffer[CASITA_MPI_P2P_BUF_SIZE];
         
-        buffer[0] = sendStartTime;
-        buffer[1] = sendEndTime;
-        buffer[2] = sendEnter->getId();
-        buffer[3] = sendLeave->getId();
-        buffer[ CASITA_MPI_P2P_BUF_LAST ] = MPI_SEND;
-        MPI_CHECK( MPI_Send( buffer, 
-                             CASITA_MPI_P2P_BUF_SIZE, 
-                             CASITA_MPI_P2P_ELEMENT_TYPE,
-                             partnerRank,
-                             mpiTag, //CASITA_MPI_REPLAY_TAG, 
-                             communicator ) );
-        
-        // receive the communication partner start time to compute wait states
-        // use another tag to not mix up with replayed communication
-        MPI_CHECK( MPI_Recv( buffer, CASITA_MPI_P2P_BUF_SIZE, 
-                             CASITA_MPI_P2P_ELEMENT_TYPE, partnerRank,
-                             mpiTag + CASITA_MPI_REVERS_REPLAY_TAG, 
-                             communicator, //MPI_COMM_WORLD, 
-                             MPI_STATUS_IGNORE ) );
+        if ( mpiAnalysis.isBulkP2PMode() )
+        {
+          // get the receive information from the bulk matching
+          if ( !mpiAnalysis.getP2PPartner( sendLeave, MPIAnalysis::MPI_P2P_SEND,
+                                           buffer ) )
+          {
+            return false;
+          }
+        }
+        else
+        {
+          MPI_Comm communicator = mpiAnalysis.getMPICommGroup( comRef ).comm;
+          
+          // replay MPI_Send to transfer information on this MPI_Send activity
+          buffer[0] = sendStartTime;
+          buffer[1] = sendEndTime;
+          buffer[2] = sendEnter->getId();
+          buffer[3] = sendLeave->getId();
+          buffer[ CASITA_MPI_P2P_BUF_LAST ] = MPI_SEND;
+          MPI_CHECK( MPI_Send( buffer, 
+                               CASITA_MPI_P2P_BUF_SIZE, 
+                               CASITA_MPI_P2P_ELEMENT_TYPE,
+                               partnerRank,
+                               mpiTag, //CASITA_MPI_REPLAY_TAG, 
+                               communicator ) );
+
+          // receive the communication partner start time to compute wait states
+          // use another tag to not mix up with replayed communication
+          MPI_CHECK( MPI_Recv( buffer, CASITA_MPI_P2P_BUF_SIZE, 
+                               CASITA_MPI_P2P_ELEMENT_TYPE, partnerRank,
+                               mpiTag + CASITA_MPI_REVERS_REPLAY_TAG, 
+                               communicator, //MPI_COMM_WORLD, 
+                               MPI_STATUS_IGNORE ) );
+        }
         
         /*if( ( buffer[CASITA_MPI_P2P_BUF_LAST] & MPI_SEND ) &&
             ( buffer[CASITA_MPI_P2P_BUF_LAST] & MPI_RECV ) )
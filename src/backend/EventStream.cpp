@@ -18,6 +18,7 @@
  */
 
 #include <limits>
+#include <algorithm>
 
 #include "EventStream.hpp"
 #include "utils/Utils.hpp"
@@ -351,94 +352,91 @@ EventStream::insertGraphNode( GraphNode*                  node,
     lastNode = node;
   }
 
-  // add the node to the sorted nodes list
-  SortedGraphNodeList::iterator result = nodes.end();
-  for ( SortedGraphNodeList::iterator iter = nodes.begin();
-        iter != nodes.end(); ++iter )
+  // add the node to the sorted nodes list (binary search for the position)
+  SortedGraphNodeList::iterator result = 
+    nodes.insert( std::upper_bound( nodes.begin(), nodes.end(), node, 
+                                    nodeCompareLess() ), node );
+  
+  // link the node into the stream predecessor chain
+  node->setStreamPredecessor( result == nodes.begin() ? NULL : *( result - 1 ) );
+  if ( result + 1 != nodes.end() )
   {
-    SortedGraphNodeList::iterator next = iter;
-    ++next;
+    ( *( result + 1 ) )->setStreamPredecessor( node );
+  }
 
-    // if next is end of list, then push the node at the end of the vector
-    if ( next == nodes.end() )
-    {      
-      nodes.push_back( node );
-      break;
+  // Paradigms (bit i for paradigm 1 << i) that have a node before/after the 
+  // inserted node. The first and last node of each paradigm tell whether a 
+  // neighbor exists at all. Hence, the scans below stop as soon as all 
+  // existing neighbors have been found.
+  size_t openPred = 0;
+  size_t openNext = 0;
+  for ( size_t i = 0; i < NODE_PARADIGM_COUNT; ++i )
+  {
+    if ( graphData[ i ].firstNode && 
+         Node::compareLess( graphData[ i ].firstNode, node ) )
+    {
+      openPred |= ( 1 << i );
     }
-
-    // current node is "before" the next element
-    if ( Node::compareLess( node, *next ) )
+    
+    if ( graphData[ i ].lastNode && 
+         Node::compareLess( node, graphData[ i ].lastNode ) )
     {
-      result = nodes.insert( next, node );
-      break;
+      openNext |= ( 1 << i );
     }
   }
+  
+  const size_t hasNextNode = openNext;
 
-  SortedGraphNodeList::iterator current;
-
-  for ( size_t paradigm = 1;
-        paradigm < NODE_PARADIGM_INVALID;
-        paradigm *= 2 )
+  /* find previous nodes of all paradigms in a single backward scan */
+  for ( SortedGraphNodeList::iterator current = result; 
+        openPred && current != nodes.begin(); )
   {
-    /* find previous node */
-    GraphNode* predNode = NULL;
-    current = result;
-    while ( current != nodes.begin() )
+    --current;
+    
+    size_t found = ( *current )->getParadigm() & openPred;
+    for ( size_t i = 0; found && i < NODE_PARADIGM_COUNT; ++i )
     {
-      --current;
-      if ( ( *current )->hasParadigm( (Paradigm)paradigm ) )
+      if ( found & ( 1 << i ) )
       {
-        predNode = *current;
-        break;
+        predNodes.insert( std::make_pair( (Paradigm)( 1 << i ), *current ) );
+        found &= ~( 1 << i );
       }
     }
-
-    if ( predNode )
-    {
-      predNodes.insert( std::make_pair( (Paradigm)paradigm, predNode ) );
-    }
+    
+    openPred &= ~( ( *current )->getParadigm() );
   }
 
-  /* find next node */
-  bool hasNextNode[NODE_PARADIGM_COUNT];
-
-  for ( size_t paradigm = 1;
-        paradigm < NODE_PARADIGM_INVALID;
-        paradigm *= 2 )
+  /* find next nodes of all paradigms in a single forward scan */
+  for ( SortedGraphNodeList::iterator current = result + 1; 
+        openNext && current != nodes.end(); ++current )
   {
-    current = result;
-    SortedGraphNodeList::iterator next = ++current;
-    size_t     paradigm_index          = (size_t)log2( paradigm );
-    hasNextNode[paradigm_index] = false;
-
-    GraphNode* nextNode = NULL;
-
-    while ( next != nodes.end() )
+    size_t found = ( *current )->getParadigm() & openNext;
+    for ( size_t i = 0; found && i < NODE_PARADIGM_COUNT; ++i )
     {
-      if ( ( *next )->hasParadigm( ( Paradigm )paradigm ) )
+      if ( found & ( 1 << i ) )
       {
-        nextNode = *next;
-        hasNextNode[ paradigm_index ] = true;
-        break;
+        nextNodes.insert( std::make_pair( (Paradigm)( 1 << i ), *current ) );
+        found &= ~( 1 << i );
       }
-      ++next;
-    }
-
-    if ( nextNode )
-    {
-      nextNodes.insert( std::make_pair( (Paradigm)paradigm, nextNode ) );
     }
+    
+    openNext &= ~( ( *current )->getParadigm() );
+  }
 
-    if ( node->hasParadigm( (Paradigm)paradigm ) )
+  // update first and last node of the node's paradigms
+  for ( size_t i = 0; i < NODE_PARADIGM_COUNT; ++i )
+  {
+    if ( node->hasParadigm( (Paradigm)( 1 << i ) ) )
     {
-      if ( !graphData[paradigm_index].firstNode )
+      if ( !graphData[ i ].firstNode || 
+           Node::compareLess( node, graphData[ i ].firstNode ) )
       {
-        graphData[paradigm_index].firstNode = node;
+        graphData[ i ].firstNode = node;
       }
 
-      if ( !hasNextNode[paradigm_index] )
+      if ( !( hasNextNode & ( 1 << i ) ) )
       {
-        graphData[paradigm_index].lastNode = node;
+        graphData[ i ].lastNode = node;
       }
     }
   }
@@ -467,6 +465,9 @@ EventStream::clearNodes()
   // clear the nodes list (do not delete the nodes themselves)
   nodes.clear();
   
+  // nodes that are added again are linked again
+  unlinkedMPINodes.clear();
+  
   // set the first and last Node to NULL
   for ( size_t i = 0; i < NODE_PARADIGM_COUNT; ++i )
   {
@@ -724,6 +725,7 @@ EventStream::findNode( GraphNode* node ) const
 void
 EventStream::addNodeInternal( SortedGraphNodeList& nodes, GraphNode* node )
 {
+  node->setStreamPredecessor( nodes.empty() ? NULL : nodes.back() );
   nodes.push_back( node );
 
   lastNode = node;
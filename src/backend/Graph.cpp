@@ -53,7 +53,28 @@ Graph::cleanup( bool deleteEdges )
 {
   //std::cerr << "Cleanup graph -- delete edges: " << deleteEdges << std::endl;
   
-  // iterate over the out-edge lists of all node entries
+  // the main graph stores the edges in the nodes, every edge is in the 
+  // in-edge list of exactly one node
+  for ( NodeList::const_iterator iter = edgeEndNodes.begin();
+        iter != edgeEndNodes.end(); ++iter )
+  {
+    EdgeList& in_edges = ( *iter )->getInEdgeList();
+    for ( EdgeList::const_iterator eIter = in_edges.begin();
+          eIter != in_edges.end(); ++eIter )
+    {
+      ( *eIter )->getStartNode()->getOutEdgeList().clear();
+      
+      if( deleteEdges )
+      {
+        delete *eIter;
+      }
+    }
+    
+    in_edges.clear();
+  }
+  edgeEndNodes.clear();
+  
+  // iterate over the out-edge lists of all node entries (sub graphs)
   for ( NodeEdges::iterator iter = outEdges.begin();
         iter != outEdges.end(); ++iter )
   {
@@ -89,6 +110,48 @@ Graph::cleanup( bool deleteEdges )
   nodes.clear();
 }
 
+/**
+ * Clear the lists of the (main) graph without touching the edges. The end 
+ * nodes of all edges are moved to the given list, which is used to delete the
+ * edges later with releaseEdges(). The edge lists of the nodes stay intact.
+ * 
+ * @param edgeEnds list that receives the end nodes of all edges
+ */
+void
+Graph::detachEdges( NodeList& edgeEnds )
+{
+  edgeEnds.insert( edgeEnds.end(), edgeEndNodes.begin(), edgeEndNodes.end() );
+  
+  edgeEndNodes.clear();
+  nodes.clear();
+}
+
+/**
+ * Delete the edges that have been detached from the graph with detachEdges().
+ * Only the in-edge lists of the end nodes are cleared, the start nodes might 
+ * already be part of another graph.
+ * 
+ * @param edgeEnds end nodes of the detached edges (cleared)
+ */
+void
+Graph::releaseEdges( NodeList& edgeEnds )
+{
+  for ( NodeList::const_iterator iter = edgeEnds.begin();
+        iter != edgeEnds.end(); ++iter )
+  {
+    EdgeList& in_edges = ( *iter )->getInEdgeList();
+    for ( EdgeList::const_iterator eIter = in_edges.begin();
+          eIter != in_edges.end(); ++eIter )
+    {
+      delete *eIter;
+    }
+    
+    in_edges.clear();
+  }
+  
+  edgeEnds.clear();
+}
+
 void
 Graph::addNode( GraphNode* node )
 {
@@ -106,9 +169,17 @@ Graph::addEdge( Edge* edge )
 {
   //std::cerr << "Added Edge " << edge->getStartNode()->getUniqueName() << " to "
   //          << edge->getEndNode()->getUniqueName() << std::endl;
+  EdgeList& in_edges = getInEdgeList( edge->getEndNode() );
+  
+  // remember the end node to find all edges of the main graph on cleanup
+  if ( !isSubGraph && in_edges.empty() )
+  {
+    edgeEndNodes.push_back( edge->getEndNode() );
+  }
+  
   // push this edge as in-edge to the target/end node
-  inEdges[edge->getEndNode()].push_back( edge );
-  outEdges[edge->getStartNode()].push_back( edge );
+  in_edges.push_back( edge );
+  getOutEdgeList( edge->getStartNode() ).push_back( edge );
 
 /*  
   if(edge->getEndNode()->getId() == 9)
@@ -138,8 +209,8 @@ Graph::removeEdge( Edge* edge )
   //std::cerr << "Remove edge: " << edge->getStartNode()->getUniqueName() << " to "
   //          << edge->getEndNode()->getUniqueName() << std::endl;
 
-  EdgeList& out_edges = outEdges[startNode];
-  EdgeList& in_edges  = inEdges[endNode];
+  EdgeList& out_edges = getOutEdgeList( startNode );
+  EdgeList& in_edges  = getInEdgeList( endNode );
 
   for ( EdgeList::iterator iter = out_edges.begin();
         iter != out_edges.end(); ++iter )
@@ -161,9 +232,43 @@ Graph::removeEdge( Edge* edge )
   }
 }
 
+/**
+ * Get the modifiable in-edge list of the given node. The list is created for
+ * sub graphs, if it does not exist.
+ * 
+ * @param node
+ * @return 
+ */
+Graph::EdgeList&
+Graph::getInEdgeList( GraphNode* node )
+{
+  if ( !isSubGraph )
+  {
+    return node->getInEdgeList();
+  }
+  
+  return inEdges[ node ];
+}
+
+Graph::EdgeList&
+Graph::getOutEdgeList( GraphNode* node )
+{
+  if ( !isSubGraph )
+  {
+    return node->getOutEdgeList();
+  }
+  
+  return outEdges[ node ];
+}
+
 const Graph::EdgeList&
 Graph::getInEdges( GraphNode* node ) const
 {
+  if ( !isSubGraph )
+  {
+    return node->getInEdgeList();
+  }
+  
   NodeEdges::const_iterator iter = inEdges.find( node );
   if ( iter != inEdges.end() )
   {
@@ -183,6 +288,12 @@ Graph::getInEdges( GraphNode* node ) const
 const Graph::EdgeList*
 Graph::getInEdgesPtr( GraphNode* node ) const
 {
+  // the main graph has an (empty) edge list for every node
+  if ( !isSubGraph )
+  {
+    return &( node->getInEdgeList() );
+  }
+  
   NodeEdges::const_iterator iter = inEdges.find( node );
   if ( iter != inEdges.end() )
   {
@@ -202,6 +313,11 @@ Graph::getInEdgesPtr( GraphNode* node ) const
 const Graph::EdgeList*
 Graph::getOutEdges( GraphNode* node ) const
 {
+  if ( !isSubGraph )
+  {
+    return &( node->getOutEdgeList() );
+  }
+  
   NodeEdges::const_iterator iter = outEdges.find( node );
   if ( iter != outEdges.end() )
   {
@@ -461,17 +577,28 @@ Graph::getCriticalPath( GraphNode* startNode, GraphNode* endNode,
     }
     
     // use direct predecessor of currentNode (on same stream, if currentNode has a caller)
-    Graph::NodeList::const_reverse_iterator rit = 
-      GraphNode::findNode( currentNode, nodes );
-    GraphNode* predecessorNode = *(++rit);
+    GraphNode* predecessorNode = NULL;
     
     // if current node has a caller (there are more event on this stream)
     if( currentNode->getCaller() )
     {
-      // move to the previous node on same stream
-      while( currentNode->getStreamId() != predecessorNode->getStreamId() )
+      // the previous node on same stream
+      predecessorNode = currentNode->getStreamPredecessor();
+    }
+    
+    if( !predecessorNode )
+    {
+      Graph::NodeList::const_reverse_iterator rit = 
+        GraphNode::findNode( currentNode, nodes );
+      predecessorNode = *(++rit);
+
+      if( currentNode->getCaller() )
       {
-        predecessorNode = *(++rit);
+        // move to the previous node on same stream
+        while( currentNode->getStreamId() != predecessorNode->getStreamId() )
+        {
+          predecessorNode = *(++rit);
+        }
       }
     }
     
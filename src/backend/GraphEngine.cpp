@@ -129,6 +129,32 @@ GraphEngine::getGraph()
   return graph;
 }
 
+/**
+ * Get the number of bytes held by the graph of the current interval: nodes,
+ * edges, blame arrays and the node lists of the graph and the streams.
+ * 
+ * @return number of bytes held by the graph
+ */
+uint64_t
+GraphEngine::getGraphBytes() const
+{
+  uint64_t bytes = GraphNode::getAllocator().getUsedBytes() +
+                   EventNode::getAllocator().getUsedBytes() +
+                   Edge::getAllocator().getUsedBytes() +
+                   Edge::getBlameAllocator().getUsedBytes();
+  
+  bytes += graph.getNodes().capacity() * sizeof( GraphNode* );
+  
+  const EventStreamGroup::EventStreamList& streams = getStreams();
+  for ( EventStreamGroup::EventStreamList::const_iterator iter = streams.begin();
+        iter != streams.end(); ++iter )
+  {
+    bytes += ( *iter )->getNodes().capacity() * sizeof( GraphNode* );
+  }
+  
+  return bytes;
+}
+
 Graph*
 GraphEngine::getGraph( Paradigm p )
 {
@@ -427,26 +453,67 @@ GraphEngine::getLastGraphNode( Paradigm paradigm ) const
 }
 
 /**
- * Return a sorted list of nodes from all local event streams.
- * 
- * @param allNodes sorted list of nodes
+ * Range of the sorted node list of a stream that has not been merged yet.
+ */
+typedef std::pair< EventStream::SortedGraphNodeList::const_iterator,
+                   EventStream::SortedGraphNodeList::const_iterator > NodeRange;
+
+/**
+ * Heap order for the k-way merge: the range with the earliest current node
+ * has to be on top of the heap.
+ */
+static bool
+nodeRangeGreater( const NodeRange& r1, const NodeRange& r2 )
+{
+  return Node::compareLess( *( r2.first ), *( r1.first ) );
+}
+
+/**
+ * Get the nodes of all streams sorted by Node::compareLess. As the node list 
+ * of each stream is already sorted, the lists are merged with a heap over 
+ * the streams (O(n log k) for n nodes on k streams).
+ *
+ * @param allNodes vector the sorted nodes are appended to
  */
 void
 GraphEngine::getAllNodes( EventStream::SortedGraphNodeList& allNodes ) const
 {
   const EventStreamGroup::EventStreamList streams = getStreams();
+  
+  std::vector< NodeRange > heap;
+  size_t numNodes = 0;
 
   for ( EventStreamGroup::EventStreamList::const_iterator iter = streams.begin();
         iter != streams.end(); ++iter )
   {
-    EventStream* p = *iter;
-    if ( p->getNodes().size() > 0 )
+    const EventStream::SortedGraphNodeList& nodes = ( *iter )->getNodes();
+    if ( nodes.size() > 0 )
     {
-      allNodes.insert( allNodes.end(), p->getNodes().begin(), p->getNodes().end() );
+      heap.push_back( NodeRange( nodes.begin(), nodes.end() ) );
+      numNodes += nodes.size();
+    }
+  }
+  
+  allNodes.reserve( allNodes.size() + numNodes );
+  
+  std::make_heap( heap.begin(), heap.end(), nodeRangeGreater );
+  
+  while ( !heap.empty() )
+  {
+    std::pop_heap( heap.begin(), heap.end(), nodeRangeGreater );
+    
+    NodeRange& range = heap.back();
+    allNodes.push_back( *( range.first ) );
+    
+    if ( ++( range.first ) == range.second )
+    {
+      heap.pop_back();
+    }
+    else
+    {
+      std::push_heap( heap.begin(), heap.end(), nodeRangeGreater );
     }
   }
-
-  std::sort( allNodes.begin(), allNodes.end(), Node::compareLess );
 }
 
 AnalysisMetric&
@@ -0,0 +1,430 @@
+/*
+ * This file is part of the CASITA software
+ *
+ * Copyright (c) 2019,
+ * Technische Universitaet Dresden, Germany
+ *
+ * This software may be modified and distributed under the terms of
+ * a BSD-style license. See the COPYING file in the package base
+ * directory for details.
+ *
+ * What this file does:
+ * - append the analyzed graph of each interval to the graph file of the
+ *   analysis process
+ * - read a complete graph file (e.g. for critical path predictions)
+ *
+ */
+
+// the following definition and include is needed for the printf PRIu64 macro
+#define __STDC_FORMAT_MACROS
+#include <inttypes.h>
+#include <stddef.h>
+#include <string.h>
+#include <algorithm>
+#include <sstream>
+
+#include "GraphStore.hpp"
+#include "common.hpp"
+#include "utils/Utils.hpp"
+
+using namespace casita;
+
+#define CASITA_GRAPH_MAGIC "CASITAGS"
+#define CASITA_GRAPH_VERSION 1
+
+GraphStore::GraphStore() :
+  file( NULL ),
+  mpiRank( 0 ),
+  mpiSize( 0 ),
+  timerResolution( 0 ),
+  criticalPathLength( 0 )
+{
+
+}
+
+GraphStore::~GraphStore()
+{
+  close();
+}
+
+/**
+ * Get the name of the graph file of an analysis process.
+ *
+ * @param directory directory of the graph files
+ * @param traceFile OTF2 anchor file
+ * @param mpiRank rank of the analysis process
+ * @param mpiSize number of analysis processes
+ *
+ * @return path of the graph file
+ */
+std::string
+GraphStore::getFileName( const std::string& directory,
+                         const std::string& traceFile,
+                         uint32_t mpiRank, uint32_t mpiSize )
+{
+  // archive name without path and extension
+  std::string archive = traceFile;
+  size_t pos = archive.find_last_of( '/' );
+  if ( pos != std::string::npos )
+  {
+    archive = archive.substr( pos + 1 );
+  }
+
+  pos = archive.rfind( ".otf2" );
+  if ( pos != std::string::npos )
+  {
+    archive = archive.substr( 0, pos );
+  }
+
+  std::stringstream name;
+  name << directory << "/" << archive << "." << mpiRank << "of" << mpiSize
+       << ".graph";
+
+  return name.str();
+}
+
+/**
+ * Create a new graph file. The intervals are added with flush().
+ *
+ * @param fileName path of the graph file
+ * @param mpiRank rank of the analysis process
+ * @param mpiSize number of analysis processes
+ * @param timerResolution ticks per second of the node times
+ */
+void
+GraphStore::create( const std::string& fileName, uint32_t mpiRank,
+                    uint32_t mpiSize, uint64_t timerResolution )
+{
+  this->fileName        = fileName;
+  this->mpiRank         = mpiRank;
+  this->mpiSize         = mpiSize;
+  this->timerResolution = timerResolution;
+
+  file = fopen( fileName.c_str(), "wb" );
+  if ( !file )
+  {
+    throw RTException( "Could not create graph file %s", fileName.c_str() );
+  }
+
+  // the header is written again with the critical path length, when the
+  // graph is complete
+  StoreHeader header;
+  memset( &header, 0, sizeof( header ) );
+  memcpy( header.magic, CASITA_GRAPH_MAGIC, 8 );
+  header.version         = CASITA_GRAPH_VERSION;
+  header.mpiRank         = mpiRank;
+  header.mpiSize         = mpiSize;
+  header.timerResolution = timerResolution;
+
+  write( &header, sizeof( header ) );
+}
+
+/**
+ * Read a complete graph file. All records are available afterwards.
+ *
+ * @param fileName path of the graph file
+ *
+ * @return true, if the file is a complete graph file
+ */
+bool
+GraphStore::open( const std::string& fileName )
+{
+  FILE* input = fopen( fileName.c_str(), "rb" );
+  if ( !input )
+  {
+    return false;
+  }
+
+  StoreHeader header;
+  if ( fread( &header, sizeof( header ), 1, input ) != 1 ||
+       memcmp( header.magic, CASITA_GRAPH_MAGIC, 8 ) != 0 ||
+       header.version != CASITA_GRAPH_VERSION ||
+       header.criticalPathLength == 0 )
+  {
+    fclose( input );
+    return false;
+  }
+
+  this->fileName     = fileName;
+  mpiRank            = header.mpiRank;
+  mpiSize            = header.mpiSize;
+  timerResolution    = header.timerResolution;
+  criticalPathLength = header.criticalPathLength;
+
+  bool success = true;
+
+  BlockHeader block;
+  while ( success && fread( &block, sizeof( block ), 1, input ) == 1 )
+  {
+    switch ( block.type )
+    {
+      case BLOCK_NODES:
+        success = readBlock( input, block.count, nodes );
+        break;
+
+      case BLOCK_EDGES:
+        success = readBlock( input, block.count, edges );
+        break;
+
+      case BLOCK_REMOTE_NODES:
+        success = readBlock( input, block.count, remoteNodes );
+        break;
+
+      case BLOCK_REGIONS:
+        success = readBlock( input, block.count, regions );
+        break;
+
+      // region reference, name length, name (without terminating zero)
+      case BLOCK_REGION_NAMES:
+        for ( uint64_t i = 0; i < block.count && success; ++i )
+        {
+          uint32_t entry[ 2 ];
+          success = ( fread( entry, sizeof( entry ), 1, input ) == 1 );
+          if ( success )
+          {
+            std::vector< char > name( entry[ 1 ] + 1, 0 );
+            success = ( entry[ 1 ] == 0 ||
+                        fread( &name[ 0 ], entry[ 1 ], 1, input ) == 1 );
+            regionNames[ entry[ 0 ] ] = &name[ 0 ];
+          }
+        }
+        break;
+
+      default:
+        success = false;
+    }
+  }
+
+  fclose( input );
+
+  return success;
+}
+
+/**
+ * Add the enter of a region on a local stream.
+ *
+ * @param streamId stream ID
+ * @param regionRef region reference
+ * @param time enter time
+ */
+void
+GraphStore::addRegionEnter( uint64_t streamId, uint32_t regionRef,
+                            uint64_t time )
+{
+  openRegions[ streamId ].push_back( OpenRegion( regionRef, time ) );
+}
+
+/**
+ * Add the leave of a region on a local stream. Creates the region record of
+ * the innermost open region.
+ *
+ * @param streamId stream ID
+ * @param regionRef region reference
+ * @param time leave time
+ */
+void
+GraphStore::addRegionLeave( uint64_t streamId, uint32_t regionRef,
+                            uint64_t time )
+{
+  std::vector< OpenRegion >& stack = openRegions[ streamId ];
+  if ( stack.empty() || stack.back().first != regionRef )
+  {
+    UTILS_WARNING( "[%" PRIu64 "] Graph store: Leave of region %u does not "
+                   "match the last enter.", streamId, regionRef );
+    return;
+  }
+
+  RegionRecord record;
+  record.streamId  = streamId;
+  record.start     = stack.back().second;
+  record.end       = time;
+  record.regionRef = regionRef;
+  record.depth     = stack.size() - 1;
+
+  regions.push_back( record );
+  stack.pop_back();
+}
+
+void
+GraphStore::addRegionName( uint32_t regionRef, const char* name )
+{
+  regionNames[ regionRef ] = name;
+}
+
+void
+GraphStore::addNode( const GraphNode* node )
+{
+  NodeRecord record;
+  memset( &record, 0, sizeof( record ) );
+  record.id         = node->getId();
+  record.time       = node->getTime();
+  record.streamId   = node->getStreamId();
+  record.functionId = node->getFunctionId();
+  record.type       = node->getType();
+  record.recordType = node->getRecordType();
+  record.paradigm   = node->getParadigm();
+
+  if ( node->isOnCriticalPath() )
+  {
+    record.flags |= NODE_CRITICAL;
+  }
+
+  nodes.push_back( record );
+}
+
+void
+GraphStore::addEdge( const Edge* edge )
+{
+  EdgeRecord record;
+  record.startId  = edge->getStartNode()->getId();
+  record.endId    = edge->getEndNode()->getId();
+  record.duration = edge->getDuration();
+  record.blame    = edge->getTotalBlame();
+  record.flags    = edge->isBlocking() ? EDGE_BLOCKING : 0;
+  record.reserved = 0;
+
+  edges.push_back( record );
+}
+
+void
+GraphStore::addRemoteNode( uint64_t nodeId, uint64_t remoteStreamId,
+                           uint64_t remoteNodeId )
+{
+  RemoteRecord record;
+  record.nodeId         = nodeId;
+  record.remoteStreamId = remoteStreamId;
+  record.remoteNodeId   = remoteNodeId;
+
+  remoteNodes.push_back( record );
+}
+
+/**
+ * Append the records of the current analysis interval to the graph file.
+ */
+void
+GraphStore::flush()
+{
+  if ( !file )
+  {
+    return;
+  }
+
+  writeBlock( BLOCK_NODES, nodes );
+  writeBlock( BLOCK_EDGES, edges );
+  writeBlock( BLOCK_REMOTE_NODES, remoteNodes );
+  writeBlock( BLOCK_REGIONS, regions );
+}
+
+/**
+ * Write the region names and mark the graph as complete. Regions that are
+ * still open are not stored.
+ *
+ * @param criticalPathLength global length of the critical path
+ */
+void
+GraphStore::finish( uint64_t criticalPathLength )
+{
+  if ( !file )
+  {
+    return;
+  }
+
+  flush();
+
+  if ( !regionNames.empty() )
+  {
+    BlockHeader block;
+    block.type     = BLOCK_REGION_NAMES;
+    block.reserved = 0;
+    block.count    = regionNames.size();
+    write( &block, sizeof( block ) );
+
+    for ( std::map< uint32_t, std::string >::const_iterator iter =
+            regionNames.begin(); iter != regionNames.end(); ++iter )
+    {
+      uint32_t entry[ 2 ] = { iter->first, ( uint32_t )iter->second.size() };
+      write( entry, sizeof( entry ) );
+      write( iter->second.data(), iter->second.size() );
+    }
+  }
+
+  // an empty critical path would mark the graph as incomplete
+  this->criticalPathLength = std::max( criticalPathLength, ( uint64_t )1 );
+
+  if ( fseek( file, offsetof( StoreHeader, criticalPathLength ), SEEK_SET ) != 0 )
+  {
+    throw RTException( "Could not complete graph file %s", fileName.c_str() );
+  }
+  write( &this->criticalPathLength, sizeof( uint64_t ) );
+
+  close();
+}
+
+void
+GraphStore::close()
+{
+  if ( file )
+  {
+    fclose( file );
+    file = NULL;
+  }
+}
+
+void
+GraphStore::write( const void* data, uint64_t bytes )
+{
+  if ( bytes > 0 && fwrite( data, bytes, 1, file ) != 1 )
+  {
+    throw RTException( "Could not write graph file %s", fileName.c_str() );
+  }
+}
+
+/**
+ * Write the records as a block and clear them.
+ *
+ * @param type block type
+ * @param records records of the block
+ */
+template < class T >
+void
+GraphStore::writeBlock( BlockType type, std::vector< T >& records )
+{
+  if ( records.empty() )
+  {
+    return;
+  }
+
+  BlockHeader block;
+  block.type     = type;
+  block.reserved = 0;
+  block.count    = records.size();
+
+  write( &block, sizeof( block ) );
+  write( &records[ 0 ], records.size() * sizeof( T ) );
+
+  records.clear();
+}
+
+/**
+ * Append the records of a block to the given records.
+ *
+ * @param input graph file
+ * @param count number of records in the block
+ * @param records read records
+ *
+ * @return false, if the block is incomplete
+ */
+template < class T >
+bool
+GraphStore::readBlock( FILE* input, uint64_t count, std::vector< T >& records )
+{
+  if ( count == 0 )
+  {
+    return true;
+  }
+
+  size_t first = records.size();
+  records.resize( first + count );
+
+  return fread( &records[ first ], sizeof( T ), count, input ) == count;
+}
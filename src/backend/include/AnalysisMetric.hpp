@@ -37,7 +37,9 @@ namespace casita
     BLAME4IDLE = 4,    // blame received for not keeping the device busy (internal)
     OMPT_REGION_ID = 5,        // internal
     OMP_IGNORE_BARRIER = 6,    // internal
-    OMP_FIRST_OFFLOAD_EVT = 7  // internal
+    OMP_FIRST_OFFLOAD_EVT = 7, // internal
+    
+    NUM_METRIC_TYPES = 8 // number of counter slots in a node
   };
   
   /* Reasons of blame (mostly corresponds to inefficiency patterns) */
@@ -249,14 +251,15 @@ namespace casita
        * metric type.
        * 
        * @param metricId internal metric type
+       * @param asCounter write attributes as counter (no events to attach to)
        * 
        * @return the new OTF2 metric or attribute ID
        */
       uint32_t
-      newOtf2Id( MetricType metricId )
+      newOtf2Id( MetricType metricId, bool asCounter = false )
       {
         const MetricEntry* entry = getMetric( metricId );
-        if( entry->metricMode == ATTRIBUTE )
+        if( entry->metricMode == ATTRIBUTE && !asCounter )
         {          
           maxAttrId++;
           
@@ -55,6 +55,9 @@ namespace casita
 
      Graph*
      getGraph( Paradigm paradigm );
+     
+     uint64_t
+     getGraphBytes() const;
 
      AnalysisMetric&
      getCtrTable();
@@ -0,0 +1,232 @@
+/*
+ * This file is part of the CASITA software
+ *
+ * Copyright (c) 2019,
+ * Technische Universitaet Dresden, Germany
+ *
+ * This software may be modified and distributed under the terms of
+ * a BSD-style license. See the COPYING file in the package base
+ * directory for details.
+ *
+ */
+
+#pragma once
+
+#include <stdio.h>
+#include <stdint.h>
+#include <map>
+#include <string>
+#include <vector>
+
+#include "graph/GraphNode.hpp"
+#include "graph/Edge.hpp"
+
+namespace casita
+{
+ /**
+  * Compact on-disk copy of the analyzed graph of an analysis process. The
+  * nodes and edges of every analysis interval are appended after the critical
+  * path detection together with the remote MPI partners of the nodes and the
+  * region instances (enter to leave) of the local streams. The stored graphs
+  * of all analysis processes allow to replay the critical path for a set of
+  * removed regions without reading the trace again (see casita-predict).
+  */
+ class GraphStore
+ {
+   public:
+     enum NodeFlag
+     {
+       NODE_CRITICAL = ( 1 << 0 )  //!< node is on the critical path
+     };
+
+     enum EdgeFlag
+     {
+       EDGE_BLOCKING = ( 1 << 0 )  //!< edge is a wait state
+     };
+
+     typedef struct
+     {
+       uint64_t id;
+       uint64_t time;
+       uint64_t streamId;
+       uint32_t functionId;
+       uint32_t type;
+       uint8_t  recordType;
+       uint8_t  paradigm;
+       uint8_t  flags;
+       uint8_t  reserved[ 5 ];
+     } NodeRecord;
+
+     typedef struct
+     {
+       uint64_t startId;
+       uint64_t endId;
+       uint64_t duration;
+       double   blame;
+       uint32_t flags;
+       uint32_t reserved;
+     } EdgeRecord;
+
+     //!< the local node waited for the node of another analysis process
+     typedef struct
+     {
+       uint64_t nodeId;
+       uint64_t remoteStreamId;
+       uint64_t remoteNodeId;
+     } RemoteRecord;
+
+     //!< region instance on a stream (nested regions have a higher depth)
+     typedef struct
+     {
+       uint64_t streamId;
+       uint64_t start;
+       uint64_t end;
+       uint32_t regionRef;
+       uint32_t depth;
+     } RegionRecord;
+
+     GraphStore();
+
+     virtual
+     ~GraphStore();
+
+     static std::string
+     getFileName( const std::string& directory, const std::string& traceFile,
+                  uint32_t mpiRank, uint32_t mpiSize );
+
+     void
+     create( const std::string& fileName, uint32_t mpiRank, uint32_t mpiSize,
+             uint64_t timerResolution );
+
+     bool
+     open( const std::string& fileName );
+
+     void
+     addRegionEnter( uint64_t streamId, uint32_t regionRef, uint64_t time );
+
+     void
+     addRegionLeave( uint64_t streamId, uint32_t regionRef, uint64_t time );
+
+     void
+     addRegionName( uint32_t regionRef, const char* name );
+
+     void
+     addNode( const GraphNode* node );
+
+     void
+     addEdge( const Edge* edge );
+
+     void
+     addRemoteNode( uint64_t nodeId, uint64_t remoteStreamId,
+                    uint64_t remoteNodeId );
+
+     void
+     flush();
+
+     void
+     finish( uint64_t criticalPathLength );
+
+     void
+     close();
+
+     /**
+      * @return true, if the graph is written
+      */
+     bool
+     isWritable() const
+     {
+       return file != NULL;
+     }
+
+     uint32_t
+     getMPIRank() const
+     {
+       return mpiRank;
+     }
+
+     uint32_t
+     getMPISize() const
+     {
+       return mpiSize;
+     }
+
+     uint64_t
+     getTimerResolution() const
+     {
+       return timerResolution;
+     }
+
+     uint64_t
+     getCriticalPathLength() const
+     {
+       return criticalPathLength;
+     }
+
+     //!< records of the current interval (written) or of the file (read)
+     std::vector< NodeRecord >   nodes;
+     std::vector< EdgeRecord >   edges;
+     std::vector< RemoteRecord > remoteNodes;
+     std::vector< RegionRecord > regions;
+
+     //!< region reference -> region name
+     std::map< uint32_t, std::string > regionNames;
+
+   private:
+     //!< file header, the critical path length is set when the graph is complete
+     typedef struct
+     {
+       char     magic[ 8 ];
+       uint32_t version;
+       uint32_t mpiRank;
+       uint32_t mpiSize;
+       uint32_t reserved;
+       uint64_t timerResolution;
+       uint64_t criticalPathLength;  //!< (0 = incomplete)
+     } StoreHeader;
+
+     //!< header of a block of records of the same kind
+     typedef struct
+     {
+       uint32_t type;
+       uint32_t reserved;
+       uint64_t count;
+     } BlockHeader;
+
+     enum BlockType
+     {
+       BLOCK_NODES = 1,
+       BLOCK_EDGES,
+       BLOCK_REMOTE_NODES,
+       BLOCK_REGIONS,
+       BLOCK_REGION_NAMES
+     };
+
+     //!< open region on a stream (region reference, enter time)
+     typedef std::pair< uint32_t, uint64_t > OpenRegion;
+     typedef std::map< uint64_t, std::vector< OpenRegion > > OpenRegionMap;
+
+     std::string fileName;
+
+     //!< graph file that is written (NULL, if not written)
+     FILE* file;
+
+     uint32_t mpiRank;
+     uint32_t mpiSize;
+     uint64_t timerResolution;
+     uint64_t criticalPathLength;
+
+     //!< call stacks of the local streams
+     OpenRegionMap openRegions;
+
+     void
+     write( const void* data, uint64_t bytes );
+
+     template < class T >
+     void
+     writeBlock( BlockType type, std::vector< T >& records );
+
+     template < class T >
+     static bool
+     readBlock( FILE* input, uint64_t count, std::vector< T >& records );
+ };
+}
@@ -52,6 +52,29 @@
 
 namespace casita
 {
+  /**
+   * Get the analysis process (MPI rank of CASITA) that owns the given traced
+   * MPI rank. If fewer analysis processes than traced ranks are used, the 
+   * traced ranks are distributed in contiguous blocks of (almost) equal size.
+   * 
+   * @param tracedRank MPI rank in the trace (OTF2 location group)
+   * @param numTracedRanks number of MPI ranks in the trace
+   * @param numAnalysisRanks number of CASITA analysis processes
+   * 
+   * @return rank of the owning analysis process
+   */
+  inline uint32_t
+  getAnalysisRank( uint64_t tracedRank, uint64_t numTracedRanks, 
+                   uint64_t numAnalysisRanks )
+  {
+    if ( numTracedRanks <= numAnalysisRanks )
+    {
+      return ( uint32_t ) tracedRank;
+    }
+    
+    return ( uint32_t ) ( tracedRank * numAnalysisRanks / numTracedRanks );
+  }
+
   class RTException :
     virtual public std::runtime_error
   {
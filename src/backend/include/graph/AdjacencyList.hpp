@@ -0,0 +1,201 @@
+/*
+ * This file is part of the CASITA software
+ *
+ * Copyright (c) 2019,
+ * Technische Universitaet Dresden, Germany
+ *
+ * This software may be modified and distributed under the terms of
+ * a BSD-style license. See the COPYING file in the package base
+ * directory for details.
+ *
+ */
+
+#pragma once
+
+#include <stdint.h>
+#include <stddef.h>
+#include <string.h>
+
+namespace casita
+{
+ class Edge;
+
+ /**
+  * Small edge list with inline storage. Most graph nodes have only one or two
+  * in- and out-edges, which are stored in the object itself. Larger lists are
+  * moved to a separately allocated array. The interface is a subset of the
+  * std::vector interface.
+  */
+ class AdjacencyList
+ {
+   public:
+     typedef Edge* const* const_iterator;
+     typedef Edge**       iterator;
+
+     //!< number of edges that are stored without a separate allocation
+     static const uint32_t INLINE_EDGES = 2;
+
+     AdjacencyList() :
+       edges( inlineEdges ),
+       count( 0 ),
+       capacity( INLINE_EDGES )
+     {
+
+     }
+
+     AdjacencyList( const AdjacencyList& other ) :
+       edges( inlineEdges ),
+       count( 0 ),
+       capacity( INLINE_EDGES )
+     {
+       assign( other );
+     }
+
+     AdjacencyList&
+     operator=( const AdjacencyList& other )
+     {
+       if ( this != &other )
+       {
+         clear();
+         assign( other );
+       }
+
+       return *this;
+     }
+
+     ~AdjacencyList()
+     {
+       if ( edges != inlineEdges )
+       {
+         delete[] edges;
+       }
+     }
+
+     size_t
+     size() const
+     {
+       return count;
+     }
+
+     bool
+     empty() const
+     {
+       return count == 0;
+     }
+
+     const_iterator
+     begin() const
+     {
+       return edges;
+     }
+
+     const_iterator
+     end() const
+     {
+       return edges + count;
+     }
+
+     iterator
+     begin()
+     {
+       return edges;
+     }
+
+     iterator
+     end()
+     {
+       return edges + count;
+     }
+
+     Edge*
+     front() const
+     {
+       return edges[ 0 ];
+     }
+
+     Edge*
+     back() const
+     {
+       return edges[ count - 1 ];
+     }
+
+     Edge*
+     operator[]( size_t index ) const
+     {
+       return edges[ index ];
+     }
+
+     void
+     push_back( Edge* edge )
+     {
+       if ( count == capacity )
+       {
+         grow();
+       }
+
+       edges[ count++ ] = edge;
+     }
+
+     /**
+      * Remove the edge at the given position (keeps the order of the edges).
+      *
+      * @param pos position of the edge
+      *
+      * @return iterator to the edge after the removed one
+      */
+     iterator
+     erase( iterator pos )
+     {
+       memmove( pos, pos + 1, ( end() - pos - 1 ) * sizeof( Edge* ) );
+       count--;
+
+       return pos;
+     }
+
+     /**
+      * Remove all edges and release the separately allocated array.
+      */
+     void
+     clear()
+     {
+       if ( edges != inlineEdges )
+       {
+         delete[] edges;
+         edges = inlineEdges;
+       }
+
+       count    = 0;
+       capacity = INLINE_EDGES;
+     }
+
+   private:
+     Edge*    inlineEdges[ INLINE_EDGES ];
+     Edge**   edges;    //!< inline edges or separately allocated array
+     uint32_t count;
+     uint32_t capacity;
+
+     void
+     grow()
+     {
+       Edge** newEdges = new Edge*[ 2 * capacity ];
+       memcpy( newEdges, edges, count * sizeof( Edge* ) );
+
+       if ( edges != inlineEdges )
+       {
+         delete[] edges;
+       }
+
+       edges     = newEdges;
+       capacity *= 2;
+     }
+
+     void
+     assign( const AdjacencyList& other )
+     {
+       for ( const_iterator iter = other.begin(); iter != other.end(); ++iter )
+       {
+         push_back( *iter );
+       }
+     }
+ };
+}
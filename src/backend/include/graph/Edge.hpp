@@ -13,7 +13,7 @@
 #pragma once
 
 #include <sstream>
-#include <map>
+#include <algorithm>
 
 #include "GraphNode.hpp"
 #include "utils/Utils.hpp"
@@ -21,7 +21,8 @@
 namespace casita
 {
   
- typedef std::map< BlameReason, double > BlameMap;
+ //!< blame value per blame reason (index is the blame reason)
+ typedef double BlameArray[ REASON_NUMBER ];
   
  class Edge
  {
@@ -31,8 +32,8 @@ namespace casita
        startNode( start ),
        endNode( end ),
        blocking( blocking ),
-       paradigm( edgeParadigm )//,
-       //blame ( 0 )
+       paradigm( edgeParadigm ),
+       blame( NULL )
      {
        if ( isReverseEdge() )
        {
@@ -43,6 +44,44 @@ namespace casita
        this->duration = duration;      
      }
 
+     ~Edge()
+     {
+       getBlameAllocator().release( blame );
+     }
+
+     /**
+      * Edges are allocated from a slab allocator (see SlabAllocator).
+      */
+     static void*
+     operator new( size_t size )
+     {
+       if ( size != sizeof( Edge ) )
+       {
+         return ::operator new( size );
+       }
+
+       return getAllocator().allocate( size );
+     }
+
+     static void
+     operator delete( void* ptr, size_t size )
+     {
+       if ( size != sizeof( Edge ) )
+       {
+         ::operator delete( ptr );
+         return;
+       }
+
+       getAllocator().release( ptr );
+     }
+
+     static SlabAllocator&
+     getAllocator()
+     {
+       static SlabAllocator allocator( sizeof( Edge ) );
+       return allocator;
+     }
+
      bool
      hasEdgeType( Paradigm edgeParadigm ) const
      {
@@ -193,53 +232,63 @@ namespace casita
           
      void addBlame( double value, BlameReason type = REASON_UNCLASSIFIED )
      {
-       BlameMap::iterator blameIt = this->blame.find( type );
-       if ( blameIt == this->blame.end() )
+       // the blame array is only allocated for edges with blame
+       if ( blame == NULL )
        {
-         this->blame[ type ] = value;
-       }
-       else
-       {
-         blameIt->second += value;
+         blame = (double*) getBlameAllocator().allocate( sizeof( BlameArray ) );
+         std::fill( blame, blame + REASON_NUMBER, 0.0 );
        }
+       
+       blame[ type ] += value;
      }
      
-     double getBlame( BlameReason type = REASON_UNCLASSIFIED )
+     double getBlame( BlameReason type = REASON_UNCLASSIFIED ) const
      {
-       BlameMap::const_iterator iter = this->blame.find( type );
-       if ( iter == this->blame.end() )
+       if ( blame == NULL )
        {
          return 0;
        }
-       else
-       {
-         return iter->second;
-       }
+       
+       return blame[ type ];
      }
      
      /**
       * Get the accumulated blame, independent of the blame reason.
       * @return 
       */
-     double getTotalBlame()
+     double getTotalBlame() const
      {
        double total_blame = 0;
-       for( BlameMap::const_iterator it = this->blame.begin();
-           it != this->blame.end(); it++)
+       
+       if ( blame )
        {
-         total_blame += it->second;
+         for ( int i = 0; i < REASON_NUMBER; ++i )
+         {
+           total_blame += blame[ i ];
+         }
        }
+       
        return total_blame;
      }
      
      /**
-      * Return the address of the blame map.
+      * Return the blame values of this edge (index is the blame reason).
       * 
-      * @return address of the blame map
+      * @return blame values or NULL, if the edge has no blame
       */
-     BlameMap* getBlameMap()
+     const double* getBlameArray() const
      {
-       return &(this->blame);
+       return blame;
+     }
+     
+     /**
+      * The blame arrays of all edges are allocated from a slab allocator.
+      */
+     static SlabAllocator&
+     getBlameAllocator()
+     {
+       static SlabAllocator allocator( sizeof( BlameArray ) );
+       return allocator;
      }
 
    private:
@@ -250,10 +299,14 @@ namespace casita
      bool     blocking;
      Paradigm paradigm;
 
-     //double blame;
+     //!< blame per blame reason (NULL, if the edge has no blame)
+     double*  blame;
+     
+     // edges own their blame array and must not be copied
+     Edge( const Edge& );
      
-     //!< blame type, blame value
-     BlameMap blame;
+     Edge&
+     operator=( const Edge& );
 
      static uint64_t
      computeWeight( uint64_t duration, bool blocking )
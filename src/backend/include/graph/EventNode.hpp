@@ -42,6 +42,39 @@ namespace casita
      {
      }
 
+     /**
+      * Event nodes are allocated from a slab allocator (see SlabAllocator).
+      */
+     static void*
+     operator new( size_t size )
+     {
+       if ( size != sizeof( EventNode ) )
+       {
+         return ::operator new( size );
+       }
+
+       return getAllocator().allocate( size );
+     }
+
+     static void
+     operator delete( void* ptr, size_t size )
+     {
+       if ( size != sizeof( EventNode ) )
+       {
+         ::operator delete( ptr );
+         return;
+       }
+
+       getAllocator().release( ptr );
+     }
+
+     static SlabAllocator&
+     getAllocator()
+     {
+       static SlabAllocator allocator( sizeof( EventNode ) );
+       return allocator;
+     }
+
      uint64_t
      getEventId( ) const
      {
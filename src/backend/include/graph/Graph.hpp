@@ -27,7 +27,7 @@ namespace casita
  class Graph
  {
    public:
-     typedef std::vector< Edge* > EdgeList;
+     typedef AdjacencyList EdgeList;
      typedef std::set< Edge* > EdgeSet;
      typedef std::vector< GraphNode* > NodeList;
      typedef std::map< GraphNode*, EdgeList > NodeEdges;
@@ -42,6 +42,12 @@ namespace casita
       */
      void
      cleanup( bool deleteEdges );
+     
+     void
+     detachEdges( NodeList& edgeEnds );
+     
+     static void
+     releaseEdges( NodeList& edgeEnds );
 
      void
      addNode( GraphNode* node );
@@ -76,8 +82,13 @@ namespace casita
 
    protected:
      NodeList  nodes;
+     
+     //!< edges of sub graphs (the main graph stores the edges in the nodes)
      NodeEdges inEdges, outEdges;
      bool      isSubGraph;
+     
+     //!< nodes with in-edges in the main graph (end nodes of all edges)
+     NodeList  edgeEndNodes;
 
      typedef std::map< GraphNode*, uint64_t > DistanceMap;
 
@@ -90,6 +101,12 @@ namespace casita
                    DistanceMap& distanceMap );
    
    private:     
+     EdgeList&
+     getInEdgeList( GraphNode* node );
+     
+     EdgeList&
+     getOutEdgeList( GraphNode* node );
+     
      void
      printInEdges( GraphNode* node ) const;
      
@@ -19,6 +19,8 @@
 #include <algorithm> // binary search
 
 #include "Node.hpp"
+#include "AdjacencyList.hpp"
+#include "SlabAllocator.hpp"
 
 namespace casita
 {
@@ -38,6 +40,7 @@ namespace casita
        Node( time, streamId, name, paradigm, recordType, nodeType ),
        linkLeft( NULL ),
        linkRight( NULL ),
+       streamPredecessor( NULL ),
        caller( NULL ),
        data( NULL )
      {
@@ -51,6 +54,39 @@ namespace casita
 
      }
 
+     /**
+      * Graph nodes are allocated from a slab allocator (see SlabAllocator).
+      */
+     static void*
+     operator new( size_t size )
+     {
+       if ( size != sizeof( GraphNode ) )
+       {
+         return ::operator new( size );
+       }
+
+       return getAllocator().allocate( size );
+     }
+
+     static void
+     operator delete( void* ptr, size_t size )
+     {
+       if ( size != sizeof( GraphNode ) )
+       {
+         ::operator delete( ptr );
+         return;
+       }
+
+       getAllocator().release( ptr );
+     }
+
+     static SlabAllocator&
+     getAllocator()
+     {
+       static SlabAllocator allocator( sizeof( GraphNode ) );
+       return allocator;
+     }
+
      /**
       * Set the partner node of an enter or leave.
       * 
@@ -74,6 +110,37 @@ namespace casita
        assert( partner->getRecordType() != this->getRecordType() );
      }
 
+     /**
+      * Create a copy of this node without edges and stream links. The copy 
+      * has the same ID, time, type and counter values (e.g. to continue the
+      * graph of the next analysis interval, while this node is still in use).
+      * 
+      * @return the new node
+      */
+     GraphNode*
+     copyNode() const
+     {
+       GraphNode* node = new GraphNode( *this );
+       
+       node->inEdges.clear();
+       node->outEdges.clear();
+       node->linkLeft          = NULL;
+       node->linkRight         = NULL;
+       node->streamPredecessor = NULL;
+       
+       if ( pair.first == this )
+       {
+         node->pair.first = node;
+       }
+       
+       if ( pair.second == this )
+       {
+         node->pair.second = node;
+       }
+       
+       return node;
+     }
+
      virtual bool
      hasPartner() const
      {
@@ -139,6 +206,22 @@ namespace casita
        return linkRight;
      }
 
+     /**
+      * The stream predecessor is the previous node in the sorted node list of
+      * the node's stream. It is maintained by the event stream.
+      */
+     void
+     setStreamPredecessor( GraphNode* predecessor )
+     {
+       this->streamPredecessor = predecessor;
+     }
+
+     GraphNode*
+     getStreamPredecessor() const
+     {
+       return streamPredecessor;
+     }
+
      void
      setData( void* value )
      {
@@ -156,6 +239,30 @@ namespace casita
        return this->data;
      }
      
+     /**
+      * In-edges of this node in the (main) graph. Use Graph to add and 
+      * remove edges.
+      * 
+      * @return list of in-edges
+      */
+     AdjacencyList&
+     getInEdgeList()
+     {
+       return inEdges;
+     }
+     
+     /**
+      * Out-edges of this node in the (main) graph. Use Graph to add and 
+      * remove edges.
+      * 
+      * @return list of out-edges
+      */
+     AdjacencyList&
+     getOutEdgeList()
+     {
+       return outEdges;
+     }
+     
      bool
      isOnCriticalPath() const
      {
@@ -719,8 +826,10 @@ namespace casita
    protected:
      GraphNodePair pair; //<! enter, leave node pair
      GraphNode*    linkLeft, * linkRight; //<! link nodes on a stream
+     GraphNode*    streamPredecessor; //<! previous node on the stream
      GraphNode*    caller;
      void* data; /**< node specific data pointer */
+     AdjacencyList inEdges, outEdges; //<! edges of the node in the graph
  };
  
  typedef std::deque< GraphNode* > GraphNodeQueue;
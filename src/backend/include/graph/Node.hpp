@@ -782,7 +782,8 @@ namespace casita
        paradigm( paradigm ),
        nodeType( nodeType ),
        link( NULL ),
-       referencedStream( 0 )
+       referencedStream( 0 ),
+       counterMask( 0 )
      {
        id = ++globalNodeId;
      }
@@ -790,7 +791,7 @@ namespace casita
      virtual
      ~Node()
      {
-       counters.clear();
+
      }
 
      uint64_t
@@ -963,54 +964,52 @@ namespace casita
      void
      setCounter( MetricType metric, uint64_t value )
      {
-       counters[metric] = value;
+       counters[ metric ] = value;
+       counterMask |= ( 1 << metric );
      }
 
      void
      incCounter( MetricType metric, uint64_t value )
      {
-       if ( counters.find( metric ) != counters.end() )
+       if ( hasCounter( metric ) )
        {
-         counters[metric] += value;
+         counters[ metric ] += value;
        }
        else
        {
-         counters[metric] = value;
+         setCounter( metric, value );
        }
      }
 
      uint64_t
      getCounter( MetricType metric, bool* valid = NULL ) const
      {
-       std::map< MetricType, uint64_t >::const_iterator iter =
-         counters.find( metric );
-       if ( iter == counters.end() )
-       {
-         if ( valid )
-         {
-           *valid = false;
-         }
-         return 0;
-       }
-
+       bool available = hasCounter( metric );
+       
        if ( valid )
        {
-         *valid = true;
+         *valid = available;
        }
 
-       return iter->second;
+       return available ? counters[ metric ] : 0;
+     }
+
+     bool
+     hasCounter( MetricType metric ) const
+     {
+       return counterMask & ( 1 << metric );
      }
 
      void
      removeCounter( MetricType metric )
      {
-       counters.erase( metric );
+       counterMask &= ~( 1 << metric );
      }
 
      void
      removeCounters()
      {
-       counters.clear();
+       counterMask = 0;
      }
 
    protected:
@@ -1037,19 +1036,14 @@ namespace casita
      
      uint64_t referencedStream;
      
-     //!< metric type, counter value
-     std::map< MetricType, uint64_t > counters;
+     //!< counter values, indexed by metric type (valid if set in counterMask)
+     uint64_t counters[ NUM_METRIC_TYPES ];
      
-     // map costs = map object + node overhead
-     // from http://info.prelert.com/blog/stl-container-memory-usage
-     // GNU Standard C++ Library v3: 48 bytes + 32 bytes (min 48 bytes)
-     // Visual C++ 12: 16 bytes + 32 bytes (min 48 bytes as one more node than size of map needed)
-     // LLVM's libc++: 24 bytes + 32 bytes (min 24 bytes)
+     //!< bit i is set, if the counter of metric type i is available
+     uint8_t  counterMask;
      
-     // individual values cost 1 + 8 + 8 = 17 bytes
-     // bool criticalPath;
-     // uint64_t waitingTime
-     // types: late sender, late receiver, OpenMP barrier, MPI collective
+     // a std::map would cost at least 48 bytes for the map object plus 
+     // 48 bytes per counter and one allocation per counter
  };
 
  typedef struct
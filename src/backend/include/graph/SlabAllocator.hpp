@@ -0,0 +1,213 @@
+/*
+ * This file is part of the CASITA software
+ *
+ * Copyright (c) 2019,
+ * Technische Universitaet Dresden, Germany
+ *
+ * This software may be modified and distributed under the terms of
+ * a BSD-style license. See the COPYING file in the package base
+ * directory for details.
+ *
+ */
+
+#pragma once
+
+#include <stdint.h>
+#include <stddef.h>
+#include <new>
+#include <vector>
+
+namespace casita
+{
+ /**
+  * Allocator for objects of a fixed size. Objects are placed in large slabs
+  * and released objects are kept in a free list, which is used by the next
+  * allocations. Graph nodes and edges are created and deleted for every
+  * analysis interval. The allocator avoids a malloc/free per event and keeps
+  * the objects of an interval close to each other in memory. Objects that
+  * survive an interval stay in place (pointers to them remain valid).
+  *
+  * The allocator is not thread-safe.
+  */
+ class SlabAllocator
+ {
+   public:
+     //!< default number of objects per slab
+     static const size_t OBJECTS_PER_SLAB = 4096;
+
+     SlabAllocator( size_t objectSize, size_t objectsPerSlab = OBJECTS_PER_SLAB ) :
+       objectSize( alignSize( objectSize ) ),
+       slabSize( alignSize( objectSize ) * objectsPerSlab ),
+       currentSlab( 0 ),
+       next( NULL ),
+       end( NULL ),
+       freeList( NULL ),
+       numObjects( 0 )
+     {
+
+     }
+
+     ~SlabAllocator()
+     {
+       for ( std::vector< char* >::const_iterator iter = slabs.begin();
+             iter != slabs.end(); ++iter )
+       {
+         ::operator delete( *iter );
+       }
+     }
+
+     /**
+      * Get memory for one object.
+      *
+      * @param size size of the object (has to fit into the slots)
+      *
+      * @return pointer to uninitialized memory of the object size
+      */
+     void*
+     allocate( size_t size )
+     {
+       if ( size > objectSize )
+       {
+         throw std::bad_alloc();
+       }
+
+       numObjects++;
+
+       if ( freeList )
+       {
+         FreeSlot* slot = freeList;
+         freeList = slot->next;
+         return slot;
+       }
+
+       if ( next == end )
+       {
+         nextSlab();
+       }
+
+       void* ptr = next;
+       next += objectSize;
+
+       return ptr;
+     }
+
+     /**
+      * Return the memory of an object to the allocator. The memory is reused
+      * for the next allocations.
+      *
+      * @param ptr memory of the object (NULL is ignored)
+      */
+     void
+     release( void* ptr )
+     {
+       if ( ptr == NULL )
+       {
+         return;
+       }
+
+       FreeSlot* slot = (FreeSlot*) ptr;
+       slot->next = freeList;
+       freeList   = slot;
+
+       numObjects--;
+     }
+
+     /**
+      * Reuse all slabs from the beginning. This is only possible if no object
+      * is alive (e.g. all edges of an interval have been deleted). Otherwise,
+      * nothing is done.
+      *
+      * @return true, if the slabs have been reset
+      */
+     bool
+     reset()
+     {
+       if ( numObjects > 0 )
+       {
+         return false;
+       }
+
+       freeList    = NULL;
+       currentSlab = 0;
+       next        = NULL;
+       end         = NULL;
+
+       return true;
+     }
+
+     /**
+      * @return number of objects that are currently allocated
+      */
+     uint64_t
+     getNumObjects() const
+     {
+       return numObjects;
+     }
+
+     /**
+      * @return number of bytes that are used by the allocated objects
+      */
+     uint64_t
+     getUsedBytes() const
+     {
+       return numObjects * objectSize;
+     }
+
+     /**
+      * @return number of bytes that are reserved by the slabs
+      */
+     uint64_t
+     getBytes() const
+     {
+       return (uint64_t) slabs.size() * slabSize;
+     }
+
+   private:
+     typedef struct FreeSlot
+     {
+       FreeSlot* next;
+     } FreeSlot;
+
+     size_t objectSize;
+     size_t slabSize;
+
+     std::vector< char* > slabs;
+
+     //!< index of the next slab to use, if the current one is full
+     size_t currentSlab;
+
+     //!< bump pointer and end of the current slab
+     char* next;
+     char* end;
+
+     //!< released objects
+     FreeSlot* freeList;
+
+     uint64_t numObjects;
+
+     static size_t
+     alignSize( size_t size )
+     {
+       // keep the objects aligned to 16 bytes (enough for all members)
+       if ( size < sizeof( FreeSlot ) )
+       {
+         size = sizeof( FreeSlot );
+       }
+
+       return ( size + 15 ) & ~( (size_t) 15 );
+     }
+
+     void
+     nextSlab()
+     {
+       // allocate a new slab, if all existing slabs are in use
+       if ( currentSlab == slabs.size() )
+       {
+         slabs.push_back( (char*) ::operator new( slabSize ) );
+       }
+
+       next = slabs[ currentSlab++ ];
+       end  = next + slabSize;
+     }
+ };
+}
@@ -15,6 +15,10 @@
 #include <otf2/otf2.h>
 
 #include <map>
+#include <vector>
+
+#include "FunctionTable.hpp"
+#include "utils/Utils.hpp"
 
 //#include "AnalysisEngine.hpp"
 
@@ -76,8 +80,30 @@ namespace casita
         uint32_t
         createNewRegion( const char* string, OTF2_Paradigm paradigm );
         
+        /**
+         * Returns the region information. Needed in every enter and leave 
+         * event during trace reading and writing.
+         *
+         * @param regionRef ID of region the information is requested for
+         * @return region information (name, paradigm, role)
+         */
         const RegionInfo&
-        getRegionInfo( const uint32_t regionRef ) const;
+        getRegionInfo( const uint32_t regionRef ) const
+        {
+          UTILS_ASSERT( regionRef < regions.size(), 
+                        "Could not find region reference %u!", regionRef );
+
+          return regions[ regionRef ];
+        }
+        
+        /**
+         * @return number of region references (including undefined regions)
+         */
+        uint32_t
+        getNumRegions() const
+        {
+          return regions.size();
+        }
      
         const char*
         getRegionName( uint32_t id ) const;
@@ -100,7 +126,53 @@ namespace casita
         uint32_t
         getForkJoinRegionId() const;
         
+        void
+        classifyRegions( bool ignoreMPI );
+        
+        /**
+         * Get the function type of a region. Uses the classification of 
+         * classifyRegions(), which is only a table lookup. Regions that have
+         * been created afterwards are classified by name.
+         * 
+         * @param regionRef OTF2 region reference
+         * @param deviceStream does the event occur on a device stream
+         * @param deviceNullStreamOnly do we have only the device null stream
+         * @param descr function descriptor (paradigm and function type are set)
+         * 
+         * @return true, if it maps to an internal node, otherwise false
+         */
+        bool
+        getFunctionType( uint32_t regionRef, bool deviceStream, 
+                         bool deviceNullStreamOnly, 
+                         FunctionDescriptor* descr ) const
+        {
+          size_t idx = ( ( size_t ) regionRef << 2 ) | 
+                       ( deviceStream << 1 ) | deviceNullStreamOnly;
+          
+          if( idx < regionClasses.size() )
+          {
+            const RegionClass& regionClass = regionClasses[ idx ];
+            descr->paradigm     = regionClass.paradigm;
+            descr->functionType = regionClass.functionType;
+            
+            return regionClass.internal;
+          }
+          
+          const RegionInfo& regionInfo = getRegionInfo( regionRef );
+          
+          return FunctionTable::getAPIFunctionType( descr, regionInfo.name, 
+            regionInfo.paradigm, deviceStream, deviceNullStreamOnly, 
+            classifyIgnoreMPI );
+        }
+        
       private:
+        typedef struct
+        {
+          Paradigm paradigm;
+          int      functionType;
+          bool     internal; //!< maps to an internal node
+        } RegionClass;
+        
         //<! pointer to the one and only analysis engine
         //AnalysisEngine* analysis;
         
@@ -109,13 +181,15 @@ namespace casita
         uint64_t timerOffset;
         uint64_t traceLength;
 
-        //!< maps OTF2 IDs to strings (global definitions), maps are ordered by key
-        std::map< uint32_t, const char* > stringRefMap;
+        //!< strings of the global definitions, indexed by the OTF2 string 
+        //!< reference (OTF2 references are dense, NULL for undefined strings)
+        std::vector< const char* > strings;
         
-        //!< store required definitions for a function ID (OTF2 region reference)
-        std::map< uint32_t, RegionInfo > regionInfoMap;
+        //!< required definitions of the regions, indexed by the OTF2 region
+        //!< reference (name is NULL for undefined regions)
+        std::vector< RegionInfo > regions;
         
-        //!< maps rank to node name (currently)
+        //!< maps rank to node name (location IDs are sparse)
         std::map< uint64_t, const char* > locationInfoMap;
         
         //!< OTF2 region reference for internal wait state region
@@ -130,6 +204,13 @@ namespace casita
 
         // maximum attribute ID that has been read by the event reader
         uint32_t maxAttributeId;
+        
+        //!< function types of all regions, four entries per region reference
+        //!< (host/device stream, with/without device null stream only)
+        std::vector< RegionClass > regionClasses;
+        
+        //!< ignore MPI regions (single process) in the classification
+        bool classifyIgnoreMPI;
     };
 
   }
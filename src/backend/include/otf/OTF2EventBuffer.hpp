@@ -0,0 +1,226 @@
+/*
+ * This file is part of the CASITA software
+ *
+ * Copyright (c) 2019,
+ * Technische Universitaet Dresden, Germany
+ *
+ * This software may be modified and distributed under the terms of
+ * a BSD-style license. See the COPYING file in the package base
+ * directory for details.
+ *
+ */
+
+#pragma once
+
+#include <otf2/otf2.h>
+#include <vector>
+#include <stdint.h>
+
+namespace casita
+{
+ namespace io
+ {
+  /**
+   * Types of event records that are kept in the event buffer. Every type
+   * corresponds to an event callback of the OTF2 trace writer, except
+   * BUFFERED_OTHER, which is only counted by the parallel event reader.
+   */
+  enum BufferedEventType
+  {
+    BUFFERED_ENTER = 0,
+    BUFFERED_LEAVE,
+    BUFFERED_THREAD_FORK,
+    BUFFERED_THREAD_JOIN,
+    BUFFERED_THREAD_TEAM_BEGIN,
+    BUFFERED_THREAD_TEAM_END,
+    BUFFERED_METRIC,
+    BUFFERED_MPI_SEND,
+    BUFFERED_MPI_RECV,
+    BUFFERED_MPI_ISEND,
+    BUFFERED_MPI_ISEND_COMPLETE,
+    BUFFERED_MPI_IRECV,
+    BUFFERED_MPI_IRECV_REQUEST,
+    BUFFERED_MPI_COLLECTIVE_BEGIN,
+    BUFFERED_MPI_COLLECTIVE_END,
+    BUFFERED_RMA_WIN_CREATE,
+    BUFFERED_RMA_WIN_DESTROY,
+    BUFFERED_RMA_PUT,
+    BUFFERED_RMA_GET,
+    BUFFERED_RMA_OP_COMPLETE_BLOCKING,
+    BUFFERED_OTHER
+  };
+
+  /**
+   * Compact representation of an OTF2 event record. The meaning of the
+   * generic fields depends on the event type (see OTF2EventBuffer::addEvent()).
+   */
+  typedef struct
+  {
+    uint64_t         time;      //!< original OTF2 time stamp (with timer offset)
+    OTF2_LocationRef location;
+    uint64_t         size;      //!< message length, bytes, sent size
+    uint64_t         id;        //!< request ID, matching ID, received size
+    uint32_t         ref;       //!< region, communicator, window or metric
+    uint32_t         partner;   //!< sender, receiver, root, remote, #threads or
+                                //!< index of the first metric attribute
+    uint32_t         tag;       //!< message tag, collective type, paradigm or
+                                //!< number of metric attributes
+    uint32_t         dataIdx;   //!< index of the first attribute or metric value
+    uint16_t         dataCount; //!< number of attributes or metric values
+    uint8_t          type;      //!< BufferedEventType
+    uint32_t         records;   //!< number of OTF2 records of the location the
+                                //!< event stands for (the event and the
+                                //!< preceding records without a callback)
+  } BufferedEvent;
+
+  typedef struct
+  {
+    OTF2_AttributeRef   ref;
+    OTF2_Type           type;
+    OTF2_AttributeValue value;
+  } BufferedAttribute;
+  
+  class OTF2TraceCache;
+
+  /**
+   * Keeps the events of the current analysis interval in memory, while they
+   * are read for the analysis. The OTF2 trace writer can replay them from this
+   * buffer instead of decoding the input trace a second time. If the events of
+   * an interval exceed the memory budget, buffering is stopped for the rest of
+   * the interval and the writer has to read the events from the trace file.
+   */
+  class OTF2EventBuffer
+  {
+    public:
+      typedef std::vector< BufferedEvent > EventList;
+
+      OTF2EventBuffer();
+
+      virtual
+      ~OTF2EventBuffer();
+
+      void
+      setMemoryLimit( uint64_t bytes );
+
+      /**
+       * Keep only the events that are needed to compute the blame and the
+       * region profile in the trace writer (no output trace is written).
+       *
+       * @param enable true, to drop events that are only written back
+       */
+      void
+      setProfileOnly( bool enable )
+      {
+        profileOnly = enable;
+      }
+
+      bool
+      isProfileOnly() const
+      {
+        return profileOnly;
+      }
+
+      /**
+       * @return true, if a memory budget has been set
+       */
+      bool
+      isEnabled() const
+      {
+        return maxBytes > 0;
+      }
+
+      /**
+       * @return true, if all events since the last clear() are available
+       */
+      bool
+      isComplete() const
+      {
+        return isEnabled() && !overflow;
+      }
+
+      void
+      addEvent( BufferedEventType type, OTF2_LocationRef location,
+                OTF2_TimeStamp time, OTF2_AttributeList* attributes,
+                uint32_t ref, uint32_t partner = 0, uint32_t tag = 0,
+                uint64_t size = 0, uint64_t id = 0 );
+
+      void
+      addMetric( OTF2_LocationRef location, OTF2_TimeStamp time,
+                 OTF2_AttributeList* attributes, OTF2_MetricRef metric,
+                 uint8_t numberOfMetrics, const OTF2_Type* typeIDs,
+                 const OTF2_MetricValue* metricValues );
+
+      const EventList&
+      getEvents() const
+      {
+        return events;
+      }
+      
+      /**
+       * Set the number of OTF2 records the last added event stands for.
+       * 
+       * @param records number of records (1, if no records have been skipped)
+       */
+      void
+      setRecords( uint32_t records )
+      {
+        events.back().records = records;
+      }
+
+      void
+      getAttributes( const BufferedEvent& event,
+                     OTF2_AttributeList* attributes ) const;
+
+      const OTF2_Type*
+      getMetricTypes( const BufferedEvent& event ) const
+      {
+        return &metricTypes[ event.dataIdx ];
+      }
+
+      const OTF2_MetricValue*
+      getMetricValues( const BufferedEvent& event ) const
+      {
+        return &metricValues[ event.dataIdx ];
+      }
+
+      uint64_t
+      getBytes() const;
+
+      void
+      clear();
+      
+      void
+      swap( OTF2EventBuffer& other );
+
+    private:
+      //!< stores and loads the events of decoded chunks
+      friend class OTF2TraceCache;
+      
+      //!< memory budget in bytes (0 disables buffering)
+      uint64_t maxBytes;
+
+      //!< true, if events have been dropped since the last clear()
+      bool overflow;
+
+      //!< buffer only events that are processed without an output trace
+      bool profileOnly;
+
+      EventList events;
+      std::vector< BufferedAttribute > attributes;
+      std::vector< OTF2_Type > metricTypes;
+      std::vector< OTF2_MetricValue > metricValues;
+
+      uint32_t
+      addAttributes( OTF2_AttributeList* attributeList, uint16_t* count );
+
+      bool
+      checkMemoryLimit();
+
+      static bool
+      isProfileEvent( BufferedEventType type );
+
+      void
+      releaseMemory();
+  };
+ }
+}
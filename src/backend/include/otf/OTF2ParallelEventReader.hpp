@@ -0,0 +1,163 @@
+/*
+ * This file is part of the CASITA software
+ *
+ * Copyright (c) 2019,
+ * Technische Universitaet Dresden, Germany
+ *
+ * This software may be modified and distributed under the terms of
+ * a BSD-style license. See the COPYING file in the package base
+ * directory for details.
+ *
+ */
+
+#pragma once
+
+#include <otf2/otf2.h>
+#include <vector>
+#include <queue>
+#include <functional>
+#include <limits>
+#include <stdint.h>
+
+#include "OTF2EventBuffer.hpp"
+#include "OTF2TraceCache.hpp"
+
+namespace casita
+{
+ namespace io
+ {
+  /**
+   * Decodes the events of several OTF2 locations in parallel (one local event
+   * reader per location) and provides them in global time order. The events
+   * of each location are decoded in chunks into a record buffer. While the
+   * events of the current chunks are merged, the next chunks of all locations
+   * are decoded by the OpenMP threads. With a trace cache, the decoded chunks
+   * are written to the cache or loaded from it instead of decoding them.
+   * 
+   * All records of the locations are counted in global time order as by the
+   * OTF2 global event reader (the trace writer reads the same number of 
+   * records per analysis interval). Therefore, events that are not merged 
+   * are decoded as well and skipped while merging.
+   */
+  class OTF2ParallelEventReader
+  {
+    public:
+      //!< maximum number of events that are decoded per location and chunk
+      static const uint64_t CHUNK_SIZE = 16384;
+      
+      //!< state of the event reader callbacks of a location (user data)
+      typedef struct
+      {
+        //!< chunk that is filled by the event reader callbacks
+        OTF2EventBuffer* chunk;
+        
+        //!< position of the last decoded record in the event stream
+        uint64_t         position;
+      } DecodeState;
+
+      OTF2ParallelEventReader( OTF2_Reader* reader, 
+                               OTF2TraceCache* cache = NULL );
+
+      virtual
+      ~OTF2ParallelEventReader();
+
+      void
+      addLocation( OTF2_LocationRef location, bool readMPI,
+                   bool readAsyncMPI, bool readWriter, bool readAll );
+
+      bool
+      nextEvent( const BufferedEvent** event, const OTF2EventBuffer** buffer,
+                 uint64_t* records = NULL, 
+                 uint64_t maxTime = std::numeric_limits< uint64_t >::max() );
+
+      void
+      close();
+
+      size_t
+      getNumLocations() const
+      {
+        return queues.size();
+      }
+
+    private:
+      typedef struct
+      {
+        OTF2_LocationRef location;
+        OTF2_EvtReader*  evtReader;
+
+        //!< current (merged) and next (decoded) chunk of events
+        OTF2EventBuffer  chunks[ 2 ];
+
+        //!< index of the current chunk
+        uint8_t          current;
+
+        //!< chunk that is filled by the event reader callbacks
+        DecodeState      decode;
+        
+        //!< number of records after the last event of each chunk
+        uint64_t         trailingRecords[ 2 ];
+        
+        //!< records that are counted with the next merged event
+        uint64_t         pendingRecords;
+        
+        //!< number of records that have been read from the event stream
+        uint64_t         recordsRead;
+
+        //!< index of the next event in the current chunk
+        size_t           next;
+
+        //!< the next chunk has been decoded
+        bool             prefetched;
+
+        //!< all events of the location have been decoded
+        bool             finished;
+
+        //!< OTF2 error code of the last decode operation
+        OTF2_ErrorCode   error;
+        
+        //!< bit mask of the event types that are merged (BufferedEventType)
+        uint32_t         typeMask;
+        
+        //!< index of the location in the reader and the trace cache
+        uint32_t         index;
+        
+        //!< index of the next chunk in the trace cache
+        uint64_t         cacheChunk;
+        
+        //!< the decoded chunk could not be written to the trace cache
+        bool             cacheError;
+      } LocationQueue;
+
+      //!< (time stamp, queue index), the earliest event is on top
+      typedef std::pair< uint64_t, uint32_t > MergeEntry;
+      typedef std::priority_queue< MergeEntry, std::vector< MergeEntry >,
+                                   std::greater< MergeEntry > > MergeHeap;
+
+      OTF2_Reader* reader;
+      
+      //!< trace cache that is written or read (NULL, if not used)
+      OTF2TraceCache* cache;
+
+      std::vector< LocationQueue* > queues;
+
+      MergeHeap mergeHeap;
+
+      //!< queue of the last returned event (UINT32_MAX, if none)
+      uint32_t lastQueue;
+
+      bool started;
+
+      void
+      start();
+
+      void
+      prefetch();
+
+      void
+      decode( LocationQueue* queue );
+
+      bool
+      switchChunk( uint32_t queueIdx );
+  };
+ }
+}
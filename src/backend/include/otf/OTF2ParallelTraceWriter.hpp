@@ -20,6 +20,7 @@
 #include <string>
 
 #include "OTF2DefinitionHandler.hpp"
+#include "OTF2EventBuffer.hpp"
 #include "AnalysisEngine.hpp"
 #include "AnalysisMetric.hpp"
 
@@ -104,7 +105,8 @@ namespace casita
       } ActivityGroupCompare;
 
       OTF2ParallelTraceWriter( AnalysisEngine*        analysis, 
-                               OTF2DefinitionHandler* defHandler );
+                               OTF2DefinitionHandler* defHandler,
+                               OTF2EventBuffer*       eventBuffer = NULL );
       
       virtual
       ~OTF2ParallelTraceWriter();
@@ -139,6 +141,12 @@ namespace casita
       uint64_t
       writeLocations( const uint64_t eventsToRead );
       
+      void
+      prepareLocations();
+      
+      uint64_t
+      writeEvents( const uint64_t eventsToRead );
+      
       void
       setupEventReader( uint64_t streamId );
       
@@ -158,12 +166,26 @@ namespace casita
       
       OTF2DefinitionHandler* defHandler;
       
+      //!< events of the current interval read by the trace reader (can be NULL)
+      OTF2EventBuffer* eventBuffer;
+      
+      //!< attribute list that is used to replay buffered events
+      OTF2_AttributeList* replayAttributes;
+      
+      //!< number of events that have been replayed from the event buffer, but
+      //!< not yet read by the global event reader of the writer
+      uint64_t eventsToSkip;
+      
       uint32_t mpiRank, mpiSize;
 
       MPI_Comm commGroup;
       
       bool writeToFile;
       
+      //!< copy the events of the input trace (false, if only the CASITA 
+      //!< metrics are written as overlay of the input trace)
+      bool copyEvents;
+      
       // maps OTF2 region references to activity groups to collect a global profile
       ActivityGroupMap activityGroupMap;
       
@@ -195,6 +217,12 @@ namespace casita
       void
       registerEventCallbacks();
       
+      void
+      replayEvents();
+      
+      void
+      skipEvents();
+      
       //!< < metric ID, metric value >
       typedef std::map< MetricType, uint64_t > CounterMap;
 
@@ -206,13 +234,13 @@ namespace casita
       void
       updateActivityGroupMap( OTF2Event event, bool evtOnCP, 
                               uint64_t waitingTime, double blame, 
-                              BlameMap* blameMap, bool graphNodesAvailable );
+                              const double* blame4, bool graphNodesAvailable );
 
       double
       computeBlame( OTF2Event event );
       
       double
-      computeBlameMap ( OTF2Event event, BlameMap* blameMap );
+      computeBlameMap ( OTF2Event event, BlameArray blame4 );
       
       void
       writeEventsWithWaitingTime( OTF2Event event, 
@@ -272,6 +300,10 @@ namespace casita
       // per location information
       typedef struct
       {
+        //!< nodes of the stream in the interval that is written (a copy, as 
+        //!< the stream might already be used for the next interval)
+        EventStream::SortedGraphNodeList nodes;
+        
         EventStream::SortedGraphNodeList::iterator currentNodeIter;
         
         EventStream* stream;
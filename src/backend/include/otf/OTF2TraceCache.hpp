@@ -0,0 +1,149 @@
+/*
+ * This file is part of the CASITA software
+ *
+ * Copyright (c) 2019,
+ * Technische Universitaet Dresden, Germany
+ *
+ * This software may be modified and distributed under the terms of
+ * a BSD-style license. See the COPYING file in the package base
+ * directory for details.
+ *
+ */
+
+#pragma once
+
+#include <otf2/otf2.h>
+#include <stdio.h>
+#include <stdint.h>
+#include <string>
+#include <vector>
+
+#include "OTF2EventBuffer.hpp"
+
+namespace casita
+{
+ namespace io
+ {
+  /**
+   * Cache of the decoded events of an analysis process. The cache is written
+   * while the OTF2 trace is read for the first time and replaces the OTF2
+   * decoding in later runs on the same trace (e.g. with other analysis
+   * options). It contains all event types of the local locations in the
+   * chunks of the parallel event reader. Every chunk is stored column-wise
+   * (time stamps, sizes, IDs, references, partners, tags, record counts,
+   * attribute counts, types) followed by the attributes and metric values of
+   * its events. The chunk header contains the number of OTF2 records of the
+   * chunk, as the trace writer counts also records that are not cached. The
+   * cache file is mapped into memory for reading.
+   */
+  class OTF2TraceCache
+  {
+    public:
+      OTF2TraceCache();
+
+      virtual
+      ~OTF2TraceCache();
+
+      static std::string
+      getFileName( const std::string& directory, const std::string& traceFile,
+                   uint32_t mpiRank, uint32_t mpiSize );
+
+      bool
+      open( const std::string& fileName, const std::string& traceFile,
+            const std::vector< OTF2_LocationRef >& locations,
+            const std::vector< uint64_t >& numEvents );
+
+      void
+      create( const std::string& fileName, const std::string& traceFile,
+              const std::vector< OTF2_LocationRef >& locations,
+              const std::vector< uint64_t >& numEvents );
+
+      bool
+      addChunk( uint32_t locationIdx, const OTF2EventBuffer& chunk,
+                uint64_t trailingRecords );
+
+      void
+      finish();
+
+      void
+      close();
+
+      /**
+       * @return true, if the events are read from the cache
+       */
+      bool
+      isReadable() const
+      {
+        return mapping != NULL;
+      }
+
+      /**
+       * @return true, if the cache is written
+       */
+      bool
+      isWritable() const
+      {
+        return file != NULL;
+      }
+
+      uint64_t
+      getNumChunks( uint32_t locationIdx ) const
+      {
+        return chunkOffsets[ locationIdx ].size();
+      }
+
+      uint64_t
+      loadChunk( uint32_t locationIdx, uint64_t chunkIdx,
+                 OTF2EventBuffer& chunk ) const;
+
+    private:
+      //!< file header, the index offset is set when the cache is complete
+      typedef struct
+      {
+        char     magic[ 8 ];
+        uint32_t version;
+        uint32_t numLocations;
+        uint64_t traceStamp;   //!< modification time of the OTF2 anchor file
+        uint64_t traceSize;    //!< size of the OTF2 anchor file
+        uint64_t indexOffset;  //!< offset of the chunk index (0 = incomplete)
+      } CacheHeader;
+
+      //!< header of a chunk (the columns follow aligned to 8 bytes)
+      typedef struct
+      {
+        uint32_t numEvents;
+        uint32_t numAttributes;
+        uint32_t numMetricValues;
+        uint32_t numRecords;     //!< number of OTF2 records of the chunk
+      } ChunkHeader;
+
+      std::string fileName;
+
+      //!< cache file that is written (NULL, if not written)
+      FILE* file;
+      uint64_t fileOffset;
+
+      //!< mapped cache file (NULL, if not read)
+      char* mapping;
+      uint64_t mappingSize;
+
+      std::vector< OTF2_LocationRef > locations;
+      
+      //!< number of events of the locations (OTF2 location definitions)
+      std::vector< uint64_t > numEvents;
+
+      //!< file offsets of the chunks of each location
+      std::vector< std::vector< uint64_t > > chunkOffsets;
+
+      static bool
+      getTraceStamp( const std::string& traceFile, uint64_t* stamp,
+                     uint64_t* size );
+
+      static uint64_t
+      getChunkBytes( const ChunkHeader& header );
+
+      bool
+      write( const void* data, uint64_t bytes );
+  };
+ }
+}
@@ -20,6 +20,9 @@
 
 #include "OTF2DefinitionHandler.hpp"
 #include "OTF2KeyValueList.hpp"
+#include "OTF2EventBuffer.hpp"
+#include "OTF2ParallelEventReader.hpp"
+#include "OTF2TraceCache.hpp"
 
 namespace casita
 {
@@ -118,6 +121,7 @@ namespace casita
       typedef std::map< uint32_t, OTF2Group > CommGroupMap;
       typedef std::map< uint32_t, uint64_t > RankStreamIdMap;
       typedef std::map< uint64_t, uint32_t > LocationStringRefMap;
+      typedef std::map< uint64_t, uint64_t > LocationEventsMap;
       typedef std::map< OTF2_SystemTreeNodeRef, OTF2_StringRef > SysNodeStringRefMap;
       typedef std::map< OTF2_LocationGroupRef, OTF2_SystemTreeNodeRef > LocationGrpSysNodeRefMap;
       typedef std::map< OTF2_StringRef, const char* > StringRefNameMap;
@@ -163,6 +167,15 @@ namespace casita
       void*
       getUserData();
       
+      void
+      setEventBuffer( OTF2EventBuffer* buffer );
+      
+      void
+      setParallelEventReading( bool enable );
+      
+      void
+      setTraceCache( const std::string& directory );
+      
       HandleEnter             handleEnter;
       HandleLeave             handleLeave;
       HandleDefProcess        handleDefProcess;
@@ -183,6 +196,18 @@ namespace casita
       HandleThreadFork        handleThreadFork;
 
     private:
+      OTF2_CallbackCode
+      enterRegion( OTF2_LocationRef    location,
+                   OTF2_TimeStamp      time,
+                   OTF2_AttributeList* attributes,
+                   OTF2_RegionRef      region );
+
+      OTF2_CallbackCode
+      leaveRegion( OTF2_LocationRef    location,
+                   OTF2_TimeStamp      time,
+                   OTF2_AttributeList* attributes,
+                   OTF2_RegionRef      region );
+      
       static OTF2_CallbackCode
       otf2CallbackEnter( OTF2_LocationRef    location,
                          OTF2_TimeStamp      time,
@@ -466,9 +491,31 @@ namespace casita
                                       OTF2_AttributeList* attributeList,
                                       OTF2_CommRef        threadTeam );
 
+      static OTF2_CallbackCode
+      otf2CallbackMetric( OTF2_LocationRef        location,
+                          OTF2_TimeStamp          time,
+                          void*                   userData,
+                          OTF2_AttributeList*     attributeList,
+                          OTF2_MetricRef          metric,
+                          uint8_t                 numberOfMetrics,
+                          const OTF2_Type*        typeIDs,
+                          const OTF2_MetricValue* metricValues );
+
       void
       setEventCallbacks( OTF2_GlobalEvtReaderCallbacks* evtReaderCallbacks );
       
+      OTF2_CallbackCode
+      replayEvent( const BufferedEvent& event, const OTF2EventBuffer& buffer );
+      
+      uint64_t
+      readGlobalDefinitions();
+      
+      void
+      broadcastDefinitions( std::vector< char >& definitions );
+      
+      uint64_t
+      replayDefinitions( const std::vector< char >& definitions );
+      
       
       void*            userData;
       
@@ -479,6 +526,34 @@ namespace casita
       uint32_t         mpiRank;
       uint32_t         mpiSize;
       
+      //<! number of processes (OTF2 location groups) in the trace
+      uint32_t         numProcesses;
+      
+      //<! do not forward non-blocking MPI events to the handlers
+      bool             ignoreAsyncMPI;
+      
+      //<! keeps the read events for the trace writer (NULL, if not used)
+      OTF2EventBuffer* eventBuffer;
+      
+      //<! decode the events of the local locations in parallel
+      bool             parallelEvents;
+      
+      //<! per-location event decoding (NULL, if the global reader is used)
+      OTF2ParallelEventReader* parallelReader;
+      
+      //<! directory of the trace cache (empty, if no cache is used)
+      std::string      traceCacheDir;
+      
+      //<! trace cache that is written or read (NULL, if not used)
+      OTF2TraceCache*  traceCache;
+      
+      //<! attribute list for events from the parallel event reader
+      OTF2_AttributeList* replayAttributes;
+      
+      //<! serialized global definitions for the other analysis processes
+      //<! (NULL, if the definitions are not recorded)
+      std::vector< char >* defRecord;
+      
       // Map of MPI ranks with its corresponding stream IDs / OTF2 location references
       RankStreamIdMap  rankStreamMap; 
       
@@ -494,6 +569,9 @@ namespace casita
       //!< maps OTF2 location references to OTF2 string references
       LocationStringRefMap locationStringRefMap;
       
+      //!< number of events of the local locations (location definitions)
+      LocationEventsMap locationEventsMap;
+      
       //!< maps OTF2 system tree nodes to OTF2 string references
       SysNodeStringRefMap sysNodeStringRefMap;
       
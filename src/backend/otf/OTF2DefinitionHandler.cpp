@@ -22,7 +22,8 @@ using namespace casita::io;
 OTF2DefinitionHandler::OTF2DefinitionHandler() :
   timerResolution( 1 ),
   timerOffset( 0 ),
-  traceLength( 0 )
+  traceLength( 0 ),
+  classifyIgnoreMPI( false )
 { 
   
 }
@@ -88,12 +89,16 @@ OTF2DefinitionHandler::storeString( uint32_t stringRef, const char* name )
   //*str = '\0';
   //strncat( str, name, length );
   
-  stringRefMap[ stringRef ] = str;
+  if( stringRef >= strings.size() )
+  {
+    strings.resize( stringRef + 1, NULL );
+  }
+  
+  strings[ stringRef ] = str;
 }
 
 /**
- * Get new OTF2 string reference based on the sorted property of the 
- * stringRefMap.
+ * Get new OTF2 string reference (the next reference after the largest one).
  * 
  * @param string string to generate a new OTF2 reference for
  * @return new OTF2 string reference
@@ -101,15 +106,14 @@ OTF2DefinitionHandler::storeString( uint32_t stringRef, const char* name )
 uint32_t
 OTF2DefinitionHandler::getNewStringRef( const char* string )
 {
-  uint32_t newStringRef = 1;
-  
-  if( !stringRefMap.empty() )
+  // the largest string reference is the last one, keep reference 0 unused
+  if( strings.empty() )
   {
-    // get the largest string reference and add '1'
-    newStringRef += stringRefMap.rbegin()->first;
+    strings.push_back( NULL );
   }
   
-  stringRefMap[ newStringRef ] = string;
+  uint32_t newStringRef = strings.size();
+  strings.push_back( string );
   
   return newStringRef;
 }
@@ -117,7 +121,7 @@ OTF2DefinitionHandler::getNewStringRef( const char* string )
 bool
 OTF2DefinitionHandler::haveStringRef( uint32_t stringRef ) const
 {
-  return ( stringRefMap.count( stringRef ) > 0 );
+  return ( stringRef < strings.size() && strings[ stringRef ] != NULL );
 }
 
 /**
@@ -129,9 +133,9 @@ OTF2DefinitionHandler::haveStringRef( uint32_t stringRef ) const
 const char*
 OTF2DefinitionHandler::getName( uint32_t stringRef )
 {
-  if( stringRefMap.count( stringRef ) > 0 )
+  if( haveStringRef( stringRef ) )
   {
-    return stringRefMap[ stringRef ];
+    return strings[ stringRef ];
   }
   else
   {
@@ -146,18 +150,22 @@ OTF2DefinitionHandler::addRegion( OTF2_RegionRef regionRef,
                                   OTF2_RegionRole regionRole,
                                   OTF2_StringRef stringRef )
 {
-  RegionInfo regInf;
+  if( regionRef >= regions.size() )
+  {
+    RegionInfo undefined = { NULL, OTF2_PARADIGM_UNKNOWN, 
+                             OTF2_REGION_ROLE_UNKNOWN };
+    regions.resize( regionRef + 1, undefined );
+  }
+  
+  RegionInfo& regInf = regions[ regionRef ];
   regInf.name = getName( stringRef );
   regInf.paradigm = paradigm;
   regInf.role = regionRole;
-  
-  regionInfoMap[ regionRef ] = regInf;
 }
 
 /**
- * Create a new region and add it to the internal map.
- * Return the new OTF2 region reference based on the sorted property of the 
- * regionRefMap.
+ * Create a new region and add it to the region table.
+ * Return the new OTF2 region reference (the next after the largest one).
  * 
  * @param string name of the region
  * @param paradigm the OTF2 paradigm
@@ -167,19 +175,21 @@ uint32_t
 OTF2DefinitionHandler::createNewRegion( const char* string, 
                                         OTF2_Paradigm paradigm )
 {
-  uint32_t newRegionRef = 1;
-  
-  if( !regionInfoMap.empty() )
+  // keep region reference 0 unused, if no region has been defined
+  if( regions.empty() )
   {
-    // get the largest region reference and add '1'
-    newRegionRef += regionInfoMap.rbegin()->first;
+    RegionInfo undefined = { NULL, OTF2_PARADIGM_UNKNOWN, 
+                             OTF2_REGION_ROLE_UNKNOWN };
+    regions.push_back( undefined );
   }
   
+  uint32_t newRegionRef = regions.size();
+  
   RegionInfo regInf;
   regInf.name = string;
   regInf.paradigm = paradigm;
   regInf.role = OTF2_REGION_ROLE_ARTIFICIAL;
-  regionInfoMap[ newRegionRef ] = regInf;
+  regions.push_back( regInf );
   
   return newRegionRef;
 }
@@ -204,26 +214,49 @@ OTF2DefinitionHandler::getForkJoinRegionId() const
 }
 
 /**
- * Returns the region information. Needed in every enter and leave event during
- * trace reading and writing
+ * Determine the function type of all regions that are known so far. The type
+ * depends only on the region, the stream type and whether the device has only
+ * the null stream. It is therefore computed once for all combinations and 
+ * looked up for every enter and leave event. Has to be called after the 
+ * definitions have been read and the paradigm options (e.g. ignore offloading)
+ * are final.
  *
- * @param regionRef     ID of region the name is requested for
- * @return              region information (name, paradigm, role)
+ * @param ignoreMPI ignore MPI regions (single process programs)
  */
-const RegionInfo&
-OTF2DefinitionHandler::getRegionInfo( const uint32_t regionRef ) const
+void
+OTF2DefinitionHandler::classifyRegions( bool ignoreMPI )
 {
-  // commented out, as count requires a find and [] access too
-  /*UTILS_ASSERT( regionInfoMap.count( regionRef ) > 0,
-                "Could not find region reference!" );
+  classifyIgnoreMPI = ignoreMPI;
   
-  return regionInfoMap[ regionRef ];*/
-  std::map< uint32_t, RegionInfo >::const_iterator it = 
-    regionInfoMap.find( regionRef );
+  // undefined region references are CPU functions without internal node
+  RegionClass undefined;
+  undefined.paradigm     = PARADIGM_CPU;
+  undefined.functionType = 0;
+  undefined.internal     = false;
   
-  UTILS_ASSERT( it != regionInfoMap.end(), "Could not find region reference!" );
-
-  return it->second;
+  regionClasses.assign( regions.size() * 4, undefined );
+  
+  for( size_t ref = 0; ref < regions.size(); ++ref )
+  {
+    if( regions[ ref ].name == NULL )
+    {
+      continue;
+    }
+    
+    for( size_t i = 0; i < 4; ++i )
+    {
+      // the descriptor is not written, if the region cannot be classified
+      FunctionDescriptor descr = FunctionDescriptor();
+      descr.paradigm   = PARADIGM_CPU;
+      descr.recordType = RECORD_ENTER; // not used for the classification
+      
+      RegionClass& regionClass = regionClasses[ ref * 4 + i ];
+      regionClass.internal = FunctionTable::getAPIFunctionType( &descr, 
+        regions[ ref ].name, regions[ ref ].paradigm, i & 2, i & 1, ignoreMPI );
+      regionClass.paradigm     = descr.paradigm;
+      regionClass.functionType = descr.functionType;
+    }
+  }
 }
 
 /**
@@ -0,0 +1,318 @@
+/*
+ * This file is part of the CASITA software
+ *
+ * Copyright (c) 2019,
+ * Technische Universitaet Dresden, Germany
+ *
+ * This software may be modified and distributed under the terms of
+ * a BSD-style license. See the COPYING file in the package base
+ * directory for details.
+ *
+ * What this file does:
+ * - keep the OTF2 events of an analysis interval in memory while reading them
+ * - provide the buffered events to the trace writer (avoids a second decode)
+ *
+ */
+
+// the following definition and include is needed for the printf PRIu64 macro
+#define __STDC_FORMAT_MACROS
+#include <inttypes.h>
+#include <algorithm>
+
+#include "otf/OTF2EventBuffer.hpp"
+#include "utils/Utils.hpp"
+
+using namespace casita;
+using namespace casita::io;
+
+OTF2EventBuffer::OTF2EventBuffer() :
+  maxBytes( 0 ),
+  overflow( false ),
+  profileOnly( false )
+{
+
+}
+
+OTF2EventBuffer::~OTF2EventBuffer()
+{
+  releaseMemory();
+}
+
+/**
+ * Set the memory budget for the events of a single analysis interval.
+ *
+ * @param bytes memory budget in bytes (0 disables the buffer)
+ */
+void
+OTF2EventBuffer::setMemoryLimit( uint64_t bytes )
+{
+  maxBytes = bytes;
+}
+
+/**
+ * Add an event record to the buffer. Depending on the event type the generic
+ * parameters have the following meaning:
+ * - ref:     region, communicator, thread team or RMA window
+ * - partner: receiver, sender, root, RMA remote or number of requested threads
+ * - tag:     message tag, collective operation or paradigm
+ * - size:    message length, RMA bytes or sent size
+ * - id:      request ID, RMA matching ID or received size
+ *
+ * @param type event record type
+ * @param location OTF2 location of the event
+ * @param time original OTF2 time stamp (timer offset is not removed)
+ * @param attributes OTF2 attribute list of the event (can be NULL)
+ */
+void
+OTF2EventBuffer::addEvent( BufferedEventType type, OTF2_LocationRef location,
+                           OTF2_TimeStamp time, OTF2_AttributeList* attributes,
+                           uint32_t ref, uint32_t partner, uint32_t tag,
+                           uint64_t size, uint64_t id )
+{
+  if( profileOnly && !isProfileEvent( type ) )
+  {
+    return;
+  }
+  
+  if( !isComplete() || !checkMemoryLimit() )
+  {
+    return;
+  }
+
+  BufferedEvent event;
+  event.time      = time;
+  event.location  = location;
+  event.size      = size;
+  event.id        = id;
+  event.ref       = ref;
+  event.partner   = partner;
+  event.tag       = tag;
+  event.type      = ( uint8_t ) type;
+  event.records   = 1;
+  
+  // attributes are only written to the output trace
+  if( profileOnly )
+  {
+    event.dataIdx   = 0;
+    event.dataCount = 0;
+  }
+  else
+  {
+    event.dataIdx = addAttributes( attributes, &event.dataCount );
+  }
+
+  events.push_back( event );
+}
+
+/**
+ * Add a metric event record to the buffer. Metric values are stored in a
+ * separate list (dataIdx, dataCount). The attributes of the metric event are
+ * referenced by the fields partner (first index) and tag (count).
+ */
+void
+OTF2EventBuffer::addMetric( OTF2_LocationRef location, OTF2_TimeStamp time,
+                            OTF2_AttributeList* attributes,
+                            OTF2_MetricRef metric, uint8_t numberOfMetrics,
+                            const OTF2_Type* typeIDs,
+                            const OTF2_MetricValue* metricValues )
+{
+  // metrics are only written to the output trace
+  if( profileOnly || !isComplete() || !checkMemoryLimit() )
+  {
+    return;
+  }
+
+  BufferedEvent event;
+  event.time      = time;
+  event.location  = location;
+  event.size      = 0;
+  event.id        = 0;
+  event.ref       = metric;
+  event.dataIdx   = this->metricValues.size();
+  event.dataCount = numberOfMetrics;
+  event.type      = ( uint8_t ) BUFFERED_METRIC;
+  event.records   = 1;
+  
+  uint16_t numAttributes = 0;
+  event.partner = addAttributes( attributes, &numAttributes );
+  event.tag     = numAttributes;
+
+  for( uint8_t i = 0; i < numberOfMetrics; ++i )
+  {
+    this->metricTypes.push_back( typeIDs[ i ] );
+    this->metricValues.push_back( metricValues[ i ] );
+  }
+
+  events.push_back( event );
+}
+
+/**
+ * Fill the given OTF2 attribute list with the stored attributes of the event.
+ *
+ * @param event buffered event
+ * @param attributeList OTF2 attribute list (existing attributes are removed)
+ */
+void
+OTF2EventBuffer::getAttributes( const BufferedEvent& event,
+                                OTF2_AttributeList* attributeList ) const
+{
+  OTF2_AttributeList_RemoveAllAttributes( attributeList );
+
+  // the data of metric events are the metric values
+  uint32_t first = event.dataIdx;
+  uint32_t count = event.dataCount;
+  if( event.type == BUFFERED_METRIC )
+  {
+    first = event.partner;
+    count = event.tag;
+  }
+
+  for( uint32_t i = first; i < first + count; ++i )
+  {
+    const BufferedAttribute& attr = attributes[ i ];
+    OTF2_AttributeList_AddAttribute( attributeList, attr.ref, attr.type,
+                                     attr.value );
+  }
+}
+
+/**
+ * @return number of bytes used by the buffered events
+ */
+uint64_t
+OTF2EventBuffer::getBytes() const
+{
+  return events.size() * sizeof( BufferedEvent ) +
+         attributes.size() * sizeof( BufferedAttribute ) +
+         metricTypes.size() * sizeof( OTF2_Type ) +
+         metricValues.size() * sizeof( OTF2_MetricValue );
+}
+
+/**
+ * Remove all buffered events. Has to be called after the events of an analysis
+ * interval have been processed by the trace writer.
+ */
+void
+OTF2EventBuffer::clear()
+{
+  // keep the allocated memory for the next interval
+  events.clear();
+  attributes.clear();
+  metricTypes.clear();
+  metricValues.clear();
+
+  overflow = false;
+}
+
+/**
+ * Exchange the buffered events with another buffer (e.g. to hand the events 
+ * of an interval over to the trace writer, while the next interval is read).
+ * 
+ * @param other the other event buffer
+ */
+void
+OTF2EventBuffer::swap( OTF2EventBuffer& other )
+{
+  std::swap( maxBytes, other.maxBytes );
+  std::swap( overflow, other.overflow );
+  std::swap( profileOnly, other.profileOnly );
+  
+  events.swap( other.events );
+  attributes.swap( other.attributes );
+  metricTypes.swap( other.metricTypes );
+  metricValues.swap( other.metricValues );
+}
+
+/**
+ * Check whether the trace writer processes the given event type, even if no
+ * output trace is written (regions, thread and device task boundaries).
+ *
+ * @param type event record type
+ *
+ * @return true, if the event is needed to compute the blame and the profile
+ */
+bool
+OTF2EventBuffer::isProfileEvent( BufferedEventType type )
+{
+  switch( type )
+  {
+    case BUFFERED_ENTER:
+    case BUFFERED_LEAVE:
+    case BUFFERED_THREAD_FORK:
+    case BUFFERED_THREAD_JOIN:
+    case BUFFERED_THREAD_TEAM_END:
+    case BUFFERED_RMA_WIN_DESTROY:
+    case BUFFERED_RMA_PUT:
+    case BUFFERED_RMA_GET:
+    case BUFFERED_RMA_OP_COMPLETE_BLOCKING:
+      return true;
+      
+    default:
+      return false;
+  }
+}
+
+uint32_t
+OTF2EventBuffer::addAttributes( OTF2_AttributeList* attributeList,
+                                uint16_t* count )
+{
+  uint32_t firstIdx = attributes.size();
+
+  *count = 0;
+
+  if( attributeList == NULL )
+  {
+    return firstIdx;
+  }
+
+  uint32_t numAttributes =
+    OTF2_AttributeList_GetNumberOfElements( attributeList );
+
+  for( uint32_t i = 0; i < numAttributes; ++i )
+  {
+    BufferedAttribute attr;
+    if( OTF2_AttributeList_GetAttributeByIndex( attributeList, i, &attr.ref,
+          &attr.type, &attr.value ) == OTF2_SUCCESS )
+    {
+      attributes.push_back( attr );
+      ( *count )++;
+    }
+  }
+
+  return firstIdx;
+}
+
+/**
+ * Check whether the buffer is within its memory budget. If the budget is
+ * exceeded, the buffered events are dropped and buffering stops until the next
+ * call of clear().
+ *
+ * @return true, if more events can be buffered
+ */
+bool
+OTF2EventBuffer::checkMemoryLimit()
+{
+  if( getBytes() < maxBytes )
+  {
+    return true;
+  }
+
+  UTILS_MSG( Parser::getVerboseLevel() >= VERBOSE_SOME,
+             "Event buffer limit (%" PRIu64 " bytes) exceeded after %lu events. "
+             "The trace writer reads this interval from file.",
+             maxBytes, events.size() );
+
+  overflow = true;
+  releaseMemory();
+
+  return false;
+}
+
+void
+OTF2EventBuffer::releaseMemory()
+{
+  // swap with empty containers to free the memory
+  EventList().swap( events );
+  std::vector< BufferedAttribute >().swap( attributes );
+  std::vector< OTF2_Type >().swap( metricTypes );
+  std::vector< OTF2_MetricValue >().swap( metricValues );
+}
@@ -0,0 +1,782 @@
+/*
+ * This file is part of the CASITA software
+ *
+ * Copyright (c) 2019,
+ * Technische Universitaet Dresden, Germany
+ *
+ * This software may be modified and distributed under the terms of
+ * a BSD-style license. See the COPYING file in the package base
+ * directory for details.
+ *
+ * What this file does:
+ * - decode the events of the local OTF2 locations in parallel (chunk-wise)
+ * - merge the decoded events of all locations in global time order
+ *
+ */
+
+// the following definition and include is needed for the printf PRIu64 macro
+#define __STDC_FORMAT_MACROS
+#include <inttypes.h>
+#include <limits>
+
+#include "otf/OTF2ParallelEventReader.hpp"
+#include "common.hpp"
+
+using namespace casita;
+using namespace casita::io;
+
+/* OTF2 local event reader callbacks, which store the events in the chunk that
+ * is currently decoded (user data points to the decode state of the location
+ * queue). The generic event fields are used as in the OTF2 trace reader
+ * callbacks. */
+
+#define CASITA_DECODE_BUFFER( userData ) \
+  ( ( ( OTF2ParallelEventReader::DecodeState* )userData )->chunk )
+
+/* The last added event also stands for the records since the previously 
+ * decoded record, which have no registered callback. */
+static inline OTF2_CallbackCode
+decoded( void* userData, uint64_t pos )
+{
+  OTF2ParallelEventReader::DecodeState* state = 
+    ( OTF2ParallelEventReader::DecodeState* )userData;
+  
+  state->chunk->setRecords( pos - state->position );
+  state->position = pos;
+  
+  return OTF2_CALLBACK_SUCCESS;
+}
+
+static OTF2_CallbackCode
+decodeEnter( OTF2_LocationRef location, OTF2_TimeStamp time, uint64_t pos,
+             void* userData, OTF2_AttributeList* attributes,
+             OTF2_RegionRef region )
+{
+  CASITA_DECODE_BUFFER( userData )->addEvent( BUFFERED_ENTER, location, time,
+                                              attributes, region );
+  return decoded( userData, pos );
+}
+
+static OTF2_CallbackCode
+decodeLeave( OTF2_LocationRef location, OTF2_TimeStamp time, uint64_t pos,
+             void* userData, OTF2_AttributeList* attributes,
+             OTF2_RegionRef region )
+{
+  CASITA_DECODE_BUFFER( userData )->addEvent( BUFFERED_LEAVE, location, time,
+                                              attributes, region );
+  return decoded( userData, pos );
+}
+
+static OTF2_CallbackCode
+decodeThreadFork( OTF2_LocationRef location, OTF2_TimeStamp time,
+                  uint64_t pos, void* userData, OTF2_AttributeList* attributes,
+                  OTF2_Paradigm paradigm, uint32_t numberOfRequestedThreads )
+{
+  CASITA_DECODE_BUFFER( userData )->addEvent( BUFFERED_THREAD_FORK, location,
+    time, attributes, 0, numberOfRequestedThreads, paradigm );
+  return decoded( userData, pos );
+}
+
+static OTF2_CallbackCode
+decodeThreadJoin( OTF2_LocationRef location, OTF2_TimeStamp time,
+                  uint64_t pos, void* userData, OTF2_AttributeList* attributes,
+                  OTF2_Paradigm paradigm )
+{
+  CASITA_DECODE_BUFFER( userData )->addEvent( BUFFERED_THREAD_JOIN, location,
+    time, attributes, 0, 0, paradigm );
+  return decoded( userData, pos );
+}
+
+static OTF2_CallbackCode
+decodeMpiSend( OTF2_LocationRef location, OTF2_TimeStamp time, uint64_t pos,
+               void* userData, OTF2_AttributeList* attributes,
+               uint32_t receiver, OTF2_CommRef communicator, uint32_t msgTag,
+               uint64_t msgLength )
+{
+  CASITA_DECODE_BUFFER( userData )->addEvent( BUFFERED_MPI_SEND, location,
+    time, attributes, communicator, receiver, msgTag, msgLength );
+  return decoded( userData, pos );
+}
+
+static OTF2_CallbackCode
+decodeMpiRecv( OTF2_LocationRef location, OTF2_TimeStamp time, uint64_t pos,
+               void* userData, OTF2_AttributeList* attributes,
+               uint32_t sender, OTF2_CommRef communicator, uint32_t msgTag,
+               uint64_t msgLength )
+{
+  CASITA_DECODE_BUFFER( userData )->addEvent( BUFFERED_MPI_RECV, location,
+    time, attributes, communicator, sender, msgTag, msgLength );
+  return decoded( userData, pos );
+}
+
+static OTF2_CallbackCode
+decodeMpiCollectiveEnd( OTF2_LocationRef location, OTF2_TimeStamp time,
+                        uint64_t pos, void* userData,
+                        OTF2_AttributeList* attributes,
+                        OTF2_CollectiveOp collectiveOp,
+                        OTF2_CommRef communicator, uint32_t root,
+                        uint64_t sizeSent, uint64_t sizeReceived )
+{
+  CASITA_DECODE_BUFFER( userData )->addEvent( BUFFERED_MPI_COLLECTIVE_END,
+    location, time, attributes, communicator, root, collectiveOp, sizeSent,
+    sizeReceived );
+  return decoded( userData, pos );
+}
+
+static OTF2_CallbackCode
+decodeMpiIsend( OTF2_LocationRef location, OTF2_TimeStamp time, uint64_t pos,
+                void* userData, OTF2_AttributeList* attributes,
+                uint32_t receiver, OTF2_CommRef communicator, uint32_t msgTag,
+                uint64_t msgLength, uint64_t requestID )
+{
+  CASITA_DECODE_BUFFER( userData )->addEvent( BUFFERED_MPI_ISEND, location,
+    time, attributes, communicator, receiver, msgTag, msgLength, requestID );
+  return decoded( userData, pos );
+}
+
+static OTF2_CallbackCode
+decodeMpiIsendComplete( OTF2_LocationRef location, OTF2_TimeStamp time,
+                        uint64_t pos, void* userData,
+                        OTF2_AttributeList* attributes, uint64_t requestID )
+{
+  CASITA_DECODE_BUFFER( userData )->addEvent( BUFFERED_MPI_ISEND_COMPLETE,
+    location, time, attributes, 0, 0, 0, 0, requestID );
+  return decoded( userData, pos );
+}
+
+static OTF2_CallbackCode
+decodeMpiIrecv( OTF2_LocationRef location, OTF2_TimeStamp time, uint64_t pos,
+                void* userData, OTF2_AttributeList* attributes,
+                uint32_t sender, OTF2_CommRef communicator, uint32_t msgTag,
+                uint64_t msgLength, uint64_t requestID )
+{
+  CASITA_DECODE_BUFFER( userData )->addEvent( BUFFERED_MPI_IRECV, location,
+    time, attributes, communicator, sender, msgTag, msgLength, requestID );
+  return decoded( userData, pos );
+}
+
+static OTF2_CallbackCode
+decodeMpiIrecvRequest( OTF2_LocationRef location, OTF2_TimeStamp time,
+                       uint64_t pos, void* userData,
+                       OTF2_AttributeList* attributes, uint64_t requestID )
+{
+  CASITA_DECODE_BUFFER( userData )->addEvent( BUFFERED_MPI_IRECV_REQUEST,
+    location, time, attributes, 0, 0, 0, 0, requestID );
+  return decoded( userData, pos );
+}
+
+static OTF2_CallbackCode
+decodeMpiCollectiveBegin( OTF2_LocationRef location, OTF2_TimeStamp time,
+                          uint64_t pos, void* userData,
+                          OTF2_AttributeList* attributes )
+{
+  CASITA_DECODE_BUFFER( userData )->addEvent( BUFFERED_MPI_COLLECTIVE_BEGIN,
+    location, time, attributes, 0 );
+  return decoded( userData, pos );
+}
+
+static OTF2_CallbackCode
+decodeThreadTeamBegin( OTF2_LocationRef location, OTF2_TimeStamp time,
+                       uint64_t pos, void* userData,
+                       OTF2_AttributeList* attributes, OTF2_CommRef threadTeam )
+{
+  CASITA_DECODE_BUFFER( userData )->addEvent( BUFFERED_THREAD_TEAM_BEGIN,
+    location, time, attributes, threadTeam );
+  return decoded( userData, pos );
+}
+
+static OTF2_CallbackCode
+decodeThreadTeamEnd( OTF2_LocationRef location, OTF2_TimeStamp time,
+                     uint64_t pos, void* userData,
+                     OTF2_AttributeList* attributes, OTF2_CommRef threadTeam )
+{
+  CASITA_DECODE_BUFFER( userData )->addEvent( BUFFERED_THREAD_TEAM_END,
+    location, time, attributes, threadTeam );
+  return decoded( userData, pos );
+}
+
+static OTF2_CallbackCode
+decodeRmaWinCreate( OTF2_LocationRef location, OTF2_TimeStamp time,
+                    uint64_t pos, void* userData,
+                    OTF2_AttributeList* attributes, OTF2_RmaWinRef win )
+{
+  CASITA_DECODE_BUFFER( userData )->addEvent( BUFFERED_RMA_WIN_CREATE,
+    location, time, attributes, win );
+  return decoded( userData, pos );
+}
+
+static OTF2_CallbackCode
+decodeRmaWinDestroy( OTF2_LocationRef location, OTF2_TimeStamp time,
+                     uint64_t pos, void* userData,
+                     OTF2_AttributeList* attributes, OTF2_RmaWinRef win )
+{
+  CASITA_DECODE_BUFFER( userData )->addEvent( BUFFERED_RMA_WIN_DESTROY,
+    location, time, attributes, win );
+  return decoded( userData, pos );
+}
+
+static OTF2_CallbackCode
+decodeRmaPut( OTF2_LocationRef location, OTF2_TimeStamp time, uint64_t pos,
+              void* userData, OTF2_AttributeList* attributes,
+              OTF2_RmaWinRef win, uint32_t remote, uint64_t bytes,
+              uint64_t matchingId )
+{
+  CASITA_DECODE_BUFFER( userData )->addEvent( BUFFERED_RMA_PUT, location,
+    time, attributes, win, remote, 0, bytes, matchingId );
+  return decoded( userData, pos );
+}
+
+static OTF2_CallbackCode
+decodeRmaGet( OTF2_LocationRef location, OTF2_TimeStamp time, uint64_t pos,
+              void* userData, OTF2_AttributeList* attributes,
+              OTF2_RmaWinRef win, uint32_t remote, uint64_t bytes,
+              uint64_t matchingId )
+{
+  CASITA_DECODE_BUFFER( userData )->addEvent( BUFFERED_RMA_GET, location,
+    time, attributes, win, remote, 0, bytes, matchingId );
+  return decoded( userData, pos );
+}
+
+static OTF2_CallbackCode
+decodeRmaOpCompleteBlocking( OTF2_LocationRef location, OTF2_TimeStamp time,
+                             uint64_t pos, void* userData,
+                             OTF2_AttributeList* attributes,
+                             OTF2_RmaWinRef win, uint64_t matchingId )
+{
+  CASITA_DECODE_BUFFER( userData )->addEvent(
+    BUFFERED_RMA_OP_COMPLETE_BLOCKING, location, time, attributes, win, 0, 0,
+    0, matchingId );
+  return decoded( userData, pos );
+}
+
+static OTF2_CallbackCode
+decodeMetric( OTF2_LocationRef location, OTF2_TimeStamp time, uint64_t pos,
+              void* userData, OTF2_AttributeList* attributes,
+              OTF2_MetricRef metric, uint8_t numberOfMetrics,
+              const OTF2_Type* typeIDs, const OTF2_MetricValue* metricValues )
+{
+  CASITA_DECODE_BUFFER( userData )->addMetric( location, time, attributes,
+    metric, numberOfMetrics, typeIDs, metricValues );
+  return decoded( userData, pos );
+}
+
+/* Records that are neither processed by the analysis nor by the trace writer,
+ * but appear frequently in Score-P traces. They are only counted. Other
+ * records without a callback are counted with the next decoded event of the 
+ * location. */
+
+static OTF2_CallbackCode
+decodeOther( OTF2_LocationRef location, OTF2_TimeStamp time, uint64_t pos,
+             void* userData )
+{
+  CASITA_DECODE_BUFFER( userData )->addEvent( BUFFERED_OTHER, location, time,
+                                              NULL, 0 );
+  return decoded( userData, pos );
+}
+
+static OTF2_CallbackCode
+decodeBufferFlush( OTF2_LocationRef location, OTF2_TimeStamp time,
+                   uint64_t pos, void* userData,
+                   OTF2_AttributeList* attributes, OTF2_TimeStamp stopTime )
+{
+  return decodeOther( location, time, pos, userData );
+}
+
+static OTF2_CallbackCode
+decodeMeasurementOnOff( OTF2_LocationRef location, OTF2_TimeStamp time,
+                        uint64_t pos, void* userData,
+                        OTF2_AttributeList* attributes,
+                        OTF2_MeasurementMode measurementMode )
+{
+  return decodeOther( location, time, pos, userData );
+}
+
+static OTF2_CallbackCode
+decodeMpiRequestTest( OTF2_LocationRef location, OTF2_TimeStamp time,
+                      uint64_t pos, void* userData,
+                      OTF2_AttributeList* attributes, uint64_t requestID )
+{
+  return decodeOther( location, time, pos, userData );
+}
+
+static OTF2_CallbackCode
+decodeMpiRequestCancelled( OTF2_LocationRef location, OTF2_TimeStamp time,
+                           uint64_t pos, void* userData,
+                           OTF2_AttributeList* attributes, uint64_t requestID )
+{
+  return decodeOther( location, time, pos, userData );
+}
+
+static OTF2_CallbackCode
+decodeParameterString( OTF2_LocationRef location, OTF2_TimeStamp time,
+                       uint64_t pos, void* userData,
+                       OTF2_AttributeList* attributes,
+                       OTF2_ParameterRef parameter, OTF2_StringRef string )
+{
+  return decodeOther( location, time, pos, userData );
+}
+
+static OTF2_CallbackCode
+decodeParameterInt( OTF2_LocationRef location, OTF2_TimeStamp time,
+                    uint64_t pos, void* userData,
+                    OTF2_AttributeList* attributes,
+                    OTF2_ParameterRef parameter, int64_t value )
+{
+  return decodeOther( location, time, pos, userData );
+}
+
+static OTF2_CallbackCode
+decodeParameterUnsignedInt( OTF2_LocationRef location, OTF2_TimeStamp time,
+                            uint64_t pos, void* userData,
+                            OTF2_AttributeList* attributes,
+                            OTF2_ParameterRef parameter, uint64_t value )
+{
+  return decodeOther( location, time, pos, userData );
+}
+
+OTF2ParallelEventReader::OTF2ParallelEventReader( OTF2_Reader* reader,
+                                                  OTF2TraceCache* cache ) :
+  reader( reader ),
+  cache( cache ),
+  lastQueue( std::numeric_limits< uint32_t >::max() ),
+  started( false )
+{
+
+}
+
+OTF2ParallelEventReader::~OTF2ParallelEventReader()
+{
+  for ( std::vector< LocationQueue* >::iterator iter = queues.begin();
+        iter != queues.end(); ++iter )
+  {
+    delete *iter;
+  }
+}
+
+/**
+ * Add a location to the reader. The local event reader of the location has to
+ * be opened before (not needed, if the events are read from the trace cache).
+ * The merged event types correspond to the registered callbacks of the global
+ * event reader of the OTF2 trace reader. All event types are decoded (and
+ * cached) to count the records in global time order.
+ *
+ * @param location OTF2 location reference
+ * @param readMPI merge blocking MPI events
+ * @param readAsyncMPI merge non-blocking MPI events
+ * @param readWriter merge events that are processed by the trace writer
+ * @param readAll merge also events that are only written to the output trace
+ */
+void
+OTF2ParallelEventReader::addLocation( OTF2_LocationRef location, bool readMPI,
+                                      bool readAsyncMPI, bool readWriter,
+                                      bool readAll )
+{
+  LocationQueue* queue = new LocationQueue;
+  queue->location   = location;
+  queue->evtReader  = NULL;
+  queue->current    = 0;
+  queue->next       = 0;
+  queue->prefetched = false;
+  queue->finished   = false;
+  queue->error      = OTF2_SUCCESS;
+  queue->index      = queues.size();
+  queue->cacheChunk = 0;
+  queue->cacheError = false;
+  
+  queue->decode.chunk           = &( queue->chunks[ 1 ] );
+  queue->decode.position        = 0;
+  queue->trailingRecords[ 0 ]   = 0;
+  queue->trailingRecords[ 1 ]   = 0;
+  queue->pendingRecords         = 0;
+  queue->recordsRead            = 0;
+
+  // the chunk size limits the memory, not the memory budget of the buffer
+  queue->chunks[ 0 ].setMemoryLimit( std::numeric_limits< uint64_t >::max() );
+  queue->chunks[ 1 ].setMemoryLimit( std::numeric_limits< uint64_t >::max() );
+  
+  // event types that are merged
+  queue->typeMask = ( 1u << BUFFERED_ENTER ) | ( 1u << BUFFERED_LEAVE ) |
+                    ( 1u << BUFFERED_THREAD_FORK ) | 
+                    ( 1u << BUFFERED_THREAD_JOIN ) |
+                    ( 1u << BUFFERED_RMA_WIN_DESTROY );
+  
+  if ( readMPI )
+  {
+    queue->typeMask |= ( 1u << BUFFERED_MPI_COLLECTIVE_END ) |
+                       ( 1u << BUFFERED_MPI_RECV ) | ( 1u << BUFFERED_MPI_SEND );
+  }
+  
+  if ( readAsyncMPI )
+  {
+    queue->typeMask |= ( 1u << BUFFERED_MPI_IRECV_REQUEST ) |
+                       ( 1u << BUFFERED_MPI_IRECV ) | 
+                       ( 1u << BUFFERED_MPI_ISEND ) |
+                       ( 1u << BUFFERED_MPI_ISEND_COMPLETE );
+  }
+  
+  if ( readWriter || readAll )
+  {
+    queue->typeMask |= ( 1u << BUFFERED_THREAD_TEAM_END ) |
+                       ( 1u << BUFFERED_RMA_GET ) | ( 1u << BUFFERED_RMA_PUT ) |
+                       ( 1u << BUFFERED_RMA_OP_COMPLETE_BLOCKING );
+  }
+  
+  if ( readAll )
+  {
+    queue->typeMask |= ( 1u << BUFFERED_METRIC ) |
+                       ( 1u << BUFFERED_MPI_COLLECTIVE_BEGIN ) |
+                       ( 1u << BUFFERED_THREAD_TEAM_BEGIN ) |
+                       ( 1u << BUFFERED_RMA_WIN_CREATE );
+  }
+  
+  // the chunks are loaded from the trace cache
+  if ( cache && cache->isReadable() )
+  {
+    queues.push_back( queue );
+    return;
+  }
+  
+  queue->evtReader = OTF2_Reader_GetEvtReader( reader, location );
+
+  if ( !queue->evtReader )
+  {
+    delete queue;
+    throw RTException( "Could not open event reader for location %" PRIu64,
+                       location );
+  }
+
+  OTF2_EvtReaderCallbacks* callbacks = OTF2_EvtReaderCallbacks_New();
+  OTF2_EvtReaderCallbacks_SetEnterCallback( callbacks, &decodeEnter );
+  OTF2_EvtReaderCallbacks_SetLeaveCallback( callbacks, &decodeLeave );
+  OTF2_EvtReaderCallbacks_SetThreadForkCallback( callbacks, &decodeThreadFork );
+  OTF2_EvtReaderCallbacks_SetThreadJoinCallback( callbacks, &decodeThreadJoin );
+  OTF2_EvtReaderCallbacks_SetRmaWinDestroyCallback( callbacks,
+                                                    &decodeRmaWinDestroy );
+  OTF2_EvtReaderCallbacks_SetMpiCollectiveEndCallback( callbacks,
+                                                      &decodeMpiCollectiveEnd );
+  OTF2_EvtReaderCallbacks_SetMpiRecvCallback( callbacks, &decodeMpiRecv );
+  OTF2_EvtReaderCallbacks_SetMpiSendCallback( callbacks, &decodeMpiSend );
+  OTF2_EvtReaderCallbacks_SetMpiIrecvRequestCallback( callbacks,
+                                                     &decodeMpiIrecvRequest );
+  OTF2_EvtReaderCallbacks_SetMpiIrecvCallback( callbacks, &decodeMpiIrecv );
+  OTF2_EvtReaderCallbacks_SetMpiIsendCallback( callbacks, &decodeMpiIsend );
+  OTF2_EvtReaderCallbacks_SetMpiIsendCompleteCallback( callbacks,
+                                                      &decodeMpiIsendComplete );
+  OTF2_EvtReaderCallbacks_SetThreadTeamEndCallback( callbacks,
+                                                    &decodeThreadTeamEnd );
+  OTF2_EvtReaderCallbacks_SetRmaGetCallback( callbacks, &decodeRmaGet );
+  OTF2_EvtReaderCallbacks_SetRmaPutCallback( callbacks, &decodeRmaPut );
+  OTF2_EvtReaderCallbacks_SetRmaOpCompleteBlockingCallback( callbacks,
+                                               &decodeRmaOpCompleteBlocking );
+  OTF2_EvtReaderCallbacks_SetMetricCallback( callbacks, &decodeMetric );
+  OTF2_EvtReaderCallbacks_SetMpiCollectiveBeginCallback( callbacks,
+                                                  &decodeMpiCollectiveBegin );
+  OTF2_EvtReaderCallbacks_SetThreadTeamBeginCallback( callbacks,
+                                                     &decodeThreadTeamBegin );
+  OTF2_EvtReaderCallbacks_SetRmaWinCreateCallback( callbacks,
+                                                   &decodeRmaWinCreate );
+  
+  // records that are only counted
+  OTF2_EvtReaderCallbacks_SetBufferFlushCallback( callbacks, 
+                                                  &decodeBufferFlush );
+  OTF2_EvtReaderCallbacks_SetMeasurementOnOffCallback( callbacks,
+                                                      &decodeMeasurementOnOff );
+  OTF2_EvtReaderCallbacks_SetMpiRequestTestCallback( callbacks,
+                                                    &decodeMpiRequestTest );
+  OTF2_EvtReaderCallbacks_SetMpiRequestCancelledCallback( callbacks,
+                                                   &decodeMpiRequestCancelled );
+  OTF2_EvtReaderCallbacks_SetParameterStringCallback( callbacks,
+                                                     &decodeParameterString );
+  OTF2_EvtReaderCallbacks_SetParameterIntCallback( callbacks,
+                                                  &decodeParameterInt );
+  OTF2_EvtReaderCallbacks_SetParameterUnsignedIntCallback( callbacks,
+                                                  &decodeParameterUnsignedInt );
+
+  // the decode chunk is set before every read operation
+  OTF2_Reader_RegisterEvtCallbacks( reader, queue->evtReader, callbacks,
+                                    &( queue->decode ) );
+  OTF2_EvtReaderCallbacks_Delete( callbacks );
+
+  queues.push_back( queue );
+}
+
+/**
+ * Get the next merged event in global time order. Events with the same time
+ * stamp are provided in the order of the added locations. The returned 
+ * pointers are valid until the next call of this function.
+ *
+ * @param event the next event
+ * @param buffer buffer that contains attributes and metric values of the event
+ * @param records number of OTF2 records that have been read with this call
+ *                (including skipped events and, after the last event, the 
+ *                remaining records of all locations)
+ * @param maxTime stop before the first event with a later time stamp
+ *
+ * @return false, if all events have been read or the next event is later 
+ *         than the given time
+ */
+bool
+OTF2ParallelEventReader::nextEvent( const BufferedEvent**   event,
+                                    const OTF2EventBuffer** buffer,
+                                    uint64_t* records, uint64_t maxTime )
+{
+  if ( !started )
+  {
+    start();
+  }
+  
+  uint64_t recordsRead = 0;
+  
+  // skip events that are only counted
+  while ( true )
+  {
+    // advance the location of the previously returned or skipped event
+    if ( lastQueue != std::numeric_limits< uint32_t >::max() )
+    {
+      LocationQueue* queue = queues[ lastQueue ];
+      const OTF2EventBuffer::EventList& events =
+        queue->chunks[ queue->current ].getEvents();
+
+      queue->next++;
+
+      if ( queue->next < events.size() )
+      {
+        mergeHeap.push( MergeEntry( events[ queue->next ].time, lastQueue ) );
+      }
+      else if ( switchChunk( lastQueue ) )
+      {
+        mergeHeap.push( MergeEntry(
+          queue->chunks[ queue->current ].getEvents().front().time, 
+          lastQueue ) );
+      }
+
+      lastQueue = std::numeric_limits< uint32_t >::max();
+    }
+
+    if ( mergeHeap.empty() )
+    {
+      // records after the last events of the locations
+      for ( std::vector< LocationQueue* >::iterator iter = queues.begin();
+            iter != queues.end(); ++iter )
+      {
+        recordsRead += ( *iter )->pendingRecords;
+        ( *iter )->pendingRecords = 0;
+      }
+      
+      break;
+    }
+    
+    if ( mergeHeap.top().first > maxTime )
+    {
+      break;
+    }
+
+    lastQueue = mergeHeap.top().second;
+    mergeHeap.pop();
+
+    LocationQueue* queue = queues[ lastQueue ];
+    const BufferedEvent& next = 
+      queue->chunks[ queue->current ].getEvents()[ queue->next ];
+    
+    recordsRead += next.records + queue->pendingRecords;
+    queue->pendingRecords = 0;
+    
+    if ( queue->typeMask & ( 1u << next.type ) )
+    {
+      *buffer = &( queue->chunks[ queue->current ] );
+      *event  = &next;
+      
+      if ( records )
+      {
+        *records = recordsRead;
+      }
+
+      return true;
+    }
+  }
+  
+  if ( records )
+  {
+    *records = recordsRead;
+  }
+  
+  return false;
+}
+
+/**
+ * Close the local event readers.
+ */
+void
+OTF2ParallelEventReader::close()
+{
+  for ( std::vector< LocationQueue* >::iterator iter = queues.begin();
+        iter != queues.end(); ++iter )
+  {
+    if ( ( *iter )->evtReader )
+    {
+      OTF2_Reader_CloseEvtReader( reader, ( *iter )->evtReader );
+      ( *iter )->evtReader = NULL;
+    }
+  }
+  
+  // all events have been read -> the trace cache is complete
+  if ( cache && cache->isWritable() )
+  {
+    cache->finish();
+  }
+}
+
+/**
+ * Decode the first chunk of all locations and initialize the merge heap.
+ */
+void
+OTF2ParallelEventReader::start()
+{
+  started = true;
+
+  prefetch();
+
+  for ( uint32_t i = 0; i < queues.size(); ++i )
+  {
+    if ( switchChunk( i ) )
+    {
+      mergeHeap.push( MergeEntry(
+        queues[ i ]->chunks[ queues[ i ]->current ].getEvents().front().time,
+        i ) );
+    }
+  }
+}
+
+/**
+ * Decode the next chunk of all locations, which have not been prefetched yet.
+ * The locations are decoded in parallel.
+ */
+void
+OTF2ParallelEventReader::prefetch()
+{
+  std::vector< LocationQueue* > decodeQueues;
+  for ( std::vector< LocationQueue* >::const_iterator iter = queues.begin();
+        iter != queues.end(); ++iter )
+  {
+    if ( !( *iter )->prefetched && !( *iter )->finished )
+    {
+      decodeQueues.push_back( *iter );
+    }
+  }
+
+  // locations have very different numbers of events
+  #pragma omp parallel for schedule(dynamic)
+  for ( int i = 0; i < ( int )decodeQueues.size(); ++i )
+  {
+    decode( decodeQueues[ i ] );
+  }
+
+  for ( std::vector< LocationQueue* >::const_iterator iter =
+          decodeQueues.begin(); iter != decodeQueues.end(); ++iter )
+  {
+    if ( ( *iter )->error != OTF2_SUCCESS )
+    {
+      throw RTException( "Failed to read OTF2 events of location %" PRIu64,
+                         ( *iter )->location );
+    }
+    
+    if ( ( *iter )->cacheError )
+    {
+      throw RTException( "Failed to write the trace cache for location %" 
+                         PRIu64, ( *iter )->location );
+    }
+  }
+}
+
+/**
+ * Decode the next chunk of events of the given location. Called by multiple
+ * threads (for different locations).
+ *
+ * @param queue location queue
+ */
+void
+OTF2ParallelEventReader::decode( LocationQueue* queue )
+{
+  queue->decode.chunk = &( queue->chunks[ 1 - queue->current ] );
+  queue->decode.chunk->clear();
+  queue->trailingRecords[ 1 - queue->current ] = 0;
+  
+  if ( cache && cache->isReadable() )
+  {
+    uint64_t numChunks = cache->getNumChunks( queue->index );
+    
+    if ( queue->cacheChunk < numChunks )
+    {
+      queue->trailingRecords[ 1 - queue->current ] = cache->loadChunk( 
+        queue->index, queue->cacheChunk++, *( queue->decode.chunk ) );
+    }
+    
+    queue->prefetched = true;
+    queue->finished   = ( queue->cacheChunk >= numChunks );
+    
+    return;
+  }
+
+  uint64_t eventsRead = 0;
+  queue->error = OTF2_Reader_ReadLocalEvents( reader, queue->evtReader,
+                                              CHUNK_SIZE, &eventsRead );
+
+  queue->prefetched = true;
+
+  if ( eventsRead < CHUNK_SIZE )
+  {
+    queue->finished = true;
+  }
+  
+  // records without a callback after the last decoded event
+  queue->recordsRead += eventsRead;
+  queue->trailingRecords[ 1 - queue->current ] = 
+    queue->recordsRead - queue->decode.position;
+  queue->decode.position = queue->recordsRead;
+  
+  if ( cache && cache->isWritable() && queue->error == OTF2_SUCCESS )
+  {
+    queue->cacheError = !cache->addChunk( queue->index, 
+      *( queue->decode.chunk ), queue->trailingRecords[ 1 - queue->current ] );
+  }
+}
+
+/**
+ * Switch to the next chunk of the given location, if the current chunk has
+ * been merged completely. Decodes the next chunks of all locations, if the
+ * next chunk of the given location is not available.
+ *
+ * @param queueIdx index of the location queue
+ *
+ * @return true, if the location has more events
+ */
+bool
+OTF2ParallelEventReader::switchChunk( uint32_t queueIdx )
+{
+  LocationQueue* queue = queues[ queueIdx ];
+
+  // skip empty chunks (e.g. only records without a callback)
+  do
+  {
+    // records at the end of the current chunk are counted with the next event
+    queue->pendingRecords += queue->trailingRecords[ queue->current ];
+    queue->trailingRecords[ queue->current ] = 0;
+    
+    if ( !queue->prefetched )
+    {
+      if ( queue->finished )
+      {
+        return false;
+      }
+
+      prefetch();
+    }
+
+    queue->current    = 1 - queue->current;
+    queue->next       = 0;
+    queue->prefetched = false;
+  } 
+  while ( queue->chunks[ queue->current ].getEvents().empty() );
+
+  return true;
+}
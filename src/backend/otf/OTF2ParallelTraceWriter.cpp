@@ -10,6 +10,7 @@
  *
  * What this file does:
  * - read original OTF2 file and immediately write it out again, 
+ * - replay the events from the event buffer of the trace reader, if available
  * - add counter values and attributes for blame, CP, etc. to the trace
  * - copy definitions from original OTF2 file with MPI rank 0
  * - compute counter values for CPU events
@@ -27,6 +28,7 @@
 #include <inttypes.h>
 
 #include <map>
+#include <algorithm>
 
 /* following adjustments necessary to use MPI_Collectives with OTF2 */
 #if MPI_VERSION < 3
@@ -85,12 +87,17 @@ postFlush( void* userData, OTF2_FileType fileType,
  *
  * @param analysis a pointer to the common analysis engine
  * @param defHandler a pointer to the definition handler
+ * @param eventBuffer events buffered by the trace reader (optional)
  */
 OTF2ParallelTraceWriter::OTF2ParallelTraceWriter( 
-  AnalysisEngine* analysis, OTF2DefinitionHandler* defHandler )
+  AnalysisEngine* analysis, OTF2DefinitionHandler* defHandler,
+  OTF2EventBuffer* eventBuffer )
   :
     analysis( analysis ),
     defHandler( defHandler ),
+    eventBuffer( eventBuffer ),
+    replayAttributes( NULL ),
+    eventsToSkip( 0 ),
     mpiRank( analysis->getMPIRank() ),
     mpiSize( analysis->getMPISize() ),
     cTable( &( analysis->getCtrTable() ) ),
@@ -123,6 +130,11 @@ OTF2ParallelTraceWriter::OTF2ParallelTraceWriter(
   firstOffloadApiEvtTime = UINT64_MAX;
   lastOffloadApiEvtTime = 0;
   
+  if( eventBuffer && eventBuffer->isEnabled() )
+  {
+    replayAttributes = OTF2_AttributeList_New();
+  }
+  
   open();
 }
 
@@ -136,6 +148,9 @@ OTF2ParallelTraceWriter::open()
 {
   writeToFile = Parser::getOptions().createTraceFile;
   
+  // write only the CASITA metrics (overlay of the input trace)
+  copyEvents = writeToFile && !Parser::getOptions().metricsOnly;
+  
   // open OTF2 archive for writing and set flush and collective callbacks
   if ( writeToFile )
   {
@@ -214,6 +229,12 @@ OTF2ParallelTraceWriter::close()
   OTF2_Reader_Close( otf2Reader );
 
   OTF2_CHECK( OTF2_Archive_Close( otf2Archive ) );
+  
+  if( replayAttributes )
+  {
+    OTF2_AttributeList_Delete( replayAttributes );
+    replayAttributes = NULL;
+  }
 }
 
 void
@@ -552,7 +573,9 @@ OTF2ParallelTraceWriter::writeAnalysisMetricDefinitions()
                                                       strRefUnit,
                                                       entry->unit ) );
         
-        if( entry->metricMode == ATTRIBUTE )
+        // attributes need the events of the input trace, otherwise they are
+        // written as counters (metrics only output)
+        if( entry->metricMode == ATTRIBUTE && copyEvents )
         {
           uint32_t newAttrId = cTable->newOtf2Id( metric );
 
@@ -564,13 +587,18 @@ OTF2ParallelTraceWriter::writeAnalysisMetricDefinitions()
         else if( entry->metricMode != METRIC_MODE_UNKNOWN )
         {
           uint32_t newMetricMemberId = cTable->getNewMetricMemberId();
-          uint32_t newMetricClassId = cTable->newOtf2Id( metric );
+          uint32_t newMetricClassId = cTable->newOtf2Id( metric, !copyEvents );
           
           // set default OTF2_MetricMode to unknown, which is invalid
           OTF2_MetricMode otf2MetricMode = METRIC_MODE_UNKNOWN;
           
           switch ( entry->metricMode )
           {
+            case ATTRIBUTE:
+              otf2MetricMode = OTF2_METRIC_ABSOLUTE_POINT;
+              break;
+              
+
             case COUNTER_ABSOLUT_NEXT:
               otf2MetricMode = OTF2_METRIC_ABSOLUTE_NEXT;
               break;
@@ -605,7 +633,7 @@ OTF2ParallelTraceWriter::writeAnalysisMetricDefinitions()
         // all processes need to know the OTF2 IDs for the metrics/attributes
         if( entry->metricMode != METRIC_MODE_UNKNOWN )
         {
-          cTable->newOtf2Id( metric );
+          cTable->newOtf2Id( metric, !copyEvents );
         }
       }
     }
@@ -637,6 +665,7 @@ OTF2ParallelTraceWriter::setupGlobalEvtReader()
       {
         UTILS_OUT( "Could not get event writer. Cannot write OTF2 file." );
         writeToFile = false;
+        copyEvents  = false;
       }
       else
       {
@@ -714,7 +743,7 @@ OTF2ParallelTraceWriter::registerEventCallbacks()
       event_callbacks, &otf2CallbackComm_RmaWinDestroy );
   
   // the following callback events are just written back to the output trace
-  if( writeToFile )
+  if( copyEvents )
   {
     OTF2_GlobalEvtReaderCallbacks_SetMetricCallback( event_callbacks, 
                                                      &otf2CallbackMetric );
@@ -748,8 +777,213 @@ OTF2ParallelTraceWriter::registerEventCallbacks()
   OTF2_GlobalEvtReaderCallbacks_Delete( event_callbacks );
 }
 
+/**
+ * Process the events of the current analysis interval from the event buffer
+ * of the trace reader. The buffered events are passed to the same callbacks
+ * that are used to process the events from the OTF2 global event reader.
+ */
+void
+OTF2ParallelTraceWriter::replayEvents()
+{
+  const OTF2EventBuffer::EventList& events = eventBuffer->getEvents();
+  
+  UTILS_MSG( mpiRank == 0 && Parser::getVerboseLevel() > VERBOSE_BASIC, 
+             "[0] Writer: Replay %lu buffered events", events.size() );
+  
+  for( OTF2EventBuffer::EventList::const_iterator it = events.begin();
+       it != events.end(); ++it )
+  {
+    const BufferedEvent& evt = *it;
+    
+    eventBuffer->getAttributes( evt, replayAttributes );
+    
+    switch( evt.type )
+    {
+      case BUFFERED_ENTER:
+        otf2CallbackEnter( evt.location, evt.time, this, replayAttributes, 
+                           evt.ref );
+        break;
+        
+      case BUFFERED_LEAVE:
+        otf2CallbackLeave( evt.location, evt.time, this, replayAttributes, 
+                           evt.ref );
+        break;
+        
+      case BUFFERED_THREAD_FORK:
+        otf2EvtCallbackThreadFork( evt.location, evt.time, this, 
+                                   replayAttributes, ( OTF2_Paradigm ) evt.tag, 
+                                   evt.partner );
+        break;
+        
+      case BUFFERED_THREAD_JOIN:
+        otf2EvtCallbackThreadJoin( evt.location, evt.time, this, 
+                                   replayAttributes, ( OTF2_Paradigm ) evt.tag );
+        break;
+        
+      case BUFFERED_THREAD_TEAM_END:
+        otf2CallbackComm_ThreadTeamEnd( evt.location, evt.time, this, 
+                                        replayAttributes, evt.ref );
+        break;
+        
+      case BUFFERED_RMA_WIN_DESTROY:
+        otf2CallbackComm_RmaWinDestroy( evt.location, evt.time, this, 
+                                        replayAttributes, evt.ref );
+        break;
+        
+      case BUFFERED_RMA_PUT:
+        otf2CallbackComm_RmaPut( evt.location, evt.time, this, 
+                                 replayAttributes, evt.ref, evt.partner, 
+                                 evt.size, evt.id );
+        break;
+        
+      case BUFFERED_RMA_GET:
+        otf2CallbackComm_RmaGet( evt.location, evt.time, this, 
+                                 replayAttributes, evt.ref, evt.partner, 
+                                 evt.size, evt.id );
+        break;
+        
+      case BUFFERED_RMA_OP_COMPLETE_BLOCKING:
+        otf2CallbackComm_RmaOpCompleteBlocking( evt.location, evt.time, this, 
+                                                replayAttributes, evt.ref, 
+                                                evt.id );
+        break;
+        
+      default:
+        // the following events are just written back to the output trace
+        if( !copyEvents )
+        {
+          break;
+        }
+        
+        switch( evt.type )
+        {
+          case BUFFERED_METRIC:
+            otf2CallbackMetric( evt.location, evt.time, this, replayAttributes,
+                                evt.ref, ( uint8_t ) evt.dataCount, 
+                                eventBuffer->getMetricTypes( evt ),
+                                eventBuffer->getMetricValues( evt ) );
+            break;
+            
+          case BUFFERED_THREAD_TEAM_BEGIN:
+            otf2CallbackComm_ThreadTeamBegin( evt.location, evt.time, this, 
+                                              replayAttributes, evt.ref );
+            break;
+            
+          case BUFFERED_RMA_WIN_CREATE:
+            otf2CallbackComm_RmaWinCreate( evt.location, evt.time, this, 
+                                           replayAttributes, evt.ref );
+            break;
+            
+          case BUFFERED_MPI_COLLECTIVE_BEGIN:
+            otf2CallbackComm_MpiCollectiveBegin( evt.location, evt.time, this, 
+                                                 replayAttributes );
+            break;
+            
+          case BUFFERED_MPI_COLLECTIVE_END:
+            otf2CallbackComm_MpiCollectiveEnd( evt.location, evt.time, this, 
+              replayAttributes, ( OTF2_CollectiveOp ) evt.tag, evt.ref, 
+              evt.partner, evt.size, evt.id );
+            break;
+            
+          case BUFFERED_MPI_SEND:
+            otf2Callback_MpiSend( evt.location, evt.time, this, 
+                                  replayAttributes, evt.partner, evt.ref, 
+                                  evt.tag, evt.size );
+            break;
+            
+          case BUFFERED_MPI_RECV:
+            otf2Callback_MpiRecv( evt.location, evt.time, this, 
+                                  replayAttributes, evt.partner, evt.ref, 
+                                  evt.tag, evt.size );
+            break;
+            
+          case BUFFERED_MPI_ISEND:
+            otf2Callback_MpiIsend( evt.location, evt.time, this, 
+                                   replayAttributes, evt.partner, evt.ref, 
+                                   evt.tag, evt.size, evt.id );
+            break;
+            
+          case BUFFERED_MPI_ISEND_COMPLETE:
+            otf2Callback_MpiIsendComplete( evt.location, evt.time, this, 
+                                           replayAttributes, evt.id );
+            break;
+            
+          case BUFFERED_MPI_IRECV:
+            otf2Callback_MpiIrecv( evt.location, evt.time, this, 
+                                   replayAttributes, evt.partner, evt.ref, 
+                                   evt.tag, evt.size, evt.id );
+            break;
+            
+          case BUFFERED_MPI_IRECV_REQUEST:
+            otf2Callback_MpiIrecvRequest( evt.location, evt.time, this, 
+                                          replayAttributes, evt.id );
+            break;
+            
+          default:
+            UTILS_WARNING( "[%" PRIu32 "] Writer: Unknown buffered event type %u",
+                           mpiRank, ( unsigned int ) evt.type );
+        }
+    }
+  }
+}
+
+/**
+ * Move the global event reader of the writer behind the events that have 
+ * already been replayed from the event buffer. This is only necessary, if the
+ * events of an interval did not fit into the event buffer.
+ */
+void
+OTF2ParallelTraceWriter::skipEvents()
+{
+  UTILS_MSG( Parser::getVerboseLevel() >= VERBOSE_SOME, 
+             "[%" PRIu32 "] Writer: Skip %" PRIu64 " already written events", 
+             mpiRank, eventsToSkip );
+  
+  // register an empty callback set to only decode the events
+  OTF2_GlobalEvtReaderCallbacks* event_callbacks = 
+    OTF2_GlobalEvtReaderCallbacks_New();
+  OTF2_Reader_RegisterGlobalEvtCallbacks( otf2Reader, otf2GlobalEventReader, 
+                                          event_callbacks, this );
+  OTF2_GlobalEvtReaderCallbacks_Delete( event_callbacks );
+  
+  uint64_t events_read = 0;
+  OTF2_CHECK( OTF2_Reader_ReadGlobalEvents( otf2Reader, otf2GlobalEventReader, 
+                                            eventsToSkip, &events_read ) );
+  
+  if( events_read != eventsToSkip )
+  {
+    throw RTException( "Writer could only skip %" PRIu64 " of %" PRIu64 " events",
+                       events_read, eventsToSkip );
+  }
+  
+  eventsToSkip = 0;
+  
+  registerEventCallbacks();
+}
+
+/**
+ * Write the events of the current analysis interval.
+ * 
+ * @param eventsToRead number of events of the interval
+ * 
+ * @return number of events that have been read
+ */
 uint64_t
 OTF2ParallelTraceWriter::writeLocations( const uint64_t eventsToRead )
+{
+  prepareLocations();
+  
+  return writeEvents( eventsToRead );
+}
+
+/**
+ * Set up the stream states for the current analysis interval. Has to be called
+ * by all processes. Afterwards, the analysis can continue with the next 
+ * interval, as long as the nodes and edges of this interval are not deleted 
+ * before writeEvents() is done.
+ */
+void
+OTF2ParallelTraceWriter::prepareLocations()
 {
   //SCOREP_USER_REGION( "writeLocations", SCOREP_USER_REGION_TYPE_FUNCTION )
   
@@ -791,8 +1025,8 @@ OTF2ParallelTraceWriter::writeLocations( const uint64_t eventsToRead )
       streamState.openEdges.clear();
     }
     
-    EventStream::SortedGraphNodeList* processNodes = &( stream->getNodes() );
-    UTILS_ASSERT( processNodes, "No nodes for stream %" PRIu64 " found!", streamId );
+    streamState.nodes = stream->getNodes();
+    EventStream::SortedGraphNodeList* processNodes = &( streamState.nodes );
 
     EventStream::SortedGraphNodeList::iterator currentNodeIter = 
       processNodes->begin();
@@ -800,6 +1034,7 @@ OTF2ParallelTraceWriter::writeLocations( const uint64_t eventsToRead )
     // continue with next stream, if this one has no nodes
     if( currentNodeIter == processNodes->end() )
     {
+      streamState.currentNodeIter = currentNodeIter;
       continue;
     }
     
@@ -925,16 +1160,58 @@ OTF2ParallelTraceWriter::writeLocations( const uint64_t eventsToRead )
   }
   
   firstCall = false;
+}
+
+/**
+ * Read the events of the current analysis interval (from the event buffer or 
+ * the input trace) and write them with the analysis metrics. Does not use MPI
+ * and can run on another thread than prepareLocations().
+ * 
+ * @param eventsToRead number of events of the interval
+ * 
+ * @return number of events that have been read
+ */
+uint64_t
+OTF2ParallelTraceWriter::writeEvents( const uint64_t eventsToRead )
+{
+  uint64_t events_read = 0;
+  
+  // use the events from the trace reader, if all events of this interval fit 
+  // into the event buffer
+  if( eventBuffer && eventBuffer->isComplete() )
+  {
+    replayEvents();
+    
+    // events without registered callbacks are not buffered, but have been 
+    // read by the trace reader
+    events_read = eventsToRead;
+    
+    // the global event reader of the writer has to skip these events
+    eventsToSkip += eventsToRead;
+    
+    eventBuffer->clear();
+    
+    return events_read;
+  }
+  
+  if( eventBuffer )
+  {
+    eventBuffer->clear();
+  }
   
   assert( otf2GlobalEventReader );
   
+  if( eventsToSkip > 0 )
+  {
+    skipEvents();
+  }
+  
 #if defined(SCOREP_USER_ENABLE)
   SCOREP_USER_REGION_DEFINE( read_events_handle )
   SCOREP_USER_REGION_BEGIN( read_events_handle, "writer::readEvents",
                             SCOREP_USER_REGION_TYPE_COMMON )
 #endif
   // returns 0 if successful, >0 otherwise
-  uint64_t events_read = 0;
   OTF2_ErrorCode otf2_error = OTF2_Reader_ReadGlobalEvents( 
     otf2Reader, otf2GlobalEventReader, eventsToRead, &events_read );
 #if defined(SCOREP_USER_ENABLE)
@@ -1055,13 +1332,14 @@ OTF2ParallelTraceWriter::updateActivityGroupMap( OTF2Event event,
  *
  * @param event         current event that was read from original OTF2 file
  * @param counters      counter values for that event
+ * @param blame4        blame per blame reason (NULL, if there is no blame)
  */
 void
 OTF2ParallelTraceWriter::updateActivityGroupMap( OTF2Event event, 
                                                  bool evtOnCP,
                                                  uint64_t waitingTime,
                                                  double blame,
-                                                 BlameMap* blameMap,
+                                                 const double* blame4,
                                                  bool graphNodesAvailable )
 {
   // add function to list if not present yet
@@ -1117,21 +1395,12 @@ OTF2ParallelTraceWriter::updateActivityGroupMap( OTF2Event event,
     activityGroupMap[ currentActivity ].totalBlame += blame;
     
     /////// add individual blame types /////////
-    // move through the different blames of this program region
-    for( BlameMap::const_iterator blameIt = blameMap->begin();
-         blameIt != blameMap->end(); blameIt++ )
+    if( blame4 )
     {
-      // look for the blame type
+      double* groupBlame4 = activityGroupMap[ currentActivity ].blame4;
       for( int i = 0; i < REASON_NUMBER; i++ )
       {
-        // found the blame type
-        if( blameIt->first == i )
-        {
-          activityGroupMap[ currentActivity ].blame4[ i ] += 
-            blameIt->second * timeConversionFactor;
-          
-          break; // move to next blame portion of this program region
-        }
+        groupBlame4[ i ] += blame4[ i ] * timeConversionFactor;
       }
     }
     
@@ -1225,12 +1494,14 @@ OTF2ParallelTraceWriter::computeBlame( OTF2Event event )
  * See also the documentation of the variable "openEdges".
  *
  * @param event current event
- * @param blameMap map to store blame for this event
+ * @param blame4 blame per blame reason for this event (is initialized here)
  * @return total blame
  */
 double
-OTF2ParallelTraceWriter::computeBlameMap( OTF2Event event, BlameMap *blameMap )
+OTF2ParallelTraceWriter::computeBlameMap( OTF2Event event, BlameArray blame4 )
 {
+  std::fill( blame4, blame4 + REASON_NUMBER, 0.0 );
+  
   double totalBlame = 0;
   
   // iterate over all open edges (if any) and calculate total blame
@@ -1256,26 +1527,18 @@ OTF2ParallelTraceWriter::computeBlameMap( OTF2Event event, BlameMap *blameMap )
            ( edge->getEndNode()->getTime() >= eventTime ) &&
            ( edge->getStartNode()->getTime() <= eventTime ) )
       {
-        // for all blame types available with this edge
-        for( BlameMap::const_iterator blameEdgeIt = edge->getBlameMap()->begin();
-           blameEdgeIt != edge->getBlameMap()->end(); blameEdgeIt++)
+        const double* edgeBlame4 = edge->getBlameArray();
+        if( edgeBlame4 )
         {
-          BlameReason reason = blameEdgeIt->first;
-          
           // blame = blame(edge) * time(active region part)/time(edge)
-          double value = blameEdgeIt->second * ( double )timeDiff / ( double )eDuration;
+          double share = ( double )timeDiff / ( double )eDuration;
           
-          totalBlame += value;
-          
-          // set or add blame into input map
-          BlameMap::iterator blameEventIt = blameMap->find( reason );
-          if ( blameEventIt != blameMap->end() )
-          {
-            blameEventIt->second += value;
-          }
-          else
+          // for all blame reasons
+          for( int i = 0; i < REASON_NUMBER; i++ )
           {
-            (*blameMap)[ reason ] = value;
+            double value = edgeBlame4[ i ] * share;
+            blame4[ i ] += value;
+            totalBlame  += value;
           }
         }
         
@@ -1314,6 +1577,24 @@ OTF2ParallelTraceWriter::writeEventsWithWaitingTime(
                 "Could not find OTF2 event writer for location" );
   
   OTF2_EvtWriter* evt_writer = evt_writerMap[ event.location ];
+  
+  // without the events of the input trace, the waiting time is written as 
+  // counter at the time of the leave event
+  if( !copyEvents )
+  {
+    if( event.type == RECORD_LEAVE && waitingTime != 0 )
+    {
+      OTF2_MetricValue value;
+      value.floating_point = waitingTime * timeConversionFactor;
+      
+      OTF2_CHECK( OTF2_EvtWriter_Metric( evt_writer, NULL, event.time,
+                                         cTable->getMetricId( WAITING_TIME ), 1, 
+                                         cTable->getMetricValueType( WAITING_TIME ), 
+                                         &value ) );
+    }
+    
+    return;
+  }
 
   // skip the critical path attribute, as it is "cheaper" to write a counter, 
   // whenever the critical path changes instead of to every region
@@ -1690,10 +1971,9 @@ OTF2ParallelTraceWriter::processNextEvent( OTF2Event event,
   FunctionDescriptor eventDesc;
   // set event type to determine if an internal node is available
   eventDesc.recordType = event.type; 
-  bool mapsInternalNode = FunctionTable::getAPIFunctionType(
-    &eventDesc, eventName, regionInfo.paradigm, currentStream->isDeviceStream(), 
-    analysis->getStreamGroup().deviceWithNullStreamOnly(), 
-    analysis->getMPISize() == 1 );
+  bool mapsInternalNode = defHandler->getFunctionType( event.regionRef, 
+    currentStream->isDeviceStream(), 
+    analysis->getStreamGroup().deviceWithNullStreamOnly(), &eventDesc );
 
   //UTILS_MSG( mpiRank == 0, "Event name: '%s' (%d), maps internal: %d", 
   //           eventName.c_str(), event.type, (int)mapsInternalNode );
@@ -1705,16 +1985,18 @@ OTF2ParallelTraceWriter::processNextEvent( OTF2Event event,
   // write blame only if we have open edges (avoid to write blame '0')
   bool   writeBlame = false;
   double blame      = 0.0;
-  BlameMap blameMap;
+  BlameArray blame4;
+  const double* eventBlame4 = NULL; // blame per reason, if computed
   if( streamState.openEdges.size() > 0 )
   {
     writeBlame = true;
     // compute blame counter
     //blame = computeBlame( event );
-    blame = computeBlameMap( event, &blameMap );
+    blame = computeBlameMap( event, blame4 );
+    eventBlame4 = blame4;
   }
   EventStream::SortedGraphNodeList::iterator endNodeIter = 
-    currentStream->getNodes().end();
+    streamState.nodes.end();
   EventStream::SortedGraphNodeList::iterator currentNodeIter = 
     streamState.currentNodeIter;
 
@@ -2025,7 +2307,8 @@ OTF2ParallelTraceWriter::processNextEvent( OTF2Event event,
   }
 
   // update values in activityGroupMap
-  updateActivityGroupMap( event, evtOnCP, waitingTime, blame, &blameMap,
+  updateActivityGroupMap( event, evtOnCP, waitingTime, blame, 
+                          eventBlame4,
                           streamState.currentNodeIter != endNodeIter );
   
   streamState.currentNodeIter = currentNodeIter;
@@ -2113,7 +2396,9 @@ OTF2ParallelTraceWriter::OTF2_GlobalDefReaderCallback_Location(
   OTF2ParallelTraceWriter* tw = (OTF2ParallelTraceWriter*)userData;
   
   // \todo: this seems to work referring to OTF2_LocationType description
-  if( tw->mpiRank == locationGroup )
+  // (locations of all MPI ranks of this analysis process)
+  if( tw->mpiRank == 
+      tw->analysis->getMPIAnalysis().getAnalysisRank( locationGroup ) )
   {
     // store all locations with their parent
     tw->locationParentMap[ self ] = locationGroup;
@@ -2506,7 +2791,7 @@ OTF2ParallelTraceWriter::otf2CallbackComm_RmaWinDestroy( OTF2_LocationRef locati
     }
   }
   
-  if ( tw->writeToFile )
+  if ( tw->copyEvents )
   {
     OTF2_CHECK( OTF2_EvtWriter_RmaWinDestroy( tw->evt_writerMap[location],
                                               attributeList, time, win ) );
@@ -2539,7 +2824,7 @@ OTF2ParallelTraceWriter::otf2CallbackComm_RmaPut( OTF2_LocationRef location,
     tw->handleDeviceTaskEnter( time, ( DeviceStream* )stream, false, false );
   }
 
-  if ( tw->writeToFile )
+  if ( tw->copyEvents )
   {
     OTF2_CHECK( OTF2_EvtWriter_RmaPut( tw->evt_writerMap[location], attributeList,
                                        time, win, remote, bytes, matchingId ) );
@@ -2559,7 +2844,7 @@ OTF2ParallelTraceWriter::otf2CallbackComm_RmaOpCompleteBlocking(
 {
   OTF2ParallelTraceWriter* tw = (OTF2ParallelTraceWriter*)userData;
 
-  if ( tw->writeToFile )
+  if ( tw->copyEvents )
   {
     OTF2_CHECK( OTF2_EvtWriter_RmaOpCompleteBlocking( tw->evt_writerMap[location],
                                                       attributeList, time,
@@ -2600,7 +2885,7 @@ OTF2ParallelTraceWriter::otf2CallbackComm_RmaGet( OTF2_LocationRef location,
     tw->handleDeviceTaskEnter( time, ( DeviceStream* )stream, false, true );
   }
   
-  if ( tw->writeToFile )
+  if ( tw->copyEvents )
   {
     OTF2_CHECK( OTF2_EvtWriter_RmaGet( tw->evt_writerMap[location], attributeList,
                                        time, win, remote, bytes, matchingId ) );
@@ -2642,7 +2927,7 @@ OTF2ParallelTraceWriter::otf2CallbackComm_ThreadTeamEnd( OTF2_LocationRef locati
 {
   OTF2ParallelTraceWriter* tw = (OTF2ParallelTraceWriter*)userData;
 
-  if ( tw->writeToFile )
+  if ( tw->copyEvents )
   {
     OTF2_CHECK( OTF2_EvtWriter_ThreadTeamEnd( tw->evt_writerMap[ locationID ],
                                               attributeList, time,
@@ -2775,7 +3060,7 @@ OTF2ParallelTraceWriter::otf2EvtCallbackThreadFork(
 
   tw->processNextEvent( event, attributeList );
 
-  if ( tw->writeToFile )
+  if ( tw->copyEvents )
   {
     OTF2_CHECK( OTF2_EvtWriter_ThreadFork( tw->evt_writerMap[locationID],
                                            attributeList, time, paradigm,
@@ -2807,7 +3092,7 @@ OTF2ParallelTraceWriter::otf2EvtCallbackThreadJoin( OTF2_LocationRef    location
 
   tw->processNextEvent( event, attributeList );
 
-  if ( tw->writeToFile )
+  if ( tw->copyEvents )
   {
     OTF2_CHECK( OTF2_EvtWriter_ThreadJoin( tw->evt_writerMap[locationID],
                                            attributeList, time, paradigm ) );
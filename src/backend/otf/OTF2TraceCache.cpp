@@ -0,0 +1,565 @@
+/*
+ * This file is part of the CASITA software
+ *
+ * Copyright (c) 2019,
+ * Technische Universitaet Dresden, Germany
+ *
+ * This software may be modified and distributed under the terms of
+ * a BSD-style license. See the COPYING file in the package base
+ * directory for details.
+ *
+ * What this file does:
+ * - write the decoded event chunks of the local locations to a cache file
+ * - map an existing cache file and provide its chunks to the event reader
+ *
+ */
+
+// the following definition and include is needed for the printf PRIu64 macro
+#define __STDC_FORMAT_MACROS
+#include <inttypes.h>
+#include <stddef.h>
+#include <stdlib.h>
+#include <string.h>
+#include <iomanip>
+#include <sstream>
+
+#include <sys/types.h>
+#include <sys/stat.h>
+#include <sys/mman.h>
+#include <fcntl.h>
+#include <unistd.h>
+
+#include "otf/OTF2TraceCache.hpp"
+#include "common.hpp"
+
+using namespace casita;
+using namespace casita::io;
+
+#define CASITA_CACHE_MAGIC "CASITAEC"
+#define CASITA_CACHE_VERSION 3
+
+//!< size of the given number of bytes aligned to 8 bytes
+#define CASITA_CACHE_ALIGN( bytes ) ( ( ( bytes ) + 7 ) & ~( ( uint64_t ) 7 ) )
+
+//!< size of the event columns of a chunk
+#define CASITA_CACHE_EVENT_BYTES( numEvents ) \
+  CASITA_CACHE_ALIGN( ( numEvents ) * ( 3 * sizeof( uint64_t ) + \
+    4 * sizeof( uint32_t ) + sizeof( uint16_t ) + sizeof( uint8_t ) ) )
+
+OTF2TraceCache::OTF2TraceCache() :
+  file( NULL ),
+  fileOffset( 0 ),
+  mapping( NULL ),
+  mappingSize( 0 )
+{
+
+}
+
+OTF2TraceCache::~OTF2TraceCache()
+{
+  close();
+}
+
+/**
+ * Get the name of the cache file of an analysis process. The cache depends on
+ * the number of analysis processes, as they read different locations. The 
+ * name contains a hash of the absolute path of the anchor file, as the anchor
+ * files of different experiments usually have the same name (traces.otf2).
+ *
+ * @param directory directory of the cache files
+ * @param traceFile OTF2 anchor file
+ * @param mpiRank rank of the analysis process
+ * @param mpiSize number of analysis processes
+ *
+ * @return path of the cache file
+ */
+std::string
+OTF2TraceCache::getFileName( const std::string& directory,
+                             const std::string& traceFile,
+                             uint32_t mpiRank, uint32_t mpiSize )
+{
+  // archive name without path and extension
+  std::string archive = traceFile;
+  size_t pos = archive.find_last_of( '/' );
+  if ( pos != std::string::npos )
+  {
+    archive = archive.substr( pos + 1 );
+  }
+
+  pos = archive.rfind( ".otf2" );
+  if ( pos != std::string::npos )
+  {
+    archive = archive.substr( 0, pos );
+  }
+
+  // FNV-1a hash of the absolute path of the anchor file
+  std::string path = traceFile;
+  char* absolutePath = realpath( traceFile.c_str(), NULL );
+  if ( absolutePath )
+  {
+    path = absolutePath;
+    free( absolutePath );
+  }
+
+  uint64_t hash = 14695981039346656037ULL;
+  for ( size_t i = 0; i < path.size(); ++i )
+  {
+    hash ^= ( unsigned char )path[ i ];
+    hash *= 1099511628211ULL;
+  }
+
+  std::stringstream name;
+  name << directory << "/" << archive << "." << std::hex << std::setw( 16 )
+       << std::setfill( '0' ) << hash << std::dec << "." << mpiRank << "of"
+       << mpiSize << ".cache";
+
+  return name.str();
+}
+
+/**
+ * Map an existing cache file. The cache is only used, if it is complete and
+ * has been written for the given trace and locations.
+ *
+ * @param fileName path of the cache file
+ * @param traceFile OTF2 anchor file
+ * @param locations local locations in the order of the event reader
+ * @param numEvents number of events of the locations
+ *
+ * @return true, if the cache can be used
+ */
+bool
+OTF2TraceCache::open( const std::string& fileName,
+                      const std::string& traceFile,
+                      const std::vector< OTF2_LocationRef >& locations,
+                      const std::vector< uint64_t >& numEvents )
+{
+  uint64_t traceStamp = 0, traceSize = 0;
+  if ( !getTraceStamp( traceFile, &traceStamp, &traceSize ) )
+  {
+    return false;
+  }
+
+  int fd = ::open( fileName.c_str(), O_RDONLY );
+  if ( fd < 0 )
+  {
+    return false;
+  }
+
+  struct stat st;
+  if ( fstat( fd, &st ) != 0 || ( uint64_t ) st.st_size < sizeof( CacheHeader ) )
+  {
+    ::close( fd );
+    return false;
+  }
+
+  void* ptr = mmap( NULL, st.st_size, PROT_READ, MAP_PRIVATE, fd, 0 );
+  ::close( fd );
+
+  if ( ptr == MAP_FAILED )
+  {
+    return false;
+  }
+
+  this->fileName = fileName;
+  mapping        = ( char* )ptr;
+  mappingSize    = st.st_size;
+
+  const CacheHeader* header = ( const CacheHeader* )mapping;
+  if ( memcmp( header->magic, CASITA_CACHE_MAGIC, 8 ) != 0 ||
+       header->version != CASITA_CACHE_VERSION ||
+       header->numLocations != locations.size() ||
+       header->traceStamp != traceStamp || header->traceSize != traceSize ||
+       header->indexOffset == 0 || header->indexOffset >= mappingSize )
+  {
+    close();
+    return false;
+  }
+
+  // read the chunk index (location, number of events, number of chunks, 
+  // chunk offsets), the event files of the trace must not have changed
+  const uint64_t* index = ( const uint64_t* )( mapping + header->indexOffset );
+  const uint64_t* end   = ( const uint64_t* )( mapping + mappingSize );
+
+  chunkOffsets.resize( locations.size() );
+  for ( size_t i = 0; i < locations.size(); ++i )
+  {
+    if ( index + 3 > end || index[ 0 ] != locations[ i ] ||
+         index[ 1 ] != numEvents[ i ] || index + 3 + index[ 2 ] > end )
+    {
+      close();
+      return false;
+    }
+
+    chunkOffsets[ i ].assign( index + 3, index + 3 + index[ 2 ] );
+    index += 3 + index[ 2 ];
+
+    // the chunks are located between the file header and the index
+    for ( size_t c = 0; c < chunkOffsets[ i ].size(); ++c )
+    {
+      uint64_t offset = chunkOffsets[ i ][ c ];
+      if ( offset < sizeof( CacheHeader ) ||
+           offset + sizeof( ChunkHeader ) > header->indexOffset )
+      {
+        throw RTException( "Chunk %lu of location %" PRIu64 " is outside of "
+                           "trace cache file %s", c, locations[ i ],
+                           fileName.c_str() );
+      }
+
+      ChunkHeader chunkHeader;
+      memcpy( &chunkHeader, mapping + offset, sizeof( chunkHeader ) );
+      if ( getChunkBytes( chunkHeader ) > header->indexOffset - offset )
+      {
+        throw RTException( "Chunk %lu of location %" PRIu64 " exceeds trace "
+                           "cache file %s", c, locations[ i ],
+                           fileName.c_str() );
+      }
+    }
+  }
+
+  this->locations = locations;
+  this->numEvents = numEvents;
+
+  return true;
+}
+
+/**
+ * Create a new cache file. The chunks are added while the trace is read.
+ *
+ * @param fileName path of the cache file
+ * @param traceFile OTF2 anchor file
+ * @param locations local locations in the order of the event reader
+ * @param numEvents number of events of the locations
+ */
+void
+OTF2TraceCache::create( const std::string& fileName,
+                        const std::string& traceFile,
+                        const std::vector< OTF2_LocationRef >& locations,
+                        const std::vector< uint64_t >& numEvents )
+{
+  CacheHeader header;
+  memset( &header, 0, sizeof( header ) );
+  memcpy( header.magic, CASITA_CACHE_MAGIC, 8 );
+  header.version      = CASITA_CACHE_VERSION;
+  header.numLocations = locations.size();
+
+  if ( !getTraceStamp( traceFile, &header.traceStamp, &header.traceSize ) )
+  {
+    throw RTException( "Could not get the status of trace file %s",
+                       traceFile.c_str() );
+  }
+
+  file = fopen( fileName.c_str(), "wb" );
+  if ( !file )
+  {
+    throw RTException( "Could not create trace cache file %s",
+                       fileName.c_str() );
+  }
+
+  this->fileName  = fileName;
+  this->locations = locations;
+  this->numEvents = numEvents;
+  chunkOffsets.assign( locations.size(), std::vector< uint64_t >() );
+
+  // the header is written again with the index offset, when the cache is
+  // complete
+  fileOffset = 0;
+  if ( !write( &header, sizeof( header ) ) )
+  {
+    throw RTException( "Could not write trace cache file %s",
+                       fileName.c_str() );
+  }
+}
+
+/**
+ * Append a decoded chunk of a location to the cache. Called by multiple
+ * threads (for different locations).
+ *
+ * @param locationIdx index of the location
+ * @param chunk decoded chunk with all event types
+ * @param trailingRecords number of OTF2 records after the last event
+ *
+ * @return false, if the chunk could not be written
+ */
+bool
+OTF2TraceCache::addChunk( uint32_t locationIdx, const OTF2EventBuffer& chunk,
+                          uint64_t trailingRecords )
+{
+  const OTF2EventBuffer::EventList& events = chunk.events;
+  uint64_t numEvents = events.size();
+
+  ChunkHeader header;
+  header.numEvents       = numEvents;
+  header.numAttributes   = chunk.attributes.size();
+  header.numMetricValues = chunk.metricValues.size();
+  header.numRecords      = trailingRecords;
+
+  // serialize the columns before the file is locked
+  uint64_t eventBytes = CASITA_CACHE_EVENT_BYTES( numEvents );
+
+  std::vector< char > data( getChunkBytes( header ), 0 );
+
+  // the header is copied with the number of records
+  char* pos = &data[ 0 ] + sizeof( header );
+
+  uint64_t* times    = ( uint64_t* )pos;
+  uint64_t* sizes    = times + numEvents;
+  uint64_t* ids      = sizes + numEvents;
+  uint32_t* refs     = ( uint32_t* )( ids + numEvents );
+  uint32_t* partners = refs + numEvents;
+  uint32_t* tags     = partners + numEvents;
+  uint32_t* records  = tags + numEvents;
+  uint16_t* counts   = ( uint16_t* )( records + numEvents );
+  uint8_t*  types    = ( uint8_t* )( counts + numEvents );
+
+  for ( uint64_t i = 0; i < numEvents; ++i )
+  {
+    const BufferedEvent& event = events[ i ];
+    times[ i ]    = event.time;
+    sizes[ i ]    = event.size;
+    ids[ i ]      = event.id;
+    refs[ i ]     = event.ref;
+    partners[ i ] = event.partner;
+    tags[ i ]     = event.tag;
+    records[ i ]  = event.records;
+    counts[ i ]   = event.dataCount;
+    types[ i ]    = event.type;
+    
+    header.numRecords += event.records;
+  }
+  
+  memcpy( &data[ 0 ], &header, sizeof( header ) );
+
+  pos += eventBytes;
+
+  if ( header.numAttributes > 0 )
+  {
+    memcpy( pos, &chunk.attributes[ 0 ],
+            header.numAttributes * sizeof( BufferedAttribute ) );
+    pos += header.numAttributes * sizeof( BufferedAttribute );
+  }
+
+  if ( header.numMetricValues > 0 )
+  {
+    memcpy( pos, &chunk.metricValues[ 0 ],
+            header.numMetricValues * sizeof( OTF2_MetricValue ) );
+    memcpy( pos + header.numMetricValues * sizeof( OTF2_MetricValue ),
+            &chunk.metricTypes[ 0 ],
+            header.numMetricValues * sizeof( OTF2_Type ) );
+  }
+
+  bool success;
+
+  #pragma omp critical (casita_trace_cache)
+  {
+    chunkOffsets[ locationIdx ].push_back( fileOffset );
+    success = write( &data[ 0 ], data.size() );
+  }
+
+  return success;
+}
+
+/**
+ * Write the chunk index and mark the cache as complete. Has to be called
+ * after all events of the local locations have been added.
+ */
+void
+OTF2TraceCache::finish()
+{
+  if ( !file )
+  {
+    return;
+  }
+
+  uint64_t indexOffset = fileOffset;
+  bool success = true;
+
+  for ( size_t i = 0; i < locations.size() && success; ++i )
+  {
+    uint64_t location  = locations[ i ];
+    uint64_t numChunks = chunkOffsets[ i ].size();
+
+    success = write( &location, sizeof( location ) ) &&
+              write( &numEvents[ i ], sizeof( uint64_t ) ) &&
+              write( &numChunks, sizeof( numChunks ) ) &&
+              ( numChunks == 0 || write( &chunkOffsets[ i ][ 0 ],
+                                         numChunks * sizeof( uint64_t ) ) );
+  }
+
+  // the cache is valid, when the index offset has been written
+  if ( !success ||
+       fseek( file, offsetof( CacheHeader, indexOffset ), SEEK_SET ) != 0 ||
+       fwrite( &indexOffset, sizeof( indexOffset ), 1, file ) != 1 )
+  {
+    throw RTException( "Could not write trace cache file %s",
+                       fileName.c_str() );
+  }
+
+  fclose( file );
+  file = NULL;
+}
+
+/**
+ * Unmap the cache file or close an incomplete cache file.
+ */
+void
+OTF2TraceCache::close()
+{
+  if ( mapping )
+  {
+    munmap( mapping, mappingSize );
+    mapping     = NULL;
+    mappingSize = 0;
+  }
+
+  // an incomplete cache file is not used by later runs
+  if ( file )
+  {
+    fclose( file );
+    file = NULL;
+  }
+}
+
+/**
+ * Load a chunk of a location from the mapped cache file.
+ *
+ * @param locationIdx index of the location
+ * @param chunkIdx index of the chunk
+ * @param chunk buffer the events are added to
+ *
+ * @return number of OTF2 records after the last event of the chunk
+ */
+uint64_t
+OTF2TraceCache::loadChunk( uint32_t locationIdx, uint64_t chunkIdx,
+                           OTF2EventBuffer& chunk ) const
+{
+  const char* pos = mapping + chunkOffsets[ locationIdx ][ chunkIdx ];
+
+  ChunkHeader header;
+  memcpy( &header, pos, sizeof( header ) );
+  pos += sizeof( header );
+
+  uint64_t numEvents  = header.numEvents;
+  uint64_t eventBytes = CASITA_CACHE_EVENT_BYTES( numEvents );
+
+  const uint64_t* times    = ( const uint64_t* )pos;
+  const uint64_t* sizes    = times + numEvents;
+  const uint64_t* ids      = sizes + numEvents;
+  const uint32_t* refs     = ( const uint32_t* )( ids + numEvents );
+  const uint32_t* partners = refs + numEvents;
+  const uint32_t* tags     = partners + numEvents;
+  const uint32_t* records  = tags + numEvents;
+  const uint16_t* counts   = ( const uint16_t* )( records + numEvents );
+  const uint8_t*  types    = ( const uint8_t* )( counts + numEvents );
+
+  pos += eventBytes;
+
+  // attributes and metric values are copied completely, the events refer to
+  // them with their original indices
+  const BufferedAttribute* attributes = ( const BufferedAttribute* )pos;
+  chunk.attributes.assign( attributes, attributes + header.numAttributes );
+  pos += header.numAttributes * sizeof( BufferedAttribute );
+
+  const OTF2_MetricValue* metricValues = ( const OTF2_MetricValue* )pos;
+  const OTF2_Type* metricTypes = ( const OTF2_Type* )( metricValues +
+                                                       header.numMetricValues );
+  chunk.metricValues.assign( metricValues,
+                             metricValues + header.numMetricValues );
+  chunk.metricTypes.assign( metricTypes, metricTypes + header.numMetricValues );
+
+  OTF2_LocationRef location = locations[ locationIdx ];
+  uint32_t attributeIdx = 0;
+  uint32_t metricIdx    = 0;
+  uint64_t numRecords   = header.numRecords;
+  
+  // all event types are loaded, as the event reader counts the records of 
+  // the events it does not merge
+  chunk.events.resize( numEvents );
+
+  for ( uint64_t i = 0; i < numEvents; ++i )
+  {
+    uint32_t* dataIdx = ( types[ i ] == BUFFERED_METRIC ) ?
+                        &metricIdx : &attributeIdx;
+
+    BufferedEvent& event = chunk.events[ i ];
+    event.time      = times[ i ];
+    event.location  = location;
+    event.size      = sizes[ i ];
+    event.id        = ids[ i ];
+    event.ref       = refs[ i ];
+    event.partner   = partners[ i ];
+    event.tag       = tags[ i ];
+    event.dataIdx   = *dataIdx;
+    event.dataCount = counts[ i ];
+    event.type      = types[ i ];
+    event.records   = records[ i ];
+    
+    numRecords -= records[ i ];
+
+    *dataIdx += counts[ i ];
+    
+    // the attributes of metric events are referenced by partner and tag
+    if ( types[ i ] == BUFFERED_METRIC )
+    {
+      attributeIdx += tags[ i ];
+    }
+  }
+  
+  if ( attributeIdx > header.numAttributes || 
+       metricIdx > header.numMetricValues )
+  {
+    throw RTException( "Events of chunk %" PRIu64 " of location %" PRIu64 
+                       " exceed their data in trace cache file %s", chunkIdx,
+                       location, fileName.c_str() );
+  }
+  
+  return numRecords;
+}
+
+/**
+ * Get the size of a chunk in the cache file.
+ *
+ * @param header header of the chunk
+ *
+ * @return size of the chunk header and its columns in bytes
+ */
+uint64_t
+OTF2TraceCache::getChunkBytes( const ChunkHeader& header )
+{
+  return sizeof( ChunkHeader ) + CASITA_CACHE_EVENT_BYTES( header.numEvents ) +
+         header.numAttributes * sizeof( BufferedAttribute ) +
+         CASITA_CACHE_ALIGN( header.numMetricValues *
+           ( sizeof( OTF2_MetricValue ) + sizeof( OTF2_Type ) ) );
+}
+
+/**
+ * Get the modification time and the size of the OTF2 anchor file, which
+ * identify the trace the cache has been written for.
+ */
+bool
+OTF2TraceCache::getTraceStamp( const std::string& traceFile, uint64_t* stamp,
+                               uint64_t* size )
+{
+  struct stat st;
+  if ( stat( traceFile.c_str(), &st ) != 0 )
+  {
+    return false;
+  }
+
+  *stamp = st.st_mtime;
+  *size  = st.st_size;
+
+  return true;
+}
+
+bool
+OTF2TraceCache::write( const void* data, uint64_t bytes )
+{
+  if ( fwrite( data, 1, bytes, file ) != bytes )
+  {
+    return false;
+  }
+
+  fileOffset += bytes;
+
+  return true;
+}
@@ -23,11 +23,17 @@
 #include <algorithm>
 #include <limits>
 
+#include <mpi.h>
+
 #include "common.hpp"
 
 #include "otf/OTF2TraceReader.hpp"
 #include "utils/Utils.hpp"
 
+#if defined(_OPENMP)
+#include <otf2/OTF2_OpenMP_Locks.h>
+#endif
+
 #if defined(SCOREP_USER_ENABLE)
 #include "scorep/SCOREP_User.h"
 #endif
@@ -40,6 +46,50 @@
 
 using namespace casita::io;
 
+namespace
+{
+  //!< record types of the serialized global definitions
+  enum DefinitionRecordType
+  {
+    DEF_CLOCK_PROPERTIES,
+    DEF_STRING,
+    DEF_ATTRIBUTE,
+    DEF_LOCATION_GROUP,
+    DEF_LOCATION,
+    DEF_LOCATION_PROPERTY,
+    DEF_GROUP,
+    DEF_COMM,
+    DEF_REGION
+  };
+  
+  template< typename T >
+  void
+  putDef( std::vector< char >* record, const T& value )
+  {
+    const char* ptr = ( const char* ) &value;
+    record->insert( record->end(), ptr, ptr + sizeof( T ) );
+  }
+  
+  void
+  putDefString( std::vector< char >* record, const char* str )
+  {
+    uint32_t length = strlen( str );
+    putDef( record, length );
+    record->insert( record->end(), str, str + length );
+  }
+  
+  template< typename T >
+  T
+  getDef( const char*& pos )
+  {
+    T value;
+    memcpy( &value, pos, sizeof( T ) );
+    pos += sizeof( T );
+    
+    return value;
+  }
+}
+
 OTF2TraceReader::OTF2TraceReader( void*                  userData,
                                   OTF2DefinitionHandler* defHandler,
                                   uint32_t               mpiRank,
@@ -61,6 +111,14 @@ OTF2TraceReader::OTF2TraceReader( void*                  userData,
   defHandler( defHandler ),
   mpiRank( mpiRank ),
   mpiSize( mpiSize ),
+  numProcesses( 0 ),
+  ignoreAsyncMPI( false ),
+  eventBuffer( NULL ),
+  parallelEvents( false ),
+  parallelReader( NULL ),
+  traceCache( NULL ),
+  replayAttributes( NULL ),
+  defRecord( NULL ),
   reader( NULL )
 {
 
@@ -74,6 +132,21 @@ OTF2TraceReader::~OTF2TraceReader()
   {
     delete[]iter->second.members;
   }
+  
+  if ( parallelReader )
+  {
+    delete parallelReader;
+  }
+  
+  if ( traceCache )
+  {
+    delete traceCache;
+  }
+  
+  if ( replayAttributes )
+  {
+    OTF2_AttributeList_Delete( replayAttributes );
+  }
 }
 
 OTF2TraceReader::NameTokenMap&
@@ -118,6 +191,58 @@ OTF2TraceReader::close()
 void
 OTF2TraceReader::setupEventReader( bool ignoreAsyncMPI )
 {
+  this->ignoreAsyncMPI = ignoreAsyncMPI;
+  
+  // if the events are buffered for the trace writer, all events that are 
+  // written by the trace writer have to be read
+  bool bufferRegions = ( eventBuffer && eventBuffer->isEnabled() );
+  
+  // without output trace, the writer needs only the region and device task 
+  // boundaries to compute the blame and the profile
+  bool bufferEvents = bufferRegions && !eventBuffer->isProfileOnly();
+  
+  // read the events from the trace cache of a previous run or write it
+  if ( !traceCacheDir.empty() )
+  {
+    // the number of events identifies the event files of the locations
+    std::vector< OTF2_LocationRef > locations;
+    std::vector< uint64_t > numEvents;
+    for ( LocationStringRefMap::const_iterator iter = locationStringRefMap.begin();
+          iter != locationStringRefMap.end(); ++iter )
+    {
+      locations.push_back( iter->first );
+      numEvents.push_back( locationEventsMap[ iter->first ] );
+    }
+    
+    std::string cacheFile = OTF2TraceCache::getFileName( traceCacheDir, 
+      baseFilename, mpiRank, mpiSize );
+    
+    traceCache = new OTF2TraceCache();
+    if ( traceCache->open( cacheFile, baseFilename, locations, numEvents ) )
+    {
+      UTILS_MSG( mpiRank == 0 && Parser::getVerboseLevel() >= VERBOSE_BASIC, 
+                 "[0] Read events from trace cache %s", cacheFile.c_str() );
+      
+      // no OTF2 event files are opened
+      parallelReader = new OTF2ParallelEventReader( reader, traceCache );
+      for ( size_t i = 0; i < locations.size(); ++i )
+      {
+        parallelReader->addLocation( locations[ i ], mpiSize > 1 || bufferEvents,
+                                     !ignoreAsyncMPI || bufferEvents, 
+                                     bufferRegions, bufferEvents );
+      }
+      
+      replayAttributes = OTF2_AttributeList_New();
+      
+      return;
+    }
+    
+    UTILS_MSG( mpiRank == 0 && Parser::getVerboseLevel() >= VERBOSE_BASIC, 
+               "[0] Write trace cache %s", cacheFile.c_str() );
+    
+    traceCache->create( cacheFile, baseFilename, locations, numEvents );
+  }
+  
   // processNameTokenMap is initialized during traceReader->readDefinitions();
   for ( LocationStringRefMap::const_iterator iter = locationStringRefMap.begin();
         iter != locationStringRefMap.end(); ++iter )
@@ -139,6 +264,30 @@ OTF2TraceReader::setupEventReader( bool ignoreAsyncMPI )
   }
 
   OTF2_Reader_CloseDefFiles( reader );
+  
+  // decode the events of several local locations in parallel and merge them
+  // instead of using the (sequential) global event reader, the trace cache is
+  // written by the parallel event reader
+  if ( ( parallelEvents && locationStringRefMap.size() > 1 ) || traceCache )
+  {
+    parallelReader = new OTF2ParallelEventReader( reader, traceCache );
+    
+    for ( LocationStringRefMap::const_iterator iter = locationStringRefMap.begin();
+          iter != locationStringRefMap.end(); ++iter )
+    {
+      parallelReader->addLocation( iter->first, mpiSize > 1 || bufferEvents,
+                                   !ignoreAsyncMPI || bufferEvents, 
+                                   bufferRegions, bufferEvents );
+    }
+    
+    replayAttributes = OTF2_AttributeList_New();
+    
+    UTILS_MSG( mpiRank == 0 && Parser::getVerboseLevel() >= VERBOSE_BASIC, 
+               "[0] Decode events of %lu locations in parallel", 
+               parallelReader->getNumLocations() );
+    
+    return;
+  }
 
   OTF2_GlobalEvtReader* global_evt_reader = OTF2_Reader_GetGlobalEvtReader( reader );
 
@@ -150,7 +299,7 @@ OTF2TraceReader::setupEventReader( bool ignoreAsyncMPI )
                                                   &otf2CallbackLeave );
   
   // if only a single process is used, MPI events can be ignored
-  if( mpiSize > 1 )
+  if( mpiSize > 1 || bufferEvents )
   {
     OTF2_GlobalEvtReaderCallbacks_SetMpiCollectiveEndCallback(
     event_callbacks,&otf2Callback_MpiCollectiveEnd );
@@ -181,7 +330,7 @@ OTF2TraceReader::setupEventReader( bool ignoreAsyncMPI )
   OTF2_GlobalEvtReaderCallbacks_SetRmaOpCompleteBlockingCallback(
     event_callbacks, &otf2CallbackComm_RmaOpCompleteBlocking );*/
   
-  if ( !ignoreAsyncMPI )
+  if ( !ignoreAsyncMPI || bufferEvents )
   {
     OTF2_GlobalEvtReaderCallbacks_SetMpiIrecvRequestCallback( event_callbacks, 
                                                 &otf2Callback_MpiIRecvRequest );
@@ -193,6 +342,33 @@ OTF2TraceReader::setupEventReader( bool ignoreAsyncMPI )
                                                &otf2Callback_MpiISendComplete );
   }
   
+  // the following events are not needed for the analysis, but are processed
+  // by the trace writer (device tasks, end of thread teams)
+  if( bufferRegions )
+  {
+    OTF2_GlobalEvtReaderCallbacks_SetThreadTeamEndCallback(
+      event_callbacks, &otf2CallbackComm_ThreadTeamEnd );
+    OTF2_GlobalEvtReaderCallbacks_SetRmaGetCallback(
+      event_callbacks, &otf2CallbackComm_RmaGet );
+    OTF2_GlobalEvtReaderCallbacks_SetRmaPutCallback(
+      event_callbacks, &otf2CallbackComm_RmaPut );
+    OTF2_GlobalEvtReaderCallbacks_SetRmaOpCompleteBlockingCallback(
+      event_callbacks, &otf2CallbackComm_RmaOpCompleteBlocking );
+  }
+  
+  // the following events are only written back to the output trace
+  if( bufferEvents )
+  {
+    OTF2_GlobalEvtReaderCallbacks_SetMetricCallback( event_callbacks, 
+                                                     &otf2CallbackMetric );
+    OTF2_GlobalEvtReaderCallbacks_SetMpiCollectiveBeginCallback(
+      event_callbacks, &otf2CallbackComm_MpiCollectiveBegin );
+    OTF2_GlobalEvtReaderCallbacks_SetThreadTeamBeginCallback(
+      event_callbacks, &otf2CallbackComm_ThreadTeamBegin );
+    OTF2_GlobalEvtReaderCallbacks_SetRmaWinCreateCallback(
+      event_callbacks, &otf2CallbackComm_RmaWinCreate );
+  }
+  
   OTF2_Reader_RegisterGlobalEvtCallbacks( reader,
                                           global_evt_reader,
                                           event_callbacks,
@@ -203,6 +379,17 @@ OTF2TraceReader::setupEventReader( bool ignoreAsyncMPI )
 /**
  * Read OTF2 events.
  * 
+ * The trace writer reads the number of records of an analysis interval with
+ * the OTF2 global event reader. The parallel event reader counts all records
+ * in the same time order, but may order records of different locations with
+ * the same time stamp differently. Therefore, the events with the time stamp 
+ * of the event that interrupts the reading are read as well. The interval 
+ * then contains all records up to this time stamp in both orders. (Records 
+ * without a decode callback are counted with the next event of their 
+ * location, see OTF2ParallelEventReader.)
+ * 
+ * @param events_read number of read records (is increased)
+ * 
  * @return true, if more events are available to read.
  */
 bool
@@ -211,6 +398,52 @@ OTF2TraceReader::readEvents( uint64_t *events_read )
 #if defined(SCOREP_USER_ENABLE)
   SCOREP_USER_REGION( "readEvents", SCOREP_USER_REGION_TYPE_FUNCTION )
 #endif
+  
+  if ( parallelReader )
+  {
+    const BufferedEvent*   event   = NULL;
+    const OTF2EventBuffer* buffer  = NULL;
+    uint64_t               records = 0;
+    
+    while ( parallelReader->nextEvent( &event, &buffer, &records ) )
+    {
+      *events_read += records;
+      
+      if ( OTF2_CALLBACK_INTERRUPT == replayEvent( *event, *buffer ) )
+      {
+        // complete the time stamp of the interrupting event
+        const uint64_t cutTime = event->time;
+        while ( parallelReader->nextEvent( &event, &buffer, &records, 
+                                           cutTime ) )
+        {
+          *events_read += records;
+          replayEvent( *event, *buffer );
+        }
+        *events_read += records;
+        
+        UTILS_MSG( mpiRank == 0 && Parser::getVerboseLevel() >= VERBOSE_SOME, 
+                   "[0] Reader interrupted by callback. Read %" PRIu64 " events", 
+                   *events_read );
+        
+        return true;
+      }
+    }
+    
+    // records after the last events
+    *events_read += records;
+    
+    UTILS_MSG( mpiRank == 0 && Parser::getVerboseLevel() >= VERBOSE_BASIC, 
+               "[0] ... %" PRIu64 " events read", *events_read );
+    
+    parallelReader->close();
+    
+    if ( !traceCache || !traceCache->isReadable() )
+    {
+      OTF2_Reader_CloseEvtFiles( reader );
+    }
+    
+    return false;
+  }
     
   OTF2_GlobalEvtReader* global_evt_reader =
     OTF2_Reader_GetGlobalEvtReader( reader );
@@ -324,12 +557,99 @@ OTF2TraceReader::readEventsForProcess( uint64_t id, bool ignoreAsyncMPI )
 }
 
 /**
- * Read all global definitions.
+ * Read all global definitions. With several analysis processes, only the root
+ * rank reads the global definition file. It records the definitions that are
+ * evaluated by CASITA and broadcasts them in a single message. The other ranks
+ * replay the received definitions with the same callbacks.
  * 
  * @return true, if successful
  */
 bool
 OTF2TraceReader::readDefinitions()
+{
+  uint64_t definitions_read = 0;
+  std::vector< char > definitions;
+  
+  if( mpiRank == 0 )
+  {
+    if( mpiSize > 1 )
+    {
+      defRecord = &definitions;
+    }
+    
+    definitions_read = readGlobalDefinitions();
+    
+    defRecord = NULL;
+  }
+  
+  if( mpiSize > 1 )
+  {
+    broadcastDefinitions( definitions );
+    
+    UTILS_MSG( mpiRank == 0 && Parser::getVerboseLevel() >= VERBOSE_BASIC, 
+               "  ... broadcast %lu bytes of OTF2 definitions", 
+               ( unsigned long ) definitions.size() );
+    
+    if( mpiRank > 0 )
+    {
+      definitions_read = replayDefinitions( definitions );
+    }
+  }
+
+  UTILS_MSG( mpiRank == 0 && Parser::getVerboseLevel() >= VERBOSE_BASIC, 
+             "  ... %" PRIu64 " OTF2 definitions read", definitions_read );
+
+  close();  
+  
+  if ( ( rankStreamMap.size() == 0 && mpiSize > 1 ) || 
+       ( rankStreamMap.size() && (mpiSize != rankStreamMap.size() ) ) )
+  {
+    // one analysis process can handle several MPI ranks of the trace (M:N)
+    if( mpiSize > 1 && mpiSize < rankStreamMap.size() && 
+        numProcesses == rankStreamMap.size() )
+    {
+      UTILS_MSG( mpiRank == 0, 
+                 "Analyze %zu MPI ranks with %u processes (up to %u ranks per "
+                 "process)", rankStreamMap.size(), mpiSize,
+                 ( uint32_t ) ( ( rankStreamMap.size() + mpiSize - 1 ) / mpiSize ) );
+    }
+    else
+    {
+      UTILS_OUT( "[%u] CASITA has to be run with %s%zu MPI process(es)!",
+                 mpiRank, rankStreamMap.size() > 1 ? "2 to " : "",
+                 rankStreamMap.size() == 0 ? 1 : rankStreamMap.size() );
+
+      return false;
+    }
+  }
+
+  open( baseFilename.c_str(), 10 );
+  
+  // add forkJoin "region" internally to support OMP-fork/join model  
+  // and create wait state region
+  defHandler->setInternalRegions();
+
+  /* check OTF2 location reference, MPI rank map 
+  if( mpiRank == 0 && mpiSize > 1 )
+  {
+    TokenTokenMap64::iterator iter = processFamilyMap.begin();
+    for( ; iter != processFamilyMap.end(); ++iter )
+    {
+      UTILS_OUT( "[0] stream %" PRIu64 " -> rank %" PRIu64 "", 
+                 iter->first, iter->second );
+    }
+  }*/
+  
+  return true;
+}
+
+/**
+ * Read the global definition file with the definition callbacks.
+ * 
+ * @return number of read definitions
+ */
+uint64_t
+OTF2TraceReader::readGlobalDefinitions()
 {
   OTF2_GlobalDefReader* global_def_reader = 
     OTF2_Reader_GetGlobalDefReader( reader );
@@ -354,12 +674,13 @@ OTF2TraceReader::readDefinitions()
   OTF2_GlobalDefReaderCallbacks_SetLocationPropertyCallback(
     global_def_callbacks, &OTF2_GlobalDefReaderCallback_LocationProperty );
   
+  // all ranks count the processes to assign locations to analysis processes
+  OTF2_GlobalDefReaderCallbacks_SetLocationGroupCallback( 
+    global_def_callbacks, &OTF2_GlobalDefReaderCallback_LocationGroup );
+  
   // only root rank evaluates these information
   if( mpiRank == 0 )
   {
-    OTF2_GlobalDefReaderCallbacks_SetLocationGroupCallback( 
-    global_def_callbacks, &OTF2_GlobalDefReaderCallback_LocationGroup );
-  
     OTF2_GlobalDefReaderCallbacks_SetSystemTreeNodeCallback(
       global_def_callbacks, &OTF2_GlobalDefReaderCallback_SystemTreeNode );
   }
@@ -391,39 +712,176 @@ OTF2TraceReader::readDefinitions()
   OTF2_Reader_ReadAllGlobalDefinitions( reader,
                                         global_def_reader,
                                         &definitions_read );
+  
+  return definitions_read;
+}
 
-  UTILS_MSG( mpiRank == 0 && Parser::getVerboseLevel() >= VERBOSE_BASIC, 
-             "  ... %" PRIu64 " OTF2 definitions read", definitions_read );
-
-  close();  
+/**
+ * Broadcast the recorded global definitions from the root rank to all other
+ * analysis processes.
+ * 
+ * @param definitions serialized definitions (input on root, output otherwise)
+ */
+void
+OTF2TraceReader::broadcastDefinitions( std::vector< char >& definitions )
+{
+  uint64_t size = definitions.size();
+  MPI_CHECK( MPI_Bcast( &size, 1, MPI_UINT64_T, 0, MPI_COMM_WORLD ) );
   
-  if ( ( rankStreamMap.size() == 0 && mpiSize > 1 ) || 
-       ( rankStreamMap.size() && (mpiSize != rankStreamMap.size() ) ) )
+  definitions.resize( size );
+  
+  // the MPI count is an integer -> broadcast large records in chunks
+  const uint64_t chunkSize = 1 << 30;
+  for( uint64_t offset = 0; offset < size; offset += chunkSize )
   {
-    UTILS_OUT( "[%u] CASITA has to be run with %zu MPI process(es)!",
-               mpiRank, rankStreamMap.size() == 0 ? 1 : rankStreamMap.size() );
-    
-    return false;
+    int count = ( int ) std::min( chunkSize, size - offset );
+    MPI_CHECK( MPI_Bcast( &definitions[ offset ], count, MPI_CHAR, 0, 
+                          MPI_COMM_WORLD ) );
   }
+}
 
-  open( baseFilename.c_str(), 10 );
+/**
+ * Pass the serialized global definitions to the definition callbacks.
+ * 
+ * @param definitions serialized definitions from the root rank
+ * 
+ * @return number of replayed definitions
+ */
+uint64_t
+OTF2TraceReader::replayDefinitions( const std::vector< char >& definitions )
+{
+  if( definitions.empty() )
+  {
+    return 0;
+  }
   
-  // add forkJoin "region" internally to support OMP-fork/join model  
-  // and create wait state region
-  defHandler->setInternalRegions();
-
-  /* check OTF2 location reference, MPI rank map 
-  if( mpiRank == 0 && mpiSize > 1 )
+  const char* pos = &definitions[ 0 ];
+  const char* end = pos + definitions.size();
+  uint64_t count = 0;
+  
+  while( pos < end )
   {
-    TokenTokenMap64::iterator iter = processFamilyMap.begin();
-    for( ; iter != processFamilyMap.end(); ++iter )
+    uint8_t type = getDef< uint8_t >( pos );
+    
+    switch( type )
     {
-      UTILS_OUT( "[0] stream %" PRIu64 " -> rank %" PRIu64 "", 
-                 iter->first, iter->second );
+      case DEF_CLOCK_PROPERTIES:
+      {
+        uint64_t timerResolution = getDef< uint64_t >( pos );
+        uint64_t globalOffset    = getDef< uint64_t >( pos );
+        uint64_t traceLength     = getDef< uint64_t >( pos );
+        
+        OTF2_GlobalDefReaderCallback_ClockProperties( this, timerResolution, 
+                                                      globalOffset, traceLength );
+        break;
+      }
+      case DEF_STRING:
+      {
+        OTF2_StringRef self = getDef< OTF2_StringRef >( pos );
+        uint32_t length     = getDef< uint32_t >( pos );
+        std::string name( pos, length );
+        pos += length;
+        
+        OTF2_GlobalDefReaderCallback_String( this, self, name.c_str() );
+        break;
+      }
+      case DEF_ATTRIBUTE:
+      {
+        OTF2_AttributeRef self = getDef< OTF2_AttributeRef >( pos );
+        OTF2_StringRef name    = getDef< OTF2_StringRef >( pos );
+        OTF2_Type attrType     = getDef< OTF2_Type >( pos );
+        
+        OTF2_GlobalDefReaderCallback_Attribute( this, self, name, 
+                                                OTF2_UNDEFINED_STRING, 
+                                                attrType );
+        break;
+      }
+      case DEF_LOCATION_GROUP:
+      {
+        OTF2_LocationGroupRef self         = getDef< OTF2_LocationGroupRef >( pos );
+        OTF2_StringRef name                = getDef< OTF2_StringRef >( pos );
+        OTF2_LocationGroupType groupType   = getDef< OTF2_LocationGroupType >( pos );
+        OTF2_SystemTreeNodeRef parent      = getDef< OTF2_SystemTreeNodeRef >( pos );
+        
+        OTF2_GlobalDefReaderCallback_LocationGroup( this, self, name, 
+                                                    groupType, parent );
+        break;
+      }
+      case DEF_LOCATION:
+      {
+        OTF2_LocationRef self              = getDef< OTF2_LocationRef >( pos );
+        OTF2_StringRef name                = getDef< OTF2_StringRef >( pos );
+        OTF2_LocationType locationType     = getDef< OTF2_LocationType >( pos );
+        uint64_t numberOfEvents            = getDef< uint64_t >( pos );
+        OTF2_LocationGroupRef locationGroup = getDef< OTF2_LocationGroupRef >( pos );
+        
+        OTF2_GlobalDefReaderCallback_Location( this, self, name, locationType, 
+                                               numberOfEvents, locationGroup );
+        break;
+      }
+      case DEF_LOCATION_PROPERTY:
+      {
+        OTF2_LocationRef location = getDef< OTF2_LocationRef >( pos );
+        OTF2_StringRef name       = getDef< OTF2_StringRef >( pos );
+        OTF2_Type valueType       = getDef< OTF2_Type >( pos );
+        OTF2_AttributeValue value = getDef< OTF2_AttributeValue >( pos );
+        
+        OTF2_GlobalDefReaderCallback_LocationProperty( this, location, name, 
+                                                       valueType, value );
+        break;
+      }
+      case DEF_GROUP:
+      {
+        OTF2_GroupRef self        = getDef< OTF2_GroupRef >( pos );
+        OTF2_StringRef name       = getDef< OTF2_StringRef >( pos );
+        OTF2_GroupType groupType  = getDef< OTF2_GroupType >( pos );
+        OTF2_Paradigm paradigm    = getDef< OTF2_Paradigm >( pos );
+        OTF2_GroupFlag groupFlags = getDef< OTF2_GroupFlag >( pos );
+        uint32_t numberOfMembers  = getDef< uint32_t >( pos );
+        
+        // copy the members, as the record is not aligned
+        std::vector< uint64_t > members( numberOfMembers );
+        if( numberOfMembers > 0 )
+        {
+          memcpy( &members[ 0 ], pos, numberOfMembers * sizeof( uint64_t ) );
+          pos += numberOfMembers * sizeof( uint64_t );
+        }
+        
+        OTF2_GlobalDefReaderCallback_Group( this, self, name, groupType, 
+          paradigm, groupFlags, numberOfMembers, 
+          numberOfMembers > 0 ? &members[ 0 ] : NULL );
+        break;
+      }
+      case DEF_COMM:
+      {
+        OTF2_CommRef self   = getDef< OTF2_CommRef >( pos );
+        OTF2_StringRef name = getDef< OTF2_StringRef >( pos );
+        OTF2_GroupRef group = getDef< OTF2_GroupRef >( pos );
+        OTF2_CommRef parent = getDef< OTF2_CommRef >( pos );
+        
+        OTF2_GlobalDefReaderCallback_Comm( this, self, name, group, parent );
+        break;
+      }
+      case DEF_REGION:
+      {
+        OTF2_RegionRef self        = getDef< OTF2_RegionRef >( pos );
+        OTF2_StringRef name        = getDef< OTF2_StringRef >( pos );
+        OTF2_RegionRole regionRole = getDef< OTF2_RegionRole >( pos );
+        OTF2_Paradigm paradigm     = getDef< OTF2_Paradigm >( pos );
+        
+        OTF2_GlobalDefReaderCallback_Region( this, self, name, 
+          OTF2_UNDEFINED_STRING, OTF2_UNDEFINED_STRING, regionRole, paradigm, 
+          OTF2_REGION_FLAG_NONE, OTF2_UNDEFINED_STRING, 0, 0 );
+        break;
+      }
+      default:
+        throw RTException( "Unknown OTF2 definition record %u", ( uint32_t ) type );
     }
-  }*/
+    
+    count++;
+  }
   
-  return true;
+  return count;
 }
 
 OTF2_CallbackCode
@@ -434,6 +892,14 @@ OTF2TraceReader::OTF2_GlobalDefReaderCallback_ClockProperties(
                                                        uint64_t traceLength )
 {
   OTF2TraceReader* tr = (OTF2TraceReader*)userData;
+  
+  if( tr->defRecord )
+  {
+    putDef( tr->defRecord, ( uint8_t ) DEF_CLOCK_PROPERTIES );
+    putDef( tr->defRecord, timerResolution );
+    putDef( tr->defRecord, globalOffset );
+    putDef( tr->defRecord, traceLength );
+  }
 
   tr->defHandler->setTimerResolution( timerResolution );
   tr->defHandler->setTimerOffset( globalOffset );
@@ -453,6 +919,16 @@ OTF2TraceReader::OTF2_GlobalDefReaderCallback_Location(
 {
   OTF2TraceReader* tr = (OTF2TraceReader*)userData;
   
+  if( tr->defRecord )
+  {
+    putDef( tr->defRecord, ( uint8_t ) DEF_LOCATION );
+    putDef( tr->defRecord, self );
+    putDef( tr->defRecord, name );
+    putDef( tr->defRecord, locationType );
+    putDef( tr->defRecord, numberOfEvents );
+    putDef( tr->defRecord, locationGroup );
+  }
+  
   OTF2_SystemTreeNodeRef nodeRef = tr->locationGrpSysNodeRefMap[ locationGroup ];
   OTF2_StringRef nodeStringRef = tr->sysNodeStringRefMap[ nodeRef ];
   
@@ -472,10 +948,12 @@ OTF2TraceReader::OTF2_GlobalDefReaderCallback_Location(
     tr->handleProcessMPIMapping( tr, self, locationGroup );
   }
   
-  // for all locations of this MPI rank (this analysis process)
-  if( tr->mpiRank == locationGroup )
+  // for all locations of the MPI ranks of this analysis process
+  if( tr->mpiRank == 
+      getAnalysisRank( locationGroup, tr->numProcesses, tr->mpiSize ) )
   {
     tr->locationStringRefMap[ self ] = name;
+    tr->locationEventsMap[ self ]    = numberOfEvents;
     
     if ( tr->handleDefProcess )
     {
@@ -512,6 +990,15 @@ OTF2TraceReader::OTF2_GlobalDefReaderCallback_LocationProperty(
 {
   OTF2TraceReader* tr = (OTF2TraceReader*)userData;
   
+  if( tr->defRecord )
+  {
+    putDef( tr->defRecord, ( uint8_t ) DEF_LOCATION_PROPERTY );
+    putDef( tr->defRecord, location );
+    putDef( tr->defRecord, name );
+    putDef( tr->defRecord, type );
+    putDef( tr->defRecord, value );
+  }
+  
   if( tr->defHandler->haveStringRef( name ) )
   {
     UTILS_MSG( Parser::getInstance().getVerboseLevel() >= VERBOSE_BASIC, 
@@ -542,7 +1029,21 @@ OTF2TraceReader::OTF2_GlobalDefReaderCallback_LocationGroup(
   // if this is a process  
   if ( locationGroupType == OTF2_LOCATION_GROUP_TYPE_PROCESS )
   {
-    tr->locationGrpSysNodeRefMap[ self ] = systemTreeParent;
+    if( tr->defRecord )
+    {
+      putDef( tr->defRecord, ( uint8_t ) DEF_LOCATION_GROUP );
+      putDef( tr->defRecord, self );
+      putDef( tr->defRecord, name );
+      putDef( tr->defRecord, locationGroupType );
+      putDef( tr->defRecord, systemTreeParent );
+    }
+    
+    tr->numProcesses++;
+    
+    if( tr->mpiRank == 0 )
+    {
+      tr->locationGrpSysNodeRefMap[ self ] = systemTreeParent;
+    }
     
 //    if( tr->defHandler->haveStringRef( name ) )
 //    {
@@ -608,6 +1109,19 @@ OTF2TraceReader::OTF2_GlobalDefReaderCallback_Group( void*           userData,
   // also store empty groups which seem to be used in some rare cases (e.g. ug4)
   if( paradigm == OTF2_PARADIGM_MPI /*&& numberOfMembers > 0*/ )
   {
+    if( tr->defRecord )
+    {
+      putDef( tr->defRecord, ( uint8_t ) DEF_GROUP );
+      putDef( tr->defRecord, self );
+      putDef( tr->defRecord, name );
+      putDef( tr->defRecord, groupType );
+      putDef( tr->defRecord, paradigm );
+      putDef( tr->defRecord, groupFlags );
+      putDef( tr->defRecord, numberOfMembers );
+      tr->defRecord->insert( tr->defRecord->end(), ( const char* ) members, 
+        ( const char* ) ( members + numberOfMembers ) );
+    }
+    
     UTILS_MSG_NOBR( tr->mpiRank == 0 && Parser::getVerboseLevel() >= VERBOSE_BASIC && 
                     name != OTF2_UNDEFINED_STRING, 
                     "  [0] OTF2 MPI group definition %u: %s (",  
@@ -681,6 +1195,15 @@ OTF2TraceReader::OTF2_GlobalDefReaderCallback_Comm( void*          userData,
                                                     OTF2_CommRef   parent )
 {
   OTF2TraceReader* tr = (OTF2TraceReader*)userData;
+  
+  if( tr->defRecord )
+  {
+    putDef( tr->defRecord, ( uint8_t ) DEF_COMM );
+    putDef( tr->defRecord, self );
+    putDef( tr->defRecord, name );
+    putDef( tr->defRecord, group );
+    putDef( tr->defRecord, parent );
+  }
 
   // get the associated communication group
   CommGroupMap::iterator iter = tr->groupMap.find( group );
@@ -702,7 +1225,7 @@ OTF2TraceReader::OTF2_GlobalDefReaderCallback_Comm( void*          userData,
   if ( myGroup.paradigm == OTF2_PARADIGM_MPI ) // only MPI is stored
   {
     // make sure that no other definition of MPI_COMM_WORLD is written
-    if( self == 0 && myGroup.numberOfMembers != tr->mpiSize )
+    if( self == 0 && myGroup.numberOfMembers != tr->rankStreamMap.size() )
     {
       UTILS_WARNING( "OTF2 MPI communicator 0 already set!" );
       return OTF2_CALLBACK_SUCCESS;
@@ -726,6 +1249,13 @@ OTF2TraceReader::OTF2_GlobalDefReaderCallback_String( void*          userData,
 
   OTF2TraceReader* tr = (OTF2TraceReader*)userData;
   
+  if( tr->defRecord )
+  {
+    putDef( tr->defRecord, ( uint8_t ) DEF_STRING );
+    putDef( tr->defRecord, self );
+    putDefString( tr->defRecord, name );
+  }
+  
   tr->defHandler->storeString( self, name );
   
   //UTILS_MSG( tr->mpiRank == 0, "Read string definition for %s (%u)", 
@@ -748,6 +1278,15 @@ OTF2TraceReader::OTF2_GlobalDefReaderCallback_Region( void*          userData,
                                                       uint32_t       endLineNumber )
 {
   OTF2TraceReader* tr = (OTF2TraceReader*)userData;
+  
+  if( tr->defRecord )
+  {
+    putDef( tr->defRecord, ( uint8_t ) DEF_REGION );
+    putDef( tr->defRecord, self );
+    putDef( tr->defRecord, name );
+    putDef( tr->defRecord, regionRole );
+    putDef( tr->defRecord, paradigm );
+  }
 
   tr->defHandler->addRegion( self, paradigm, regionRole, name );
 
@@ -768,6 +1307,15 @@ OTF2TraceReader::OTF2_GlobalDefReaderCallback_Attribute( void*             userD
                                                          OTF2_Type         type )
 {
   OTF2TraceReader* tr = (OTF2TraceReader*)userData;
+  
+  if( tr->defRecord )
+  {
+    putDef( tr->defRecord, ( uint8_t ) DEF_ATTRIBUTE );
+    putDef( tr->defRecord, self );
+    putDef( tr->defRecord, name );
+    putDef( tr->defRecord, type );
+  }
+  
   std::string      s  = tr->defHandler->getName( name );
   tr->getNameKeysMap().insert( std::make_pair( s, self ) );
 
@@ -779,6 +1327,49 @@ OTF2TraceReader::OTF2_GlobalDefReaderCallback_Attribute( void*             userD
   return OTF2_CALLBACK_SUCCESS;
 }
 
+/**
+ * Forward an enter event to the enter handler. (Also used for fork events.)
+ */
+OTF2_CallbackCode
+OTF2TraceReader::enterRegion( OTF2_LocationRef    location,
+                              OTF2_TimeStamp      time,
+                              OTF2_AttributeList* attributes,
+                              OTF2_RegionRef      region )
+{
+  if ( handleEnter )
+  {
+    kvList.setList( attributes );
+
+    handleEnter( this, time - defHandler->getTimerOffset(), region, 
+                 location, &kvList );
+  }
+
+  return OTF2_CALLBACK_SUCCESS;
+}
+
+/**
+ * Forward a leave event to the leave handler. (Also used for join events.)
+ */
+OTF2_CallbackCode
+OTF2TraceReader::leaveRegion( OTF2_LocationRef    location,
+                              OTF2_TimeStamp      time,
+                              OTF2_AttributeList* attributes,
+                              OTF2_RegionRef      region )
+{
+  if ( handleLeave )
+  {
+    kvList.setList( attributes );
+
+    bool interrupt = handleLeave( this, time - defHandler->getTimerOffset(), 
+                                  region, location, &kvList );
+    
+    if ( interrupt )
+      return OTF2_CALLBACK_INTERRUPT;
+  }
+
+  return OTF2_CALLBACK_SUCCESS;
+}
+
 OTF2_CallbackCode
 OTF2TraceReader::otf2CallbackEnter( OTF2_LocationRef    location,
                                     OTF2_TimeStamp      time,
@@ -788,16 +1379,13 @@ OTF2TraceReader::otf2CallbackEnter( OTF2_LocationRef    location,
 {
   OTF2TraceReader* tr = ( OTF2TraceReader* )userData;
 
-  if ( tr->handleEnter )
+  if ( tr->eventBuffer )
   {
-    OTF2KeyValueList& kvList = tr->getKVList();
-    kvList.setList( attributes );
-
-    tr->handleEnter( tr, time - tr->defHandler->getTimerOffset(), region, 
-                     location, &kvList );
+    tr->eventBuffer->addEvent( BUFFERED_ENTER, location, time, attributes, 
+                               region );
   }
 
-  return OTF2_CALLBACK_SUCCESS;
+  return tr->enterRegion( location, time, attributes, region );
 }
 
 OTF2_CallbackCode
@@ -810,19 +1398,14 @@ OTF2TraceReader::otf2CallbackLeave( OTF2_LocationRef    location,
 
   OTF2TraceReader* tr = (OTF2TraceReader*)userData;
 
-  if ( tr->handleLeave )
+  // buffer the event before the handler might interrupt reading
+  if ( tr->eventBuffer )
   {
-    OTF2KeyValueList& kvList = tr->getKVList();
-    kvList.setList( attributes );
-
-    bool interrupt = tr->handleLeave( tr, time - tr->defHandler->getTimerOffset(), 
-                                      region, location, &kvList );
-    
-    if ( interrupt )
-      return OTF2_CALLBACK_INTERRUPT;
+    tr->eventBuffer->addEvent( BUFFERED_LEAVE, location, time, attributes, 
+                               region );
   }
 
-  return OTF2_CALLBACK_SUCCESS;
+  return tr->leaveRegion( location, time, attributes, region );
 }
 
 /**
@@ -853,7 +1436,14 @@ OTF2TraceReader::otf2Callback_MpiCollectiveEnd( OTF2_LocationRef  locationID,
 {
   OTF2TraceReader* tr = (OTF2TraceReader*)userData;
 
-  if ( tr->handleMPIComm )
+  if ( tr->eventBuffer )
+  {
+    tr->eventBuffer->addEvent( BUFFERED_MPI_COLLECTIVE_END, locationID, time, 
+                               attributeList, communicator, root, collectiveOp, 
+                               sizeSent, sizeReceived );
+  }
+
+  if ( tr->handleMPIComm && tr->mpiSize > 1 )
   {
     io::MPIType mpiType = io::MPI_COLLECTIVE;
     switch ( collectiveOp )
@@ -915,7 +1505,14 @@ OTF2TraceReader::otf2Callback_MpiRecv( OTF2_LocationRef    locationID,
 {
   OTF2TraceReader* tr = (OTF2TraceReader*)userData;
 
-  if ( tr->handleMPIComm )
+  if ( tr->eventBuffer )
+  {
+    tr->eventBuffer->addEvent( BUFFERED_MPI_RECV, locationID, time, 
+                               attributeList, communicator, sender, msgTag, 
+                               msgLength );
+  }
+
+  if ( tr->handleMPIComm && tr->mpiSize > 1 )
   {
     tr->handleMPIComm( tr, MPI_RECV, locationID, sender, communicator, msgTag );
   }
@@ -935,7 +1532,14 @@ OTF2TraceReader::otf2Callback_MpiSend( OTF2_LocationRef    locationID,
 {
   OTF2TraceReader* tr = (OTF2TraceReader*)userData;
 
-  if ( tr->handleMPIComm )
+  if ( tr->eventBuffer )
+  {
+    tr->eventBuffer->addEvent( BUFFERED_MPI_SEND, locationID, time, 
+                               attributeList, communicator, receiver, msgTag, 
+                               msgLength );
+  }
+
+  if ( tr->handleMPIComm && tr->mpiSize > 1 )
   {
     tr->handleMPIComm( tr, MPI_SEND, locationID, receiver, communicator, msgTag );
   }
@@ -956,7 +1560,14 @@ OTF2TraceReader::otf2Callback_MpiISend( OTF2_LocationRef    locationID,
 {
   OTF2TraceReader* tr = (OTF2TraceReader*)userData;
 
-  if ( tr->handleMPIIsend )
+  if ( tr->eventBuffer )
+  {
+    tr->eventBuffer->addEvent( BUFFERED_MPI_ISEND, locationID, time, 
+                               attributeList, communicator, receiver, msgTag, 
+                               msgLength, requestID );
+  }
+
+  if ( tr->handleMPIIsend && !tr->ignoreAsyncMPI )
   {
     tr->handleMPIIsend( tr, locationID, receiver, communicator, msgTag, requestID );
   }
@@ -973,7 +1584,13 @@ OTF2TraceReader::otf2Callback_MpiISendComplete( OTF2_LocationRef    locationID,
 {
   OTF2TraceReader* tr = (OTF2TraceReader*)userData;
 
-  if ( tr->handleMPIIsendComplete )
+  if ( tr->eventBuffer )
+  {
+    tr->eventBuffer->addEvent( BUFFERED_MPI_ISEND_COMPLETE, locationID, time, 
+                               attributeList, 0, 0, 0, 0, requestID );
+  }
+
+  if ( tr->handleMPIIsendComplete && !tr->ignoreAsyncMPI )
   {
     tr->handleMPIIsendComplete( tr, locationID, requestID );
   }
@@ -990,7 +1607,13 @@ OTF2TraceReader::otf2Callback_MpiIRecvRequest( OTF2_LocationRef    locationID,
 {
   OTF2TraceReader* tr = (OTF2TraceReader*)userData;
 
-  if ( tr->handleMPIIrecvRequest )
+  if ( tr->eventBuffer )
+  {
+    tr->eventBuffer->addEvent( BUFFERED_MPI_IRECV_REQUEST, locationID, time, 
+                               attributeList, 0, 0, 0, 0, requestID );
+  }
+
+  if ( tr->handleMPIIrecvRequest && !tr->ignoreAsyncMPI )
   {
     tr->handleMPIIrecvRequest( tr, locationID, requestID );
   }
@@ -1011,7 +1634,14 @@ OTF2TraceReader::otf2Callback_MpiIRecv( OTF2_LocationRef    locationID,
 {
   OTF2TraceReader* tr = (OTF2TraceReader*)userData;
 
-  if ( tr->handleMPIIrecv )
+  if ( tr->eventBuffer )
+  {
+    tr->eventBuffer->addEvent( BUFFERED_MPI_IRECV, locationID, time, 
+                               attributeList, communicator, sender, msgTag, 
+                               msgLength, requestID );
+  }
+
+  if ( tr->handleMPIIrecv && !tr->ignoreAsyncMPI )
   {
     tr->handleMPIIrecv( tr, locationID, sender, communicator, msgTag, requestID );
   }
@@ -1030,11 +1660,17 @@ OTF2TraceReader::OTF2_GlobalEvtReaderCallback_ThreadFork(
 {
   OTF2TraceReader* tr = (OTF2TraceReader*)userData;
 
+  if ( tr->eventBuffer )
+  {
+    tr->eventBuffer->addEvent( BUFFERED_THREAD_FORK, locationID, time, 
+                               attributeList, 0, numberOfRequestedThreads, 
+                               paradigm );
+  }
+
   // handle fork node as enter event
   OTF2_CallbackCode ret = 
-    OTF2TraceReader::otf2CallbackEnter( locationID, time, userData,
-                                        attributeList,
-                                        tr->defHandler->getForkJoinRegionId() );
+    tr->enterRegion( locationID, time, attributeList,
+                     tr->defHandler->getForkJoinRegionId() );
   
   // add the requested threads to the enter event
   if ( tr->handleThreadFork )
@@ -1042,7 +1678,7 @@ OTF2TraceReader::OTF2_GlobalEvtReaderCallback_ThreadFork(
     tr->handleThreadFork( tr, locationID, numberOfRequestedThreads );
   }
   
-  return ret;;
+  return ret;
 }
 
 OTF2_CallbackCode
@@ -1056,9 +1692,14 @@ OTF2TraceReader::OTF2_GlobalEvtReaderCallback_ThreadJoin( OTF2_LocationRef locat
 {
   OTF2TraceReader* tr = (OTF2TraceReader*)userData;
 
-  return OTF2TraceReader::otf2CallbackLeave( locationID, time, userData,
-                                             attributeList,
-                                             tr->defHandler->getForkJoinRegionId() );
+  if ( tr->eventBuffer )
+  {
+    tr->eventBuffer->addEvent( BUFFERED_THREAD_JOIN, locationID, time, 
+                               attributeList, 0, 0, paradigm );
+  }
+
+  return tr->leaveRegion( locationID, time, attributeList,
+                          tr->defHandler->getForkJoinRegionId() );
 }
 
 OTF2_CallbackCode
@@ -1071,6 +1712,12 @@ OTF2TraceReader::otf2CallbackComm_RmaWinDestroy(
 {
   OTF2TraceReader* tr = (OTF2TraceReader*)userData;
 
+  if ( tr->eventBuffer )
+  {
+    tr->eventBuffer->addEvent( BUFFERED_RMA_WIN_DESTROY, location, time, 
+                               attributeList, win );
+  }
+
   if ( tr->handleRmaWinDestroy )
   {
     tr->handleRmaWinDestroy( tr, time - tr->defHandler->getTimerOffset() , location );
@@ -1078,22 +1725,27 @@ OTF2TraceReader::otf2CallbackComm_RmaWinDestroy(
   
   return OTF2_CALLBACK_SUCCESS;
 }
-/*
+/******************************************************************************/
+/* The following callbacks are only registered, if the events are buffered for
+ * the trace writer. The analysis does not use these events.
+ */
+
 OTF2_CallbackCode
-OTF2TraceReader::otf2CallbackComm_RmaPut( OTF2_LocationRef location,
-                                                  OTF2_TimeStamp   time,
-                                                  void*            userData,
-                                                  OTF2_AttributeList* attributes,
-                                                  OTF2_RmaWinRef   win,
-                                                  uint32_t         remote,
-                                                  uint64_t         bytes,
-                                                  uint64_t         matchingId )
+OTF2TraceReader::otf2CallbackComm_RmaPut( OTF2_LocationRef    location,
+                                          OTF2_TimeStamp      time,
+                                          void*               userData,
+                                          OTF2_AttributeList* attributeList,
+                                          OTF2_RmaWinRef      win,
+                                          uint32_t            remote,
+                                          uint64_t            bytes,
+                                          uint64_t            matchingId )
 {
   OTF2TraceReader* tr = (OTF2TraceReader*)userData;
 
-  if ( tr->handleRmaPut )
+  if ( tr->eventBuffer )
   {
-    tr->handleRmaPut( tr, time - tr->getTimerOffset() , location );
+    tr->eventBuffer->addEvent( BUFFERED_RMA_PUT, location, time, attributeList,
+                               win, remote, 0, bytes, matchingId );
   }
 
   return OTF2_CALLBACK_SUCCESS;
@@ -1110,35 +1762,130 @@ OTF2TraceReader::otf2CallbackComm_RmaOpCompleteBlocking(
 {
   OTF2TraceReader* tr = (OTF2TraceReader*)userData;
   
-  if ( tr->handleRmaOpCompleteBlocking )
+  if ( tr->eventBuffer )
   {
-    tr->handleRmaOpCompleteBlocking( tr, time - tr->getTimerOffset() , location );
+    tr->eventBuffer->addEvent( BUFFERED_RMA_OP_COMPLETE_BLOCKING, location, 
+                               time, attributeList, win, 0, 0, 0, matchingId );
   }
 
   return OTF2_CALLBACK_SUCCESS;
 }
 
 OTF2_CallbackCode
-OTF2TraceReader::otf2CallbackComm_RmaGet( OTF2_LocationRef location,
-                                                  OTF2_TimeStamp   time,
-                                                  void*            userData,
-                                                  OTF2_AttributeList*
-                                                  attributeList,
-                                                  OTF2_RmaWinRef   win,
-                                                  uint32_t         remote,
-                                                  uint64_t         bytes,
-                                                  uint64_t         matchingId )
+OTF2TraceReader::otf2CallbackComm_RmaGet( OTF2_LocationRef    location,
+                                          OTF2_TimeStamp      time,
+                                          void*               userData,
+                                          OTF2_AttributeList* attributeList,
+                                          OTF2_RmaWinRef      win,
+                                          uint32_t            remote,
+                                          uint64_t            bytes,
+                                          uint64_t            matchingId )
 {
   OTF2TraceReader* tr = (OTF2TraceReader*)userData;
 
-  if ( tr->handleRmaGet )
+  if ( tr->eventBuffer )
   {
-    tr->handleRmaGet( tr, time - tr->getTimerOffset() , location );
+    tr->eventBuffer->addEvent( BUFFERED_RMA_GET, location, time, attributeList,
+                               win, remote, 0, bytes, matchingId );
+  }
+  
+  return OTF2_CALLBACK_SUCCESS;
+}
+
+OTF2_CallbackCode
+OTF2TraceReader::otf2CallbackComm_RmaWinCreate( OTF2_LocationRef    location,
+                                                OTF2_TimeStamp      time,
+                                                void*               userData,
+                                                OTF2_AttributeList* attributeList,
+                                                OTF2_RmaWinRef      win )
+{
+  OTF2TraceReader* tr = (OTF2TraceReader*)userData;
+
+  if ( tr->eventBuffer )
+  {
+    tr->eventBuffer->addEvent( BUFFERED_RMA_WIN_CREATE, location, time, 
+                               attributeList, win );
+  }
+  
+  return OTF2_CALLBACK_SUCCESS;
+}
+
+OTF2_CallbackCode
+OTF2TraceReader::otf2CallbackComm_MpiCollectiveBegin( 
+                                            OTF2_LocationRef    location,
+                                            OTF2_TimeStamp      time,
+                                            void*               userData,
+                                            OTF2_AttributeList* attributeList )
+{
+  OTF2TraceReader* tr = (OTF2TraceReader*)userData;
+
+  if ( tr->eventBuffer )
+  {
+    tr->eventBuffer->addEvent( BUFFERED_MPI_COLLECTIVE_BEGIN, location, time, 
+                               attributeList, 0 );
+  }
+  
+  return OTF2_CALLBACK_SUCCESS;
+}
+
+OTF2_CallbackCode
+OTF2TraceReader::otf2CallbackComm_ThreadTeamBegin( 
+                                            OTF2_LocationRef    locationID,
+                                            OTF2_TimeStamp      time,
+                                            void*               userData,
+                                            OTF2_AttributeList* attributeList,
+                                            OTF2_CommRef        threadTeam )
+{
+  OTF2TraceReader* tr = (OTF2TraceReader*)userData;
+
+  if ( tr->eventBuffer )
+  {
+    tr->eventBuffer->addEvent( BUFFERED_THREAD_TEAM_BEGIN, locationID, time, 
+                               attributeList, threadTeam );
+  }
+  
+  return OTF2_CALLBACK_SUCCESS;
+}
+
+OTF2_CallbackCode
+OTF2TraceReader::otf2CallbackComm_ThreadTeamEnd( 
+                                            OTF2_LocationRef    locationID,
+                                            OTF2_TimeStamp      time,
+                                            void*               userData,
+                                            OTF2_AttributeList* attributeList,
+                                            OTF2_CommRef        threadTeam )
+{
+  OTF2TraceReader* tr = (OTF2TraceReader*)userData;
+
+  if ( tr->eventBuffer )
+  {
+    tr->eventBuffer->addEvent( BUFFERED_THREAD_TEAM_END, locationID, time, 
+                               attributeList, threadTeam );
+  }
+  
+  return OTF2_CALLBACK_SUCCESS;
+}
+
+OTF2_CallbackCode
+OTF2TraceReader::otf2CallbackMetric( OTF2_LocationRef        location,
+                                     OTF2_TimeStamp          time,
+                                     void*                   userData,
+                                     OTF2_AttributeList*     attributeList,
+                                     OTF2_MetricRef          metric,
+                                     uint8_t                 numberOfMetrics,
+                                     const OTF2_Type*        typeIDs,
+                                     const OTF2_MetricValue* metricValues )
+{
+  OTF2TraceReader* tr = (OTF2TraceReader*)userData;
+
+  if ( tr->eventBuffer )
+  {
+    tr->eventBuffer->addMetric( location, time, attributeList, metric, 
+                                numberOfMetrics, typeIDs, metricValues );
   }
   
   return OTF2_CALLBACK_SUCCESS;
 }
-*/
 
 std::vector< uint32_t >
 OTF2TraceReader::getKeys( const std::string keyName )
@@ -1175,3 +1922,175 @@ OTF2TraceReader::getUserData()
 {
   return userData;
 }
+
+/**
+ * Decode the events of the local locations in parallel (OpenMP) instead of
+ * using the OTF2 global event reader. Has to be called directly after open().
+ * 
+ * @param enable true, to enable parallel event decoding
+ */
+void
+OTF2TraceReader::setParallelEventReading( bool enable )
+{
+#if defined(_OPENMP)
+  if ( enable )
+  {
+    // OTF2 has to be thread-safe to read several locations concurrently
+    OTF2_CHECK( OTF2_OpenMP_Reader_SetLockingCallbacks( reader ) );
+  }
+  
+  parallelEvents = enable;
+#else
+  UTILS_MSG( enable && mpiRank == 0, 
+             "[0] Parallel event reading requires OpenMP. Read sequentially." );
+#endif
+}
+
+/**
+ * Use a cache of the decoded events in the given directory. If the cache of 
+ * this analysis process has been written by a previous run on the same trace
+ * (with the same number of processes), the events are read from the cache. 
+ * Otherwise, the cache is written while the events are read. The cache is 
+ * read and written by the parallel event reader. Has to be called after 
+ * readDefinitions() and before setupEventReader().
+ * 
+ * @param directory directory of the cache files
+ */
+void
+OTF2TraceReader::setTraceCache( const std::string& directory )
+{
+  traceCacheDir = directory;
+  
+#if defined(_OPENMP)
+  // the locations are decoded concurrently while the cache is written
+  OTF2_CHECK( OTF2_OpenMP_Reader_SetLockingCallbacks( reader ) );
+#endif
+}
+
+/**
+ * Forward an event from the parallel event reader to the event callbacks.
+ * 
+ * @param event the event
+ * @param buffer buffer that contains the attributes of the event
+ * 
+ * @return OTF2_CALLBACK_INTERRUPT, if the reading has to be interrupted
+ */
+OTF2_CallbackCode
+OTF2TraceReader::replayEvent( const BufferedEvent&   event,
+                              const OTF2EventBuffer& buffer )
+{
+  buffer.getAttributes( event, replayAttributes );
+  
+  switch ( event.type )
+  {
+    case BUFFERED_ENTER:
+      return otf2CallbackEnter( event.location, event.time, this, 
+                                replayAttributes, event.ref );
+
+    case BUFFERED_LEAVE:
+      return otf2CallbackLeave( event.location, event.time, this, 
+                                replayAttributes, event.ref );
+
+    case BUFFERED_THREAD_FORK:
+      return OTF2_GlobalEvtReaderCallback_ThreadFork( event.location, 
+        event.time, this, replayAttributes, ( OTF2_Paradigm ) event.tag, 
+        event.partner );
+
+    case BUFFERED_THREAD_JOIN:
+      return OTF2_GlobalEvtReaderCallback_ThreadJoin( event.location, 
+        event.time, this, replayAttributes, ( OTF2_Paradigm ) event.tag );
+
+    case BUFFERED_MPI_SEND:
+      return otf2Callback_MpiSend( event.location, event.time, this, 
+                                   replayAttributes, event.partner, event.ref, 
+                                   event.tag, event.size );
+
+    case BUFFERED_MPI_RECV:
+      return otf2Callback_MpiRecv( event.location, event.time, this, 
+                                   replayAttributes, event.partner, event.ref, 
+                                   event.tag, event.size );
+
+    case BUFFERED_MPI_COLLECTIVE_END:
+      return otf2Callback_MpiCollectiveEnd( event.location, event.time, this, 
+        replayAttributes, ( OTF2_CollectiveOp ) event.tag, event.ref, 
+        event.partner, event.size, event.id );
+
+    case BUFFERED_MPI_ISEND:
+      return otf2Callback_MpiISend( event.location, event.time, this, 
+                                    replayAttributes, event.partner, event.ref, 
+                                    event.tag, event.size, event.id );
+
+    case BUFFERED_MPI_ISEND_COMPLETE:
+      return otf2Callback_MpiISendComplete( event.location, event.time, this, 
+                                            replayAttributes, event.id );
+
+    case BUFFERED_MPI_IRECV:
+      return otf2Callback_MpiIRecv( event.location, event.time, this, 
+                                    replayAttributes, event.partner, event.ref, 
+                                    event.tag, event.size, event.id );
+
+    case BUFFERED_MPI_IRECV_REQUEST:
+      return otf2Callback_MpiIRecvRequest( event.location, event.time, this, 
+                                           replayAttributes, event.id );
+
+    case BUFFERED_RMA_WIN_DESTROY:
+      return otf2CallbackComm_RmaWinDestroy( event.location, event.time, this, 
+                                             replayAttributes, event.ref );
+
+    case BUFFERED_METRIC:
+      return otf2CallbackMetric( event.location, event.time, this, 
+                                 replayAttributes, event.ref, 
+                                 ( uint8_t ) event.dataCount, 
+                                 buffer.getMetricTypes( event ),
+                                 buffer.getMetricValues( event ) );
+
+    case BUFFERED_MPI_COLLECTIVE_BEGIN:
+      return otf2CallbackComm_MpiCollectiveBegin( event.location, event.time, 
+                                                  this, replayAttributes );
+
+    case BUFFERED_THREAD_TEAM_BEGIN:
+      return otf2CallbackComm_ThreadTeamBegin( event.location, event.time, 
+                                               this, replayAttributes, 
+                                               event.ref );
+
+    case BUFFERED_THREAD_TEAM_END:
+      return otf2CallbackComm_ThreadTeamEnd( event.location, event.time, this, 
+                                             replayAttributes, event.ref );
+
+    case BUFFERED_RMA_WIN_CREATE:
+      return otf2CallbackComm_RmaWinCreate( event.location, event.time, this, 
+                                            replayAttributes, event.ref );
+
+    case BUFFERED_RMA_PUT:
+      return otf2CallbackComm_RmaPut( event.location, event.time, this, 
+                                      replayAttributes, event.ref, 
+                                      event.partner, event.size, event.id );
+
+    case BUFFERED_RMA_GET:
+      return otf2CallbackComm_RmaGet( event.location, event.time, this, 
+                                      replayAttributes, event.ref, 
+                                      event.partner, event.size, event.id );
+
+    case BUFFERED_RMA_OP_COMPLETE_BLOCKING:
+      return otf2CallbackComm_RmaOpCompleteBlocking( event.location, 
+        event.time, this, replayAttributes, event.ref, event.id );
+
+    default:
+      UTILS_WARNING( "[%" PRIu32 "] Reader: Unknown event type %u",
+                     mpiRank, ( unsigned int ) event.type );
+  }
+  
+  return OTF2_CALLBACK_SUCCESS;
+}
+
+/**
+ * Set the buffer that keeps the read events for the trace writer. Has to be
+ * called before setupEventReader().
+ * 
+ * @param buffer event buffer
+ */
+void
+OTF2TraceReader::setEventBuffer( OTF2EventBuffer* buffer )
+{
+  eventBuffer = buffer;
+}
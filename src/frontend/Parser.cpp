@@ -104,6 +104,9 @@ namespace casita
     cout << " -h [--help]              print help message" << endl;
     cout << " -i [--input=]NAME        input OTF2 file" << endl;
     cout << " -o [--output=]NAME       output OTF2 file" << endl;
+    cout << "     --metrics-only       write only the CASITA metrics to the output trace" << endl
+         << "                          (overlay of the input trace, which can be merged" << endl
+         << "                          with the input trace by casita-merge)" << endl;
     cout << " -r [--replace]           replace CASITA trace and summary file" << endl;
     cout << " -v [--verbose=]INTEGER   verbosity level" << endl;
     cout << "    [--no-csv]            write rating to .csv file" << endl;
@@ -128,6 +131,32 @@ namespace casita
          << "                          collectives) to reduce memory footprint. The value" << endl
          << "                          (default: 64) sets the number of pending graph nodes" << endl
          << "                          before an analysis run is started." << endl;
+    cout << "     --memory-limit=UINT  start an analysis run (between global MPI" << endl
+         << "                          collectives) before the graph and pending MPI" << endl
+         << "                          records exceed UINT MiB (replaces the node count" << endl
+         << "                          of --interval-analysis, default: 0 = off)" << endl;
+    cout << "     --time-interval=FLOAT start an analysis run every FLOAT seconds of" << endl
+         << "                          trace time (cut at the next MPI operation, no" << endl
+         << "                          global collectives needed, implies --bulk-p2p," << endl
+         << "                          default: 0 = off)" << endl;
+    cout << "     --event-buffer=UINT  keep up to UINT MiB of events per analysis interval" << endl
+         << "                          in memory to avoid reading the input trace twice" << endl
+         << "                          (default: 0 = off, without output trace only" << endl
+         << "                          regions are kept, up to --memory-limit or 1 GiB)" << endl;
+    cout << "     --parallel-read      decode the events of the local locations in" << endl
+         << "                          parallel (requires OpenMP)" << endl;
+    cout << "     --trace-cache=DIR    read the events from a cache in DIR, which is" << endl
+         << "                          written by the first run on the trace (per" << endl
+         << "                          process, for the same number of processes)" << endl;
+    cout << "     --graph-store=DIR    store the analyzed graph per process in DIR" << endl
+         << "                          for critical path predictions with" << endl
+         << "                          casita-predict" << endl;
+    cout << "     --bulk-p2p           match blocking MPI point-to-point operations with" << endl
+         << "                          one exchange per interval instead of replaying" << endl
+         << "                          each message (ignores non-blocking MPI)" << endl;
+    cout << "     --pipeline-write     write the trace of an analysis interval on another" << endl
+         << "                          thread, while the next interval is analyzed" << endl
+         << "                          (requires OpenMP, no offloading)" << endl;
   }
 
   bool
@@ -396,6 +425,60 @@ namespace casita
         options.analysisInterval = 
           atoi( opt.erase( 0, string( "--interval-analysis=" ).length() ).c_str() );
       }
+      
+      else if( opt.find( "--memory-limit=" ) != string::npos )
+      {
+        options.memoryLimit = 
+          atoi( opt.erase( 0, string( "--memory-limit=" ).length() ).c_str() );
+      }
+      
+      else if( opt.find( "--time-interval=" ) != string::npos )
+      {
+        options.timeInterval = 
+          atof( opt.erase( 0, string( "--time-interval=" ).length() ).c_str() );
+      }
+      
+      else if( opt.find( "--event-buffer=" ) != string::npos )
+      {
+        options.eventBufferSize = 
+          atoi( opt.erase( 0, string( "--event-buffer=" ).length() ).c_str() );
+      }
+      
+      else if( opt.find( "--parallel-read" ) != string::npos )
+      {
+        options.parallelRead = true;
+        
+        UTILS_MSG( mpiRank == 0, "[Decode events of local locations in parallel.]" );
+      }
+      
+      else if( opt.find( "--trace-cache=" ) != string::npos )
+      {
+        options.traceCache = opt.erase( 0, string( "--trace-cache=" ).length() );
+      }
+      
+      else if( opt.find( "--graph-store=" ) != string::npos )
+      {
+        options.graphStore = opt.erase( 0, string( "--graph-store=" ).length() );
+      }
+      
+      else if( opt.find( "--bulk-p2p" ) != string::npos )
+      {
+        options.bulkP2P = true;
+        
+        UTILS_MSG( mpiRank == 0, "[Match MPI point-to-point operations in bulk.]" );
+      }
+      
+      else if( opt.find( "--pipeline-write" ) != string::npos )
+      {
+        options.pipelineWrite = true;
+        
+        UTILS_MSG( mpiRank == 0, "[Write analysis intervals on another thread.]" );
+      }
+      
+      else if( opt.find( "--metrics-only" ) != string::npos )
+      {
+        options.metricsOnly = true;
+      }
 
         // if nothing matches 
       else
@@ -416,6 +499,19 @@ namespace casita
       throw RTException( "No OTF2 input file specified (%s)", 
                          options.inFileName.c_str() );
     }
+    
+    if( options.metricsOnly )
+    {
+      if( options.createTraceFile )
+      {
+        UTILS_MSG( mpiRank == 0, "[Write only CASITA metrics to the output trace.]" );
+      }
+      else
+      {
+        UTILS_MSG( mpiRank == 0, "--metrics-only is ignored without output trace" );
+        options.metricsOnly = false;
+      }
+    }
 
     return true;
   }
@@ -592,11 +688,20 @@ namespace casita
   Parser::setDefaultValues()
   {
     options.createTraceFile = false;
+    options.metricsOnly = false;
     options.eventsProcessed = 0;
     options.inFileName = "";
     options.mergeActivities = true;
     options.noErrors = false;
     options.analysisInterval = 64;
+    options.memoryLimit = 0;
+    options.timeInterval = 0;
+    options.eventBufferSize = 0;
+    options.parallelRead = false;
+    options.traceCache = "";
+    options.graphStore = "";
+    options.bulkP2P = false;
+    options.pipelineWrite = false;
     //options.outOtfFile = "casita.otf2";
     options.replaceCASITAoutput = false;
     options.printCriticalPath = false;
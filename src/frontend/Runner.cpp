@@ -14,7 +14,7 @@
  * - trigger computation of critical path:
  * - getCriticalPath()
  *      * 1 MPI process  -> getCriticalPathIntern()-> graph.getLongestPath()
- *      * >1 MPI process -> detectCriticalPathMPIP2P()
+ *      * >1 MPI process -> detectCriticalPathMPIP2P() (pointer jumping over the stream changes)
  *                       -> getCriticalLocalSections() -> getCriticalPathIntern() for all sections created in replay, add nodes to set of critical nodes
  *      * Compute global length of CP (TODO: right now this takes the difference between first and last global timestamp...)
  * - runAnalysis() -> goes through all nodes (non-CPU) and applies rules for a given paradigm
@@ -25,6 +25,7 @@
 
 #include <time.h>
 #include <vector>       /* clock_t, clock, CLOCKS_PER_SEC */
+#include <algorithm>
 
 #include "otf/OTF2DefinitionHandler.hpp"
 
@@ -47,6 +48,7 @@ Runner::Runner( int mpiRank, int mpiSize ) :
   analysis( mpiRank, mpiSize ),
   callbacks( analysis ), // construct the CallbackHandler
   writer ( NULL ),
+  graphStore( NULL ),
   globalLengthCP( 0 )
 {
   if ( options.noErrors )
@@ -73,6 +75,10 @@ Runner::Runner( int mpiRank, int mpiSize ) :
   }
   
   totalEventsRead = 0;
+  
+  pendingWriteEvents = 0;
+  writtenEvents      = 0;
+  writeFailed        = false;
 }
 
 Runner::~Runner()
@@ -83,6 +89,11 @@ Runner::~Runner()
     writer->close();
     delete writer;
   }
+  
+  if ( graphStore != NULL )
+  {
+    delete graphStore;
+  }
 }
 
 void
@@ -128,6 +139,7 @@ Runner::prepareAnalysis()
   traceReader->handleThreadFork       = CallbackHandler::handleThreadFork;
 
   traceReader->open( options.inFileName, 10 );
+  traceReader->setParallelEventReading( options.parallelRead );
   UTILS_MSG( options.verbose >= VERBOSE_BASIC && mpiRank == 0,
              "[0] Reading definitions ... " );
   
@@ -173,12 +185,119 @@ Runner::prepareAnalysis()
   
   // create MPI communicators according to the OTF2 trace definitions
   analysis.getMPIAnalysis().createMPICommunicatorsFromMap();
+  
+  // bulk mode (always in M:N mode): the point-to-point operations of an 
+  // interval are matched in bulk, which cannot be combined with the replay of 
+  // non-blocking MPI operations
+  if( analysis.getMPIAnalysis().isBulkP2PMode() )
+  {
+    if( !options.ignoreAsyncMpi )
+    {
+      UTILS_MSG( mpiRank == 0, "Non-blocking MPI communication is ignored, as "
+                 "point-to-point operations are matched in bulk." );
+      options.ignoreAsyncMpi = true;
+    }
+    
+    // the MPI streams of several ranks per process cannot be cut at a 
+    // consistent point (unmatched records are carried to the next interval)
+    if( analysis.getMPIAnalysis().isMultiRankMode() && 
+        ( options.analysisInterval || options.timeInterval > 0 ) )
+    {
+      UTILS_MSG( mpiRank == 0 && options.verbose >= VERBOSE_BASIC, 
+                 "[0] Analysis intervals are disabled, as several MPI ranks "
+                 "are analyzed per process." );
+      options.analysisInterval = 0;
+      options.timeInterval = 0;
+    }
+  }
+  
+  // cut intervals by trace time (instead of at global collectives)
+  if( options.timeInterval > 0 && mpiSize > 1 )
+  {
+    uint64_t ticks = ( uint64_t )( options.timeInterval * timerResolution );
+    callbacks.setCutInterval( ticks > 0 ? ticks : 1 );
+  }
+
+  // the writer thread cannot share the statistics with the offload analysis
+  if( options.pipelineWrite )
+  {
+#if defined(_OPENMP)
+    if( Parser::ignoreOffload() == false )
+    {
+      UTILS_MSG( mpiRank == 0, "[0] Pipelined trace writing is not supported "
+                 "with offloading. Write sequentially." );
+      options.pipelineWrite = false;
+    }
+#else
+    UTILS_MSG( mpiRank == 0, 
+               "[0] Pipelined trace writing requires OpenMP. Write sequentially." );
+    options.pipelineWrite = false;
+#endif
+  }
+
+  // keep the events of an interval in memory for the trace writer
+  if( options.eventBufferSize > 0 )
+  {
+    eventBuffer.setMemoryLimit( ( uint64_t ) options.eventBufferSize * 1024 * 1024 );
+    traceReader->setEventBuffer( &eventBuffer );
+    
+    // the events of the previous interval are kept while the writer uses them
+    writeEventBuffer.setMemoryLimit( ( uint64_t ) options.eventBufferSize * 1024 * 1024 );
+  }
+  
+  // without output trace (or if only the CASITA metrics are written), the 
+  // writer computes only the blame and the profile, which needs the region and
+  // device task events (no attributes, metrics and MPI records) 
+  // -> buffer them to decode the input trace only once
+  if( !options.createTraceFile || options.metricsOnly )
+  {
+    // the buffer is bounded by the memory limit of the analysis (or 1 GiB),
+    // on overflow the writer reads the interval from the trace file
+    if( options.eventBufferSize == 0 )
+    {
+      uint64_t bufferLimit = ( uint64_t ) 1024 * 1024 * 1024;
+      if( options.memoryLimit > 0 )
+      {
+        bufferLimit = ( uint64_t ) options.memoryLimit * 1024 * 1024;
+      }
+      
+      eventBuffer.setMemoryLimit( bufferLimit );
+      writeEventBuffer.setMemoryLimit( bufferLimit );
+      traceReader->setEventBuffer( &eventBuffer );
+    }
+    
+    eventBuffer.setProfileOnly( true );
+    writeEventBuffer.setProfileOnly( true );
+    
+    UTILS_MSG( mpiRank == 0 && options.verbose >= VERBOSE_BASIC, 
+               "[0] Replay buffered regions for the profile and metrics" );
+  }
+
+  // the paradigm options are final -> classify the regions once
+  definitions.classifyRegions( mpiSize == 1 );
+
+  // read the events from the cache of a previous run (or write the cache)
+  if( !options.traceCache.empty() )
+  {
+    traceReader->setTraceCache( options.traceCache );
+  }
+
+  // store the analyzed graph for critical path predictions
+  if( !options.graphStore.empty() )
+  {
+    graphStore = new GraphStore();
+    graphStore->create( GraphStore::getFileName( options.graphStore, 
+                          options.inFileName, mpiRank, mpiSize ), 
+                        mpiRank, mpiSize, definitions.getTimerResolution() );
+    analysis.setGraphStore( graphStore );
+  }
 
   // setup reading events
   traceReader->setupEventReader( options.ignoreAsyncMpi );
   
   // initialize the OTF2 trace writer
-  writer = new OTF2ParallelTraceWriter( &analysis, &definitions );
+  writer = new OTF2ParallelTraceWriter( &analysis, &definitions, 
+    options.pipelineWrite ? &writeEventBuffer : &eventBuffer );
   
   #if defined(SCOREP_USER_ENABLE)
   SCOREP_USER_REGION_END( prepare_handle )
@@ -187,6 +306,24 @@ Runner::prepareAnalysis()
   // read events from the trace, build a graph and do the analysis
   processTrace( traceReader );
   
+  if( graphStore )
+  {
+    for( uint32_t regionRef = 0; regionRef < definitions.getNumRegions(); 
+         ++regionRef )
+    {
+      const char* name = definitions.getRegionInfo( regionRef ).name;
+      if( name )
+      {
+        graphStore->addRegionName( regionRef, name );
+      }
+    }
+    
+    graphStore->finish( globalLengthCP );
+    
+    UTILS_MSG( mpiRank == 0, "Stored the analyzed graph in %s", 
+               options.graphStore.c_str() );
+  }
+  
   UTILS_MSG( mpiRank == 0 && options.verbose >= VERBOSE_BASIC &&
              options.analysisInterval,
              "[0] Global collectives found: %u", 
@@ -197,6 +334,59 @@ Runner::prepareAnalysis()
   delete traceReader;
 }
 
+/**
+ * Process the input trace (see processIntervals()). With --pipeline-write, a 
+ * second OpenMP thread writes the trace of an interval, while the master 
+ * thread (which does all MPI communication) continues with the next interval.
+ * 
+ * @param traceReader a fully set up trace reader (definitions are read)
+ */
+void
+Runner::processTrace( OTF2TraceReader* traceReader )
+{
+  if( !options.pipelineWrite )
+  {
+    processIntervals( traceReader );
+    return;
+  }
+  
+#if defined(_OPENMP)
+  // keep the OpenMP parallel regions of the analysis (nested now)
+  omp_set_max_active_levels( 2 );
+#endif
+  
+  // exceptions must not leave the parallel region
+  bool failed = false;
+  std::string error;
+  
+  #pragma omp parallel num_threads( 2 )
+  {
+    #pragma omp master
+    {
+      try
+      {
+        processIntervals( traceReader );
+      }
+      catch( std::exception& e )
+      {
+        failed = true;
+        error  = e.what();
+      }
+      catch( ... )
+      {
+        failed = true;
+        error  = "unknown exception";
+      }
+    }
+  }
+  
+  if( failed )
+  {
+    throw RTException( "[%d] Interval processing failed: %s", mpiRank, 
+                       error.c_str() );
+  }
+}
+
 /**
  * Processes the input trace and write the output trace. 
  * (in intervals if specified)
@@ -211,7 +401,7 @@ Runner::prepareAnalysis()
  * @param traceReader a fully set up trace reader (definitions are read)
  */
 void
-Runner::processTrace( OTF2TraceReader* traceReader )
+Runner::processIntervals( OTF2TraceReader* traceReader )
 {
 #if defined(SCOREP_USER_ENABLE)
   SCOREP_USER_REGION_DEFINE( read_handle )
@@ -255,6 +445,27 @@ Runner::processTrace( OTF2TraceReader* traceReader )
   uint32_t analysis_intervals = 0;
   uint64_t events_to_read     = 0; // number of events for the trace writer to read
   
+  // memory budget of an interval in bytes (0, if the node count is used)
+  const uint64_t memory_limit = ( uint64_t ) options.memoryLimit * 1024 * 1024;
+  uint64_t last_memory_usage  = 0; // bytes at the previous global collective
+  uint64_t max_memory_growth  = 0; // largest growth between global collectives
+  
+  // the maximum pending nodes (or bytes) of all processes are reduced while
+  // reading continues and evaluated at the next global collective
+  uint64_t local_pending      = 0;
+  uint64_t max_pending        = 0;
+#if MPI_VERSION >= 3
+  MPI_Request pending_request = MPI_REQUEST_NULL;
+#endif
+  
+  // an intermediate analysis is started at the next global collective, where
+  // all processes are able to do so
+  bool     cut_requested      = false;
+  
+  // intervals are cut by trace time (the reader stops at the first MPI leave
+  // after the cut time on every process)
+  const bool time_cuts = options.timeInterval > 0 && mpiSize > 1;
+  
   clock_t time_start         = clock();
   clock_t time_events_read   = 0;
   clock_t time_events_write  = 0;
@@ -279,47 +490,149 @@ Runner::processTrace( OTF2TraceReader* traceReader )
     
     time_events_read += clock() - time_tmp;
     
+    // the processes agree on the cut, as they stop at different events, and
+    // on the next cut time (the latest one, as processes without MPI 
+    // operations for a while cannot cut earlier)
+    if( time_cuts )
+    {
+      time_tmp = clock();
+      
+      uint64_t state[ 3 ];
+      state[ 0 ] = events_available ? 0 : 1;
+      state[ 1 ] = 
+        ( ( ompAnalysis && ompAnalysis->getNestingLevel() > 0 ) ||
+          ( ofldAnalysis && ofldAnalysis->getPendingKernelCount() > 0 ) ) 
+        ? 1 : 0;
+      state[ 2 ] = callbacks.getNextCutTime();
+      
+      uint64_t globalState[ 3 ] = { 0, 0, 0 };
+      MPI_CHECK( MPI_Allreduce( state, globalState, 3, MPI_UINT64_T, MPI_MAX, 
+                                MPI_COMM_WORLD ) );
+      
+      callbacks.setNextCutTime( globalState[ 2 ] );
+      
+      time_events_flush += clock() - time_tmp;
+      
+      if( globalState[ 0 ] )
+      {
+        // a process has read all its events: read the rest of the trace and
+        // run the final analysis on all processes
+        time_tmp = clock();
+        
+        while( events_available )
+        {
+          events_read = 0;
+          events_available = traceReader->readEvents( &events_read );
+          
+          totalEventsRead += events_read;
+          events_to_read += events_read;
+        }
+        
+        time_events_read += clock() - time_tmp;
+      }
+      else if( globalState[ 1 ] )
+      {
+        // a process is within an OpenMP region or waits for an offload 
+        // kernel, try again at the next cut
+#if defined(SCOREP_USER_ENABLE)
+        SCOREP_USER_REGION_END( read_handle )
+#endif
+        continue;
+      }
+      else
+      {
+        ++analysis_intervals;
+      }
+    }
     //\todo: separate function?
     // for interval analysis
     // invokes global blocking collective
-    if( events_available )
+    else if( events_available )
     {
       time_tmp = clock();
       
       bool start_analysis = false;
       
-      uint64_t last_node_id = 0;
+      // get the last node's ID
+      uint64_t last_node_id = analysis.getGraph().getNodes().back()->getId();
       uint64_t current_pending_nodes = 0;
-        
-      // if the global collective is within an OpenMP region or an offload 
-      // kernel is pending we cannot start an intermediate analysis
-      if( ( ompAnalysis && ompAnalysis->getNestingLevel() > 0 ) ||
-          ( ofldAnalysis && ofldAnalysis->getPendingKernelCount() > 0 ) )
+      
+      if( memory_limit )
       {
-        //UTILS_OUT( "Found pending local region" );
-        // invalidate pending nodes
-        current_pending_nodes = UINT64_MAX;
+        // assume that the events until the next global collective need at 
+        // most as much memory as the largest growth so far
+        uint64_t memory_usage = 
+          analysis.getMemoryUsage() + eventBuffer.getBytes();
+        
+        if( memory_usage > last_memory_usage )
+        {
+          max_memory_growth = std::max( max_memory_growth, 
+                                        memory_usage - last_memory_usage );
+        }
+        last_memory_usage = memory_usage;
+        
+        current_pending_nodes = memory_usage + max_memory_growth;
       }
       else
       {
-        // get the last node's ID
-        last_node_id = analysis.getGraph().getNodes().back()->getId();
+        current_pending_nodes = last_node_id - interval_node_id;
+      }
+      
+      // threshold in bytes or nodes
+      const uint64_t threshold = 
+        memory_limit ? memory_limit : options.analysisInterval;
+      
+      if( !cut_requested )
+      {
+#if MPI_VERSION >= 3
+        // evaluate the reduction that has been started at the previous global
+        // collective (usually completed while reading)
+        if( pending_request != MPI_REQUEST_NULL )
+        {
+          MPI_CHECK( MPI_Wait( &pending_request, MPI_STATUS_IGNORE ) );
+          
+          cut_requested = threshold < max_pending;
+        }
+        
+        // start the reduction for this global collective
+        if( !cut_requested )
+        {
+          local_pending = current_pending_nodes;
+          MPI_CHECK( MPI_Iallreduce( &local_pending, &max_pending, 1, 
+                                     MPI_UINT64_T, MPI_MAX, MPI_COMM_WORLD, 
+                                     &pending_request ) );
+        }
+#else
+        local_pending = current_pending_nodes;
+        MPI_CHECK( MPI_Allreduce( &local_pending, &max_pending, 1, 
+                                  MPI_UINT64_T, MPI_MAX, MPI_COMM_WORLD ) );
         
-        current_pending_nodes = last_node_id - interval_node_id;        
+        cut_requested = threshold < max_pending;
+#endif
       }
       
-      // \todo: this is expensive, because we execute an MPI_Allreduce for every 
-      // global collective in the trace to gather the maximum pending nodes on all processes
-      uint64_t maxNodes = 0;
-      MPI_CHECK( MPI_Allreduce( &current_pending_nodes, &maxNodes, 1, 
-                                MPI_UINT64_T, MPI_MAX, MPI_COMM_WORLD ) );
-
-      if ( options.analysisInterval < maxNodes && UINT64_MAX != maxNodes )
+      // check whether all processes can start an intermediate analysis 
+      // (only for requested cuts)
+      if( cut_requested )
       {
-        start_analysis = true;
+        // if the global collective is within an OpenMP region or an offload 
+        // kernel is pending we cannot start an intermediate analysis
+        int blocked = 
+          ( ( ompAnalysis && ompAnalysis->getNestingLevel() > 0 ) ||
+            ( ofldAnalysis && ofldAnalysis->getPendingKernelCount() > 0 ) ) 
+          ? 1 : 0;
+        int globalBlocked = 0;
+        MPI_CHECK( MPI_Allreduce( &blocked, &globalBlocked, 1, MPI_INT, 
+                                  MPI_MAX, MPI_COMM_WORLD ) );
         
-        // set a new interval begin node ID
-        interval_node_id = last_node_id;
+        if( !globalBlocked )
+        {
+          start_analysis = true;
+          cut_requested  = false;
+          
+          // set a new interval begin node ID
+          interval_node_id = last_node_id;
+        }
       }
       
       time_events_flush += clock() - time_tmp;
@@ -360,9 +673,20 @@ Runner::processTrace( OTF2TraceReader* traceReader )
     }
     
     time_tmp = clock();
+    
+    // the remote nodes are removed during the critical path detection
+    if( graphStore )
+    {
+      storeRemoteNodes();
+    }
 
     // initiate the detection of the critical path
     computeCriticalPath( analysis_intervals <= 1, !events_available );
+    
+    if( graphStore )
+    {
+      storeGraph();
+    }
 
     //\todo: needed?
     /*if ( analysis_intervals > 1 && events_available )
@@ -385,8 +709,21 @@ Runner::processTrace( OTF2TraceReader* traceReader )
       otf2_def_written = true;
     }
 
+    if( options.pipelineWrite )
+    {
+      // the writer task of the previous interval has to be finished, before
+      // this interval is handed over
+      if( finishIntervalWrite() )
+      {
+        startIntervalWrite( events_to_read );
+      }
+      else
+      {
+        events_available = false;
+      }
+    }
     // writes the OTF2 event streams and computes blame for CPU functions
-    if( writer->writeLocations( events_to_read ) != events_to_read )
+    else if( writer->writeLocations( events_to_read ) != events_to_read )
     {
       UTILS_OUT( "[%d] Reader and writer are not synchronous! Aborting ...", 
                  mpiRank );
@@ -401,16 +738,36 @@ Runner::processTrace( OTF2TraceReader* traceReader )
     // deletes all previous nodes and create an intermediate start point
     if( events_available )
     {
-      // create intermediate graph (reset and clear graph objects)
+      // create intermediate graph (reset and clear graph objects), the graph
+      // objects are deleted after the writer task is done
       time_tmp = clock();
       //writer->clearOpenEdges(); // debugging
-      analysis.createIntermediateBegin();
+      analysis.createIntermediateBegin( options.pipelineWrite );
       time_events_flush += clock() - time_tmp;
+      
+      // memory that is kept for the next interval
+      last_memory_usage = analysis.getMemoryUsage() + eventBuffer.getBytes();
     }
     
     //MPI_CHECK( MPI_Barrier( MPI_COMM_WORLD ) );
   } while( events_available );
   
+  // wait for the writer task of the last interval
+  if( options.pipelineWrite )
+  {
+    clock_t time_tmp = clock();
+    finishIntervalWrite();
+    time_events_write += clock() - time_tmp;
+  }
+  
+#if MPI_VERSION >= 3
+  // complete the reduction of the last global collective
+  if( pending_request != MPI_REQUEST_NULL )
+  {
+    MPI_CHECK( MPI_Wait( &pending_request, MPI_STATUS_IGNORE ) );
+  }
+#endif
+  
   // write the last device idle leave events
   writer->finalizeStreams();
   
@@ -474,6 +831,135 @@ Runner::processTrace( OTF2TraceReader* traceReader )
                                              analysis.getStreamGroup().getNumDevices() );
 }
 
+/**
+ * Add the remote MPI partners of the local nodes of the current interval to
+ * the graph store. A blocking MPI operation has waited for the remote node.
+ */
+void
+Runner::storeRemoteNodes()
+{
+  MPIAnalysis& mpiAnalysis = analysis.getMPIAnalysis();
+  
+  const Graph::NodeList& nodes = analysis.getGraph().getNodes();
+  for( Graph::NodeList::const_iterator iter = nodes.begin(); 
+       iter != nodes.end(); ++iter )
+  {
+    if( !( *iter )->isMPI() )
+    {
+      continue;
+    }
+    
+    bool valid = false;
+    MPIAnalysis::RemoteNode remote = 
+      mpiAnalysis.getRemoteNodeInfo( *iter, &valid );
+    
+    if( valid )
+    {
+      graphStore->addRemoteNode( ( *iter )->getId(), remote.streamID, 
+                                 remote.nodeID );
+    }
+  }
+}
+
+/**
+ * Append the nodes and edges of the current interval (with critical path 
+ * flags and blame) to the graph store.
+ */
+void
+Runner::storeGraph()
+{
+  const Graph::NodeList& nodes = analysis.getGraph().getNodes();
+  for( Graph::NodeList::const_iterator iter = nodes.begin(); 
+       iter != nodes.end(); ++iter )
+  {
+    graphStore->addNode( *iter );
+    
+    const AdjacencyList& outEdges = ( *iter )->getOutEdgeList();
+    for( AdjacencyList::const_iterator eIter = outEdges.begin(); 
+         eIter != outEdges.end(); ++eIter )
+    {
+      graphStore->addEdge( *eIter );
+    }
+  }
+  
+  graphStore->flush();
+}
+
+/**
+ * Hand the current analysis interval over to the trace writer and write it in
+ * an OpenMP task (with --pipeline-write). The writer state is prepared on the
+ * calling thread, as it needs MPI. The nodes and edges of the interval must 
+ * not be deleted until finishIntervalWrite() is called.
+ * 
+ * @param eventsToWrite number of events of the interval
+ */
+void
+Runner::startIntervalWrite( uint64_t eventsToWrite )
+{
+  // the events of this interval are replayed by the writer, the reader 
+  // continues with an empty buffer
+  writeEventBuffer.swap( eventBuffer );
+  
+  writer->prepareLocations();
+  
+  pendingWriteEvents = eventsToWrite;
+  
+  #pragma omp task
+  {
+    try
+    {
+      writtenEvents = writer->writeEvents( pendingWriteEvents );
+    }
+    catch( std::exception& e )
+    {
+      writeFailed = true;
+      writeError  = e.what();
+    }
+    catch( ... )
+    {
+      writeFailed = true;
+      writeError  = "unknown exception";
+    }
+  }
+}
+
+/**
+ * Wait for the writer task of the previous analysis interval (if any) and 
+ * delete the nodes and edges of that interval. An exception of the writer 
+ * task is thrown again (with its message) on the calling thread.
+ * 
+ * @return false, if the writer did not read all events
+ */
+bool
+Runner::finishIntervalWrite()
+{
+  #pragma omp taskwait
+  
+  analysis.releaseInterval();
+  
+  if( writeFailed )
+  {
+    std::string error = writeError;
+    
+    writeFailed = false;
+    writeError.clear();
+    
+    throw RTException( "[%d] Trace writer failed: %s", mpiRank, 
+                       error.c_str() );
+  }
+  
+  bool success = writtenEvents == pendingWriteEvents;
+  
+  UTILS_MSG( !success, "[%d] Reader and writer are not synchronous! Aborting ...", 
+             mpiRank );
+  
+  writtenEvents      = 0;
+  pendingWriteEvents = 0;
+  writeFailed        = false;
+  
+  return success;
+}
+
 void
 Runner::mergeActivityGroupsP2P()
 {
@@ -1338,16 +1824,13 @@ Runner::getCriticalLocalNodes( MPIAnalysis::CriticalPathSection* section,
                endLocalNode, endLocalNode->getUniqueName().c_str() );
 
     // add the critical section nodes (start leave, end enter and leave)
-    #pragma omp critical
-    {
-      criticalNodes.push_back( startNode );
-      criticalNodes.push_back( endNode );
+    criticalNodes.push_back( startNode );
+    criticalNodes.push_back( endNode );
 
-      // for enter end nodes (not atomic!) also add the leave node
-      if( endNode->isEnter() )
-      {
-        criticalNodes.push_back( endNode->getPartner() );
-      }
+    // for enter end nodes (not atomic!) also add the leave node
+    if( endNode->isEnter() )
+    {
+      criticalNodes.push_back( endNode->getPartner() );
     }
 
     return;
@@ -1361,25 +1844,17 @@ Runner::getCriticalLocalNodes( MPIAnalysis::CriticalPathSection* section,
              startLocalNode->getUniqueName().c_str(), 
              endLocalNode->getUniqueName().c_str() );
 
-  EventStream::SortedGraphNodeList sectionLocalNodes;
-  sectionLocalNodes.push_back( startNode );
+  criticalNodes.push_back( startNode );
 
-  getCriticalPathIntern( startLocalNode, endLocalNode,
-                         sectionLocalNodes );
+  getCriticalPathIntern( startLocalNode, endLocalNode, criticalNodes );
 
   // add the endNode, which is an enter node
-  sectionLocalNodes.push_back( endNode );
+  criticalNodes.push_back( endNode );
 
   // for enter end nodes (not atomic!) also add the leave node
   if ( /*endNode->isMPIFinalize() &&*/ endNode->isEnter() )
   {
-    sectionLocalNodes.push_back( endNode->getPartner() );
-  }
-
-  #pragma omp critical
-  {
-    criticalNodes.insert( criticalNodes.end(),
-                          sectionLocalNodes.begin(), sectionLocalNodes.end() );
+    criticalNodes.push_back( endNode->getPartner() );
   }
 }
 
@@ -1389,6 +1864,9 @@ Runner::getCriticalLocalNodes( MPIAnalysis::CriticalPathSection* section,
  * the critical path. 
  * 
  * This function works only for MPI sections (start and end node are MPI nodes)!
+ * 
+ * The sections are processed from the largest to the smallest with a dynamic
+ * schedule. Every thread collects its critical nodes in a separate list.
  *
  * @param sections list of critical sections for this process
  * @param criticalNodes - list of local critical nodes
@@ -1397,46 +1875,112 @@ void
 Runner::processSectionsParallel( MPIAnalysis::CriticalSectionsList& sections,
                                  EventStream::SortedGraphNodeList& criticalNodes )
 {
-  // compute all MPI-local critical sections in parallel
-  #pragma omp parallel for
+  // estimate the section size by the number of nodes that have been created
+  // between the section start and end node (node IDs are increasing)
+  std::vector< std::pair< uint64_t, uint32_t > > sectionOrder;
+  sectionOrder.reserve( sections.size() );
   for ( uint32_t i = 0; i < sections.size(); ++i )
   {
-    MPIAnalysis::CriticalPathSection* section = &( sections[i] );
+    uint64_t startId = sections[i].startNode->getId();
+    uint64_t endId   = sections[i].endNode->getId();
     
-    getCriticalLocalNodes( section, criticalNodes );
+    sectionOrder.push_back( std::make_pair( 
+      endId > startId ? endId - startId : 0, i ) );
   }
-}
-
-/**
- * Find the the last MPI node locally and the globally last MPI rank. 
- * The globally last MPI rank has the highest node time. 
- *
- * @param node the locally last MPI node
- * 
- * @return globally last MPI rank
- */
-int
-Runner::findLastMpiNode( GraphNode** localLastMpiLeave )
-{
-  uint64_t lastMpiNodeTime = 0;
-  int      lastMpiRank     = mpiRank;
   
-  // return the last MPI leave node (last MPI node has to be a leave)
-  *localLastMpiLeave = analysis.getLastGraphNode( PARADIGM_MPI );
+  // largest sections first
+  std::sort( sectionOrder.rbegin(), sectionOrder.rend() );
   
-  // get the last local MPI enter
-  GraphNode* localLastMpiEnter = (*localLastMpiLeave)->getGraphPair().first;
-  if ( localLastMpiEnter )
-  {
-    lastMpiNodeTime = localLastMpiEnter->getTime();
-  }
+  const int numSections = sectionOrder.size();
   
-  // send the enter time of the last MPI activity
-  uint64_t nodeTimes[mpiSize];
-  MPI_CHECK( MPI_Allgather( &lastMpiNodeTime, 1, MPI_UINT64_T,
-                            nodeTimes, 1, MPI_UINT64_T, MPI_COMM_WORLD ) );
-
-  // compare the enter times of the last MPI activities on each rank
+  // exceptions must not leave the parallel region, the first one is thrown 
+  // again after the region
+  bool failed = false;
+  std::string error;
+  
+  // compute all MPI-local critical sections in parallel
+  #pragma omp parallel
+  {
+    EventStream::SortedGraphNodeList threadNodes;
+    bool        threadFailed = false;
+    std::string threadError;
+    
+    #pragma omp for schedule( dynamic, 1 ) nowait
+    for ( int i = 0; i < numSections; ++i )
+    {
+      // the remaining sections of a failed thread are skipped
+      if ( threadFailed )
+      {
+        continue;
+      }
+      
+      try
+      {
+        getCriticalLocalNodes( &( sections[ sectionOrder[i].second ] ), 
+                               threadNodes );
+      }
+      catch( std::exception& e )
+      {
+        threadFailed = true;
+        threadError  = e.what();
+      }
+      catch( ... )
+      {
+        threadFailed = true;
+        threadError  = "unknown exception";
+      }
+    }
+    
+    #pragma omp critical
+    {
+      criticalNodes.insert( criticalNodes.end(),
+                            threadNodes.begin(), threadNodes.end() );
+      
+      if ( threadFailed && !failed )
+      {
+        failed = true;
+        error  = threadError;
+      }
+    }
+  }
+  
+  if ( failed )
+  {
+    throw RTException( "[%d] Critical section processing failed: %s", 
+                       mpiRank, error.c_str() );
+  }
+}
+
+/**
+ * Find the the last MPI node locally and the globally last MPI rank. 
+ * The globally last MPI rank has the highest node time. 
+ *
+ * @param node the locally last MPI node
+ * 
+ * @return globally last MPI rank
+ */
+int
+Runner::findLastMpiNode( GraphNode** localLastMpiLeave )
+{
+  uint64_t lastMpiNodeTime = 0;
+  int      lastMpiRank     = mpiRank;
+  
+  // return the last MPI leave node (last MPI node has to be a leave)
+  *localLastMpiLeave = analysis.getLastGraphNode( PARADIGM_MPI );
+  
+  // get the last local MPI enter
+  GraphNode* localLastMpiEnter = (*localLastMpiLeave)->getGraphPair().first;
+  if ( localLastMpiEnter )
+  {
+    lastMpiNodeTime = localLastMpiEnter->getTime();
+  }
+  
+  // send the enter time of the last MPI activity
+  uint64_t nodeTimes[mpiSize];
+  MPI_CHECK( MPI_Allgather( &lastMpiNodeTime, 1, MPI_UINT64_T,
+                            nodeTimes, 1, MPI_UINT64_T, MPI_COMM_WORLD ) );
+
+  // compare the enter times of the last MPI activities on each rank
   for ( int i = 0; i < mpiSize; ++i )
   {
     if ( nodeTimes[i] >= lastMpiNodeTime )
@@ -1471,448 +2015,587 @@ Runner::findLastMpiNode( GraphNode** localLastMpiLeave )
 }
 
 /**
- * Detect the critical path of the MPI sub graph and generate a list of critical
- * sections that are analyzed locally (but OpenMP parallel).
- * This routine implements a master slave concept. The master MPI nodes on the
- * process as critical until a blocking local MPI edge is found. Then it sends 
- * a message (new master) to the non-blocking communication partner using the MPI remote node
- * which has been generated during the analysis. The slaves wait for a message
- * and process their "critical MPI sections".
+ * Walk backwards through the MPI nodes of all local MPI streams (the same way
+ * the critical path would be followed) and precompute, for every MPI leave
+ * node, where a critical path that enters the stream at this node leaves the
+ * stream again. A path leaves the stream at a blocking MPI leave node with a
+ * remote node (exit) or ends at the MPI_Init enter or an atomic node.
  *
- * @param sectionsList  critical sections between MPI regions on the critical 
- *                      path will be stored in this list
- * @param criticalNodes critical nodes can be computed instead of actively 
- *                      waiting for the master
+ * @param walk     walk data that is generated
+ * @param mpiGraph MPI sub graph (intra-stream edges between MPI nodes)
  */
 void
-Runner::detectCriticalPathMPIP2P( MPIAnalysis::CriticalSectionsList& sectionList,
-                                  EventStream::SortedGraphNodeList& criticalNodes)
+Runner::buildCriticalPathWalk( CriticalPathWalk& walk, Graph* mpiGraph )
 {
-  const uint32_t NO_MSG         = 0;
-  const uint32_t PATH_FOUND_MSG = 1;
+  MPIAnalysis& mpiAnalysis = analysis.getMPIAnalysis();
   
-  const int MPI_CPA_TAG = 19;
-
-  const size_t BUFFER_SIZE = 3;
-  uint64_t sendBfr[ BUFFER_SIZE ];
-  uint64_t recvBfr[ BUFFER_SIZE ];
-
-  // decide on global last MPI node to start with
-  GraphNode* currentNode    = NULL;
-  GraphNode* lastNode       = NULL;
-  GraphNode* sectionEndNode = NULL;
-  
-  bool isMaster = false;
-  
-  // this assumes that the last MPI node is a collective and the collective rule
-  // created blocking edges for all MPI activities but the last entering one
-  currentNode = analysis.getLastGraphNode( PARADIGM_MPI );
-  if( !currentNode->isLeave() )
-  {
-    UTILS_WARNING( "[%u] Last MPI node should be a leave! %s", mpiRank,
-                   analysis.getNodeInfo( currentNode ).c_str() );
-  }
-  else
+  const EventStreamGroup::EventStreamList& streams = analysis.getHostStreams();
+  for ( EventStreamGroup::EventStreamList::const_iterator iter = streams.begin();
+        iter != streams.end(); ++iter )
   {
-    Edge* lastMPIEdge = 
-      analysis.getEdge( currentNode->getGraphPair().first, currentNode );
-    
-    // this is the master (critical path end) if the last MPI edge is not blocking
-    if( lastMPIEdge )
+    if ( !( *iter )->isMpiStream() )
     {
-      if( !lastMPIEdge->isBlocking() )
-      {
-        isMaster = true;
-        sectionEndNode = currentNode;
-      }
+      continue;
     }
-    else
+    
+    GraphNode* currentNode = ( *iter )->getLastParadigmNode( PARADIGM_MPI );
+    if ( !currentNode )
     {
-      UTILS_WARNING( "[%u] Last MPI edge not found!", mpiRank );
+      continue;
     }
-  }
-  
-/* // backup method if MPI collective rule failed
-  int  masterRank = findLastMpiNode( &currentNode );
-  if ( mpiRank == masterRank )
-  {
-    isMaster       = true;
-    sectionEndNode = currentNode;
-  }*/
-  
-  // mpiGraph is an allocated graph object with a vector of all nodes of the 
-  // given paradigm (\TODO this might be extremely memory intensive)
-  Graph* mpiGraph = analysis.getGraph( PARADIGM_MPI );
-
-  while ( true )
-  {
-    ///////////////////////////// master ////////////////////////////////
-    if ( isMaster )
+    
+    const uint32_t first = walk.nodes.size();
+    
+    while ( currentNode )
     {
-      if( !currentNode )
-      {
-        UTILS_WARNING( "[%u] CPA master: No current node! Abort CPA.", mpiRank );
-        
-        // savely abort CPA
-        // the first MPI node should be an intermediate start node or MPI_Init 
-        // enter and therefore end the critical path analysis
-        currentNode = analysis.getFirstTimedGraphNode( PARADIGM_MPI );
-        continue;
-      }
+      const uint32_t pos = walk.nodes.size();
       
-      // verbose output
-      if ( lastNode )
-      {
-        UTILS_MSG( options.verbose >= VERBOSE_ANNOY,
-                   "[%u] isMaster, currentNode = %s, lastNode = %s",
-                   mpiRank, analysis.getNodeInfo( currentNode ).c_str(),
-                   analysis.getNodeInfo( lastNode ).c_str() );
-      }
-      else
-      {
-        UTILS_MSG( options.verbose >= VERBOSE_ANNOY,
-                   "[%u] isMaster, currentNode = %s",
-                   mpiRank, analysis.getNodeInfo( currentNode ).c_str() );
-      }
-
-      UTILS_MSG( lastNode && ( lastNode->getId() <= currentNode->getId() ),
-                 "[%u] ! [Warning] current node ID %" PRIu64 " (%s) is not strictly "
-                 "decreasing; last node ID %" PRIu64 " (%s)", 
-                 mpiRank, currentNode->getId(), 
-                 analysis.getNodeInfo( currentNode ).c_str(),
-                 lastNode->getId(), analysis.getNodeInfo( lastNode ).c_str() );
+      walk.nodes.push_back( currentNode );
+      walk.exitIndex.push_back( UINT32_MAX );
       
-      //\todo: the intermediate begin has to be the start of a section
-      if ( currentNode->isLeave() ) // isLeave
+      if ( currentNode->isLeave() )
       {
+        walk.leavePositions[ currentNode->getId() ] = pos;
+        walk.leavePositions[ currentNode->getGraphPair().first->getId() ] = pos;
+        
         Edge* activityEdge = 
           analysis.getEdge( currentNode->getGraphPair().first, currentNode );
         
-        if( !activityEdge )
+        if ( !activityEdge )
         {
-          UTILS_WARNING( "[%u] CPA master: No activity edge found for %s. Abort CPA.", 
+          UTILS_WARNING( "[%u] CPA: No activity edge found for %s.", 
                          mpiRank, analysis.getNodeInfo( currentNode ).c_str() );
-          
-          // savely abort CPA
-          // the first MPI node should be an intermediate start node or MPI_Init 
-          // enter and therefore end the critical path analysis
-          currentNode = analysis.getFirstTimedGraphNode( PARADIGM_MPI );
-          continue;
+          break;
         }
-
-        // CP changes stream on blocking edges
+        
+        // CP changes stream on blocking edges with a remote node
         if ( activityEdge->isBlocking() )
         {
-          // therefore, create section for local processing later
-          if ( sectionEndNode && ( currentNode != sectionEndNode ) )
-          {
-            MPIAnalysis::CriticalPathSection section;
-            section.startNode = currentNode;
-            section.endNode   = sectionEndNode;
-
-            UTILS_DBG_MSG( DEBUG_CPA_MPI, "[%d] Push critical section [%s,%s]", 
-                           mpiRank, analysis.getNodeInfo( currentNode ).c_str(), 
-                           analysis.getNodeInfo( sectionEndNode ).c_str() );
-            sectionList.push_back( section );
-
-            // the leave node is still on the critical path
-            currentNode->setCounter( CRITICAL_PATH, 1 );
-          }
-
-          ///////////////// Send a message to the new master ///////////////////
           bool nodeHasRemoteInfo = false;
-          
-          // check if the given node has a remote edge (currently just check 
-          // whether the edge is available and ignore return value)
           MPIAnalysis::RemoteNode pnPair = // (stream ID, node ID)
-            analysis.getMPIAnalysis().getRemoteNodeInfo( currentNode,
-                                                         &nodeHasRemoteInfo );
+            mpiAnalysis.getRemoteNodeInfo( currentNode, &nodeHasRemoteInfo );
           
           // check enter event
-          if( !nodeHasRemoteInfo )
+          if ( !nodeHasRemoteInfo )
           {
-            pnPair = // (stream ID, node ID)
-            analysis.getMPIAnalysis().getRemoteNodeInfo( 
+            pnPair = mpiAnalysis.getRemoteNodeInfo( 
               currentNode->getGraphPair().first, &nodeHasRemoteInfo );
-            
-            // if still no remote node found, continue as master
-            if( !nodeHasRemoteInfo )
-            {
-              currentNode->setCounter( CRITICAL_PATH, 1 );
-              lastNode    = currentNode;
-              currentNode = activityEdge->getStartNode();
-              continue;
-            }
           }
           
-          UTILS_DBG_MSG( DEBUG_CPA_MPI,
-                         "[%d]  found wait state for %s, changing stream",
-                         mpiRank, analysis.getNodeInfo( currentNode ).c_str() );
-
-          // get global MPI world rank from stream ID
-          uint32_t mpiPartnerRank = 
-            analysis.getMPIAnalysis().getMPIRank( pnPair.streamID );
-                 
-          // prepare send buffer
-          sendBfr[0] = pnPair.nodeID;
-          sendBfr[1] = NO_MSG; // no specific message
-          
-          // transfer blame for MPI_Wait[all]
-          if( currentNode->isMPIWait() || currentNode->isMPIWaitall() )
+          if ( nodeHasRemoteInfo )
           {
-            sendBfr[2] = currentNode->getWaitingTime();
+            walk.exitIndex[ pos ] = walk.exits.size();
+            walk.exits.push_back( pos );
+            walk.exitPartners.push_back( pnPair );
           }
-          else
-          {
-            sendBfr[2] = 0;
-          }
-
-          UTILS_DBG_MSG( DEBUG_CPA_MPI,
-                         "[%d]  testing remote MPI worker %u for remote edge to"
-                         " my node %" PRIu64 " on stream %" PRIu64,
-                         mpiRank, mpiPartnerRank, sendBfr[0], sendBfr[1] );
-
-          // send a message to the 
-          MPI_CHECK( MPI_Send( sendBfr, BUFFER_SIZE, MPI_UINT64_T,
-                               mpiPartnerRank, MPI_CPA_TAG, MPI_COMM_WORLD ) );
-
-          // continue main loop as slave
-          isMaster = false;
-          sectionEndNode = NULL;
-          
-          // remove remote node entry
-          analysis.getMPIAnalysis().removeRemoteNode( currentNode );
-        }
-        else // non-blocking edge
-        {
-          currentNode->setCounter( CRITICAL_PATH, 1 );
-          lastNode    = currentNode;
-          currentNode = activityEdge->getStartNode();
-          // continue main loop as master
         }
-      } /* END: currentNode->isLeave() */
-      else // isEnter (master) or isAtomic
+        
+        currentNode = activityEdge->getStartNode();
+      }
+      else // isEnter or isAtomic
       {
-        // found the MPI_Init enter or an atomic node (e.g. the intermediate begin)
+        // the MPI_Init enter or an atomic node (e.g. the intermediate begin)
+        // ends the critical path
         if ( currentNode->isMPIInit() || currentNode->isAtomic() )
         {
-          // create critical section for intermediate begin
-          if ( sectionEndNode && ( currentNode != sectionEndNode ) )
-          {
-            MPIAnalysis::CriticalPathSection section;
-            section.startNode = currentNode;
-            section.endNode   = sectionEndNode;
-
-            UTILS_DBG_MSG( DEBUG_CPA_MPI,  
-                           "[%d] Push critical section [%s,%s] (MPI_Init/atomic)", 
-                           mpiRank, analysis.getNodeInfo( currentNode ).c_str(), 
-                           analysis.getNodeInfo( sectionEndNode ).c_str() );
-            sectionList.push_back( section );
-          }
-          else if ( currentNode->isMPIInit() )
-          {
-            // add MPI_Init enter to critical nodes, as it is on the CP and needs 
-            // to be considered for global times
-            criticalNodes.push_back( currentNode );
-          }
-          
-          currentNode->setCounter( CRITICAL_PATH, 1 );
-
-          // notify all slaves that we are done
-          UTILS_MSG( options.verbose >= VERBOSE_BASIC && !options.analysisInterval, 
-                     "[%d] Critical path reached global collective %s. "
-                     "Asking all slaves to terminate", mpiRank, 
-                     analysis.getNodeInfo( currentNode ).c_str() );
-
-          // send "path found" message to all ranks
-          sendBfr[0] = 0;
-          sendBfr[1] = PATH_FOUND_MSG;
-
-          // get all MPI ranks
-          std::vector< uint32_t > mpiPartners =
-            analysis.getMPIAnalysis().getMPICommGroup( 0 ).procs;
-          
-          for ( std::vector< uint32_t >::const_iterator iter = mpiPartners.begin();
-                iter != mpiPartners.end(); ++iter )
-          {
-            int commMpiRank = analysis.getMPIAnalysis().getMPIRank( *iter );
-            
-            // ignore own rank
-            if ( commMpiRank == mpiRank )
-            {
-              continue;
-            }
-
-            MPI_CHECK( MPI_Send( sendBfr, BUFFER_SIZE, MPI_UINT64_T,
-                                 commMpiRank, MPI_CPA_TAG, MPI_COMM_WORLD ) );
-          }
-
-          // leave main loop
           break;
         }
-
-        // master: find previous MPI node on the same stream
-        bool foundPredecessor = false;
+        
+        // find previous MPI node on the same stream
+        GraphNode* predecessor = NULL;
         
         const Graph::EdgeList& inEdges = mpiGraph->getInEdges( currentNode );
-        for ( Graph::EdgeList::const_iterator iter = inEdges.begin();
-              iter != inEdges.end(); ++iter )
+        for ( Graph::EdgeList::const_iterator eIter = inEdges.begin();
+              eIter != inEdges.end(); ++eIter )
         {
-          Edge* intraEdge = *iter;
-          if ( intraEdge->isIntraStreamEdge() )
+          if ( ( *eIter )->isIntraStreamEdge() )
           {
-            currentNode->setCounter( CRITICAL_PATH, 1 );
-            
-            lastNode         = currentNode;
-            currentNode      = intraEdge->getStartNode();
-            foundPredecessor = true;
-            
-            // continue main loop as master 
+            predecessor = ( *eIter )->getStartNode();
             break;
           }
         }
+        
+        currentNode = predecessor;
+      }
+    }
+    
+    // a walk that starts at a leave node ends at the next exit below or at 
+    // the last node of the stream
+    uint32_t nextEnd = walk.nodes.size() - 1;
+    walk.segmentEnd.resize( walk.nodes.size() );
+    for ( uint32_t pos = walk.nodes.size(); pos > first; --pos )
+    {
+      walk.segmentEnd[ pos - 1 ] = nextEnd;
+      
+      if ( walk.exitIndex[ pos - 1 ] != UINT32_MAX )
+      {
+        nextEnd = pos - 1;
+      }
+    }
+  }
+}
 
-        if ( !foundPredecessor )
-        {
-          throw RTException( "[%d] No ingoing intra-stream edge for node %s",
-                             mpiRank, analysis.getNodeInfo( currentNode ).c_str() );
-        }
-      } // END: isEnter (master)
-    } ///////////////////////////// END: master ////////////////////////////////
-    else
+/**
+ * Exchange records of 64-bit values with all analysis processes. Every
+ * record has to contain all information that the receiver needs (e.g. the
+ * rank of the sender).
+ *
+ * @param sendRecords values per destination rank (cleared afterwards)
+ * @param recvRecords values from all ranks (ordered by the source rank)
+ */
+void
+Runner::exchangeRecords( std::vector< std::vector< uint64_t > >& sendRecords,
+                         std::vector< uint64_t >& recvRecords )
+{
+  std::vector< int > sendCounts( mpiSize ), recvCounts( mpiSize );
+  std::vector< int > sendDispls( mpiSize ), recvDispls( mpiSize );
+  
+  for ( int rank = 0; rank < mpiSize; ++rank )
+  {
+    sendCounts[ rank ] = sendRecords[ rank ].size();
+  }
+  
+  MPI_CHECK( MPI_Alltoall( &sendCounts[0], 1, MPI_INT, 
+                           &recvCounts[0], 1, MPI_INT, MPI_COMM_WORLD ) );
+  
+  int sendTotal = 0, recvTotal = 0;
+  for ( int rank = 0; rank < mpiSize; ++rank )
+  {
+    sendDispls[ rank ] = sendTotal;
+    recvDispls[ rank ] = recvTotal;
+    sendTotal += sendCounts[ rank ];
+    recvTotal += recvCounts[ rank ];
+  }
+  
+  // one additional element to have valid buffers for empty exchanges
+  std::vector< uint64_t > sendBuffer;
+  sendBuffer.reserve( sendTotal + 1 );
+  for ( int rank = 0; rank < mpiSize; ++rank )
+  {
+    sendBuffer.insert( sendBuffer.end(), 
+                       sendRecords[ rank ].begin(), sendRecords[ rank ].end() );
+    sendRecords[ rank ].clear();
+  }
+  sendBuffer.resize( sendTotal + 1 );
+  
+  recvRecords.resize( recvTotal + 1 );
+  
+  MPI_CHECK( MPI_Alltoallv( &sendBuffer[0], &sendCounts[0], &sendDispls[0],
+                            MPI_UINT64_T, 
+                            &recvRecords[0], &recvCounts[0], &recvDispls[0],
+                            MPI_UINT64_T, MPI_COMM_WORLD ) );
+  
+  recvRecords.resize( recvTotal );
+}
+
+/**
+ * Mark the MPI nodes of a critical path segment on a local stream and create
+ * the critical section for the local processing. The segment starts at the
+ * given leave node and ends at the next exit (blocking MPI leave with a remote
+ * node), the MPI_Init enter or an atomic node below.
+ *
+ * @param walk          precomputed walk data
+ * @param entry         position of the leave node, where the path enters
+ * @param sectionList   list of critical sections
+ * @param criticalNodes list of critical nodes
+ */
+void
+Runner::processCriticalSegment( CriticalPathWalk& walk, uint32_t entry,
+                                MPIAnalysis::CriticalSectionsList& sectionList,
+                                EventStream::SortedGraphNodeList& criticalNodes )
+{
+  const uint32_t end = walk.segmentEnd[ entry ];
+  
+  GraphNode* sectionEndNode = walk.nodes[ entry ];
+  GraphNode* currentNode    = walk.nodes[ end ];
+  
+  for ( uint32_t pos = entry; pos <= end; ++pos )
+  {
+    walk.nodes[ pos ]->setCounter( CRITICAL_PATH, 1 );
+  }
+  
+  if ( walk.exitIndex[ end ] != UINT32_MAX )
+  {
+    MPIAnalysis::CriticalPathSection section;
+    section.startNode = currentNode;
+    section.endNode   = sectionEndNode;
+
+    UTILS_DBG_MSG( DEBUG_CPA_MPI, "[%d] Push critical section [%s,%s]", 
+                   mpiRank, analysis.getNodeInfo( currentNode ).c_str(), 
+                   analysis.getNodeInfo( sectionEndNode ).c_str() );
+    sectionList.push_back( section );
+    
+    // remove remote node entry
+    analysis.getMPIAnalysis().removeRemoteNode( currentNode );
+  }
+  else if ( currentNode->isMPIInit() || currentNode->isAtomic() )
+  {
+    // create critical section for intermediate begin
+    if ( currentNode != sectionEndNode )
     {
-      //////////////////////////////// slave ////////////////////////////////
-      UTILS_DBG_MSG( DEBUG_CPA_MPI, "[%d] Slave receives... ", mpiRank);
+      MPIAnalysis::CriticalPathSection section;
+      section.startNode = currentNode;
+      section.endNode   = sectionEndNode;
+
+      UTILS_DBG_MSG( DEBUG_CPA_MPI,  
+                     "[%d] Push critical section [%s,%s] (MPI_Init/atomic)", 
+                     mpiRank, analysis.getNodeInfo( currentNode ).c_str(), 
+                     analysis.getNodeInfo( sectionEndNode ).c_str() );
+      sectionList.push_back( section );
+    }
+    else if ( currentNode->isMPIInit() )
+    {
+      // add MPI_Init enter to critical nodes, as it is on the CP and needs 
+      // to be considered for global times
+      criticalNodes.push_back( currentNode );
+    }
+    
+    UTILS_MSG( options.verbose >= VERBOSE_BASIC && !options.analysisInterval, 
+               "[%d] Critical path reached global collective %s", mpiRank, 
+               analysis.getNodeInfo( currentNode ).c_str() );
+  }
+  else
+  {
+    throw RTException( "[%d] No ingoing intra-stream edge for node %s",
+                       mpiRank, analysis.getNodeInfo( currentNode ).c_str() );
+  }
+}
 
-      // use a non-blocking MPI receive to start local CPA meanwhile
-      MPI_Request request_recv = MPI_REQUEST_NULL;
-      int finished = 0;
-      MPI_CHECK( MPI_Irecv( recvBfr, BUFFER_SIZE, MPI_UINT64_T, MPI_ANY_SOURCE,
-                            MPI_CPA_TAG, MPI_COMM_WORLD, &request_recv ) );
+/**
+ * Detect the critical path of the MPI sub graph and generate a list of critical
+ * sections that are analyzed locally (but OpenMP parallel).
+ * 
+ * All analysis processes precompute for their MPI nodes where a critical path
+ * that enters a stream continues (see buildCriticalPathWalk()). The local exits
+ * (blocking MPI leave nodes with a remote node) are linked to the next exit
+ * on the partner stream. The exits on the global critical path are found by 
+ * pointer jumping over these links, which needs O(log n) collective exchanges
+ * for a path with n stream changes (instead of passing a token along the path). 
+ * Finally, every process creates the critical sections for the path segments
+ * on its streams.
+ *
+ * @param sectionsList  critical sections between MPI regions on the critical 
+ *                      path will be stored in this list
+ * @param criticalNodes critical nodes (e.g. MPI_Init) are added to this list
+ */
+void
+Runner::detectCriticalPathMPIP2P( MPIAnalysis::CriticalSectionsList& sectionList,
+                                  EventStream::SortedGraphNodeList& criticalNodes)
+{
+  // (analysis rank, exit index) of an exit, ranks of non-exits are UINT32_MAX
+  typedef std::pair< uint32_t, uint64_t > ExitRef;
+  typedef std::vector< ExitRef > ExitRefList;
+  
+  const ExitRef NO_EXIT( UINT32_MAX, UINT64_MAX );
+  
+  MPIAnalysis& mpiAnalysis = analysis.getMPIAnalysis();
+  
+  // decide on global last MPI node to start with
+  GraphNode* currentNode = NULL;
+  
+  bool isMaster = false;
+  
+  // this assumes that the last MPI node is a collective and the collective rule
+  // created blocking edges for all MPI activities but the last entering one
+  currentNode = analysis.getLastGraphNode( PARADIGM_MPI );
+  
+  // with several MPI ranks per analysis process, the globally last MPI leave
+  // is on the stream that entered the last collective at last (non-blocking)
+  if( mpiAnalysis.isMultiRankMode() )
+  {
+    const EventStreamGroup::EventStreamList& streams = 
+      analysis.getHostStreams();
+    for( EventStreamGroup::EventStreamList::const_iterator iter = 
+           streams.begin(); iter != streams.end(); ++iter )
+    {
+      if( !( *iter )->isMpiStream() )
+      {
+        continue;
+      }
       
-      MPI_Status status;
-      MPI_CHECK( MPI_Test( &request_recv, &finished, &status ) );
-
-      // if we have to wait for the master, start the local CPA for sections
-      while( !finished )
+      GraphNode* streamLastNode = 
+        ( *iter )->getLastParadigmNode( PARADIGM_MPI );
+      if( streamLastNode && streamLastNode->isLeave() )
       {
-        if( sectionList.size() > 0 )
+        Edge* streamLastEdge = analysis.getEdge( 
+          streamLastNode->getGraphPair().first, streamLastNode );
+        if( streamLastEdge && !streamLastEdge->isBlocking() )
         {
-          // compute last local critical section (last element in the vector)
-          getCriticalLocalNodes( &(sectionList.back()), criticalNodes );
-          sectionList.pop_back();
-          
-          // check if the receive is now finished
-          MPI_CHECK( MPI_Test( &request_recv, &finished, &status ) );
-        }
-        else
-        {
-          // if no more sections are available: 
-          // wait for the MPI_Irecv and leave the loop
-          MPI_CHECK( MPI_Wait( &request_recv, &status ) );
-          finished = 1;
+          currentNode = streamLastNode;
           break;
         }
       }
-      
-      // if the master send "found message" we can leave the while loop
-      if ( recvBfr[1] == PATH_FOUND_MSG )
+    }
+  }
+  
+  // intervals that are cut by time do not end with a global collective, the 
+  // path ends at the MPI activity that has been entered last
+  if( Parser::getOptions().timeInterval > 0 )
+  {
+    isMaster = ( findLastMpiNode( &currentNode ) == mpiRank );
+  }
+  else if( !currentNode->isLeave() )
+  {
+    UTILS_WARNING( "[%u] Last MPI node should be a leave! %s", mpiRank,
+                   analysis.getNodeInfo( currentNode ).c_str() );
+  }
+  else
+  {
+    Edge* lastMPIEdge = 
+      analysis.getEdge( currentNode->getGraphPair().first, currentNode );
+    
+    // this is the master (critical path end) if the last MPI edge is not blocking
+    if( lastMPIEdge )
+    {
+      if( !lastMPIEdge->isBlocking() )
+      {
+        isMaster = true;
+      }
+    }
+    else
+    {
+      UTILS_WARNING( "[%u] Last MPI edge not found!", mpiRank );
+    }
+  }
+  
+  // mpiGraph is an allocated graph object with a vector of all nodes of the 
+  // given paradigm (\TODO this might be extremely memory intensive)
+  Graph* mpiGraph = analysis.getGraph( PARADIGM_MPI );
+  
+  CriticalPathWalk walk;
+  buildCriticalPathWalk( walk, mpiGraph );
+  
+  // allocated before and not bound to any other object
+  delete mpiGraph;
+  
+  const uint64_t numExits = walk.exits.size();
+  
+  std::vector< std::vector< uint64_t > > sendRecords( mpiSize );
+  std::vector< uint64_t > recvRecords;
+  
+  ////////////// link every local exit to the next exit of the path /////////////
+  
+  // request (requesting rank, exit index, partner node ID)
+  for ( uint64_t i = 0; i < numExits; ++i )
+  {
+    const MPIAnalysis::RemoteNode& partner = walk.exitPartners[ i ];
+    uint32_t partnerRank = mpiAnalysis.getAnalysisRank( 
+      mpiAnalysis.getMPIRank( partner.streamID ) );
+    
+    sendRecords[ partnerRank ].push_back( mpiRank );
+    sendRecords[ partnerRank ].push_back( i );
+    sendRecords[ partnerRank ].push_back( partner.nodeID );
+  }
+  
+  exchangeRecords( sendRecords, recvRecords );
+  
+  // reply (exit index, rank of the next exit, next exit index)
+  for ( size_t i = 0; i < recvRecords.size(); i += 3 )
+  {
+    ExitRef next = NO_EXIT;
+    
+    std::map< uint64_t, uint32_t >::const_iterator posIter = 
+      walk.leavePositions.find( recvRecords[ i + 2 ] );
+    if ( posIter != walk.leavePositions.end() )
+    {
+      uint32_t end = walk.segmentEnd[ posIter->second ];
+      if ( walk.exitIndex[ end ] != UINT32_MAX )
+      {
+        next = ExitRef( mpiRank, walk.exitIndex[ end ] );
+      }
+    }
+    else
+    {
+      UTILS_WARNING( "[%d] CPA: Node ID %" PRIu64 " not found! Send from %" 
+                     PRIu64, mpiRank, recvRecords[ i + 2 ], recvRecords[ i ] );
+    }
+    
+    sendRecords[ recvRecords[ i ] ].push_back( recvRecords[ i + 1 ] );
+    sendRecords[ recvRecords[ i ] ].push_back( next.first );
+    sendRecords[ recvRecords[ i ] ].push_back( next.second );
+  }
+  
+  exchangeRecords( sendRecords, recvRecords );
+  
+  // jumps[ k ][ i ] is the 2^k-th successor of exit i
+  std::vector< ExitRefList > jumps( 1, ExitRefList( numExits, NO_EXIT ) );
+  for ( size_t i = 0; i < recvRecords.size(); i += 3 )
+  {
+    jumps[ 0 ][ recvRecords[ i ] ] = 
+      ExitRef( recvRecords[ i + 1 ], recvRecords[ i + 2 ] );
+  }
+  
+  //////////////////////////// pointer jumping //////////////////////////////
+  
+  // a path visits every exit at most once, so ceil(log2(#exits)) + 1 rounds 
+  // are sufficient, more rounds are only needed for cyclic successor links
+  uint64_t localExits  = numExits;
+  uint64_t globalExits = 0;
+  MPI_CHECK( MPI_Allreduce( &localExits, &globalExits, 1, MPI_UINT64_T, MPI_SUM,
+                            MPI_COMM_WORLD ) );
+  
+  size_t maxRounds = 1;
+  for ( uint64_t n = 1; n < globalExits; n <<= 1 )
+  {
+    maxRounds++;
+  }
+  
+  while ( true )
+  {
+    const ExitRefList& jump = jumps.back();
+    
+    int active = 0;
+    for ( uint64_t i = 0; i < numExits; ++i )
+    {
+      if ( jump[ i ].first != UINT32_MAX )
       {
-        UTILS_MSG( options.verbose >= VERBOSE_ALL,
-                   "[%d] * terminate requested by master", mpiRank );
+        active = 1;
         break;
       }
-      
-      // ID of the next critical path node (send from remote rank)
-      uint64_t nextNodeID = recvBfr[0];
-   
-      // find local node for remote node id and decide if we can continue here
-      UTILS_DBG_MSG( DEBUG_CPA_MPI,
-                     "[%u]  tested by remote MPI worker %u for node %" PRIu64,
-                     mpiRank, status.MPI_SOURCE,
-                     nextNodeID ); // continuation node ID
-
-      const Graph::NodeList& nodes = mpiGraph->getNodes();
-      
-      // binary search for continuation node
-      GraphNode* slaveLeaveNode = 
-        GraphNode::findNode( nextNodeID, nodes );
-
-      //////// if the node could not be found, do a sequential search //////////
-      if( !slaveLeaveNode || slaveLeaveNode->getId() != nextNodeID )
+    }
+    
+    int globalActive = 0;
+    MPI_CHECK( MPI_Allreduce( &active, &globalActive, 1, MPI_INT, MPI_MAX,
+                              MPI_COMM_WORLD ) );
+    
+    // the successors of all exits are beyond the end of their path
+    if ( !globalActive )
+    {
+      break;
+    }
+    
+    // the result of the allreduce is the same on all processes
+    if ( jumps.size() > maxRounds )
+    {
+      throw RTException( "[%d] CPA: Pointer jumping did not terminate after "
+                         "%llu rounds (%llu exits). The exits form a cycle.",
+                         mpiRank, ( unsigned long long )maxRounds, 
+                         ( unsigned long long )globalExits );
+    }
+    
+    // request (requesting rank, exit index, successor exit index)
+    for ( uint64_t i = 0; i < numExits; ++i )
+    {
+      if ( jump[ i ].first != UINT32_MAX )
       {
-        // reset slaveNode
-        slaveLeaveNode = NULL;
-
-        // sequential search 
-        for( Graph::NodeList::const_iterator iter = nodes.begin();
-             iter != nodes.end(); ++iter )
-        {
-          if( (*iter)->getId() == nextNodeID )
-          {
-            slaveLeaveNode = ( *iter );
-            break;
-          }
-        }
-
-        if( !slaveLeaveNode )
-        {
-          if( nextNodeID < nodes.front()->getId() )
-          {
-            UTILS_WARNING( "[%d] Node ID %" PRIu64 " is out of range "
-                           "[%" PRIu64 ",%" PRIu64 "]! Send from %d",
-                           mpiRank, nextNodeID, nodes.front()->getId(), 
-                           nodes.back()->getId(), status.MPI_SOURCE );
-          }
-          else
-          {
-            UTILS_WARNING( "[%d] Sequential search for node ID %" PRIu64 " failed!",
-                           mpiRank, nextNodeID );
-          }
-          
-          //UTILS_WARNING( "[%d] Continue at first local MPI node %s",
-          //               mpiRank, analysis.getNodeInfo( slaveLeaveNode ).c_str() );
-          //slaveLeaveNode = mpiGraph->getNodes().front();
-        }
+        sendRecords[ jump[ i ].first ].push_back( mpiRank );
+        sendRecords[ jump[ i ].first ].push_back( i );
+        sendRecords[ jump[ i ].first ].push_back( jump[ i ].second );
       }
-      //////////////////////////////////////////////////////////////////////////
+    }
+    
+    exchangeRecords( sendRecords, recvRecords );
+    
+    // reply (exit index, rank and index of the successor's successor)
+    for ( size_t i = 0; i < recvRecords.size(); i += 3 )
+    {
+      const ExitRef& next = jump[ recvRecords[ i + 2 ] ];
       
-      // set slave leave and enter node
-      slaveLeaveNode = slaveLeaveNode->getGraphPair().second;
-      GraphNode* slaveEnterNode = slaveLeaveNode->getGraphPair().first;
+      sendRecords[ recvRecords[ i ] ].push_back( recvRecords[ i + 1 ] );
+      sendRecords[ recvRecords[ i ] ].push_back( next.first );
+      sendRecords[ recvRecords[ i ] ].push_back( next.second );
+    }
+    
+    exchangeRecords( sendRecords, recvRecords );
+    
+    ExitRefList nextJump( numExits, NO_EXIT );
+    for ( size_t i = 0; i < recvRecords.size(); i += 3 )
+    {
+      nextJump[ recvRecords[ i ] ] = 
+        ExitRef( recvRecords[ i + 1 ], recvRecords[ i + 2 ] );
+    }
+    
+    jumps.push_back( nextJump );
+  }
+  
+  UTILS_MSG( mpiRank == 0 && options.verbose >= VERBOSE_SOME,
+             "[0] Critical path stitched in %llu pointer jumping rounds", 
+             jumps.size() );
+  
+  ///////////////// mark the exits on the critical path //////////////////////
+  
+  std::vector< uint32_t > entries;
+  std::vector< bool > onPath( numExits, false );
+  
+  if ( isMaster )
+  {
+    std::map< uint64_t, uint32_t >::const_iterator posIter = 
+      walk.leavePositions.find( currentNode->getId() );
+    if ( posIter != walk.leavePositions.end() )
+    {
+      entries.push_back( posIter->second );
       
-      // \todo:
-      /*if( recvBfr[2] > 0 )
+      uint32_t end = walk.segmentEnd[ posIter->second ];
+      if ( walk.exitIndex[ end ] != UINT32_MAX )
       {
-        distributeBlame( &analysis,
-                       slaveEnterNode,
-                       0,
-                       mpi::streamWalkCallback );
-      }*/
-
-      //this rank is the new master
-      isMaster = true;
-      slaveLeaveNode->setCounter( CRITICAL_PATH, 1 );
-
-      lastNode       = slaveLeaveNode;
-      currentNode    = slaveEnterNode;
-      sectionEndNode = lastNode;
-
-      UTILS_DBG_MSG( DEBUG_CPA_MPI,
-                     "[%u] becomes new master at node %s, lastNode = %s\n",
-                     mpiRank,
-                     analysis.getNodeInfo( currentNode ).c_str(),
-                     analysis.getNodeInfo( lastNode ).c_str() );
-
-      // continue main loop as master
+        onPath[ walk.exitIndex[ end ] ] = true;
+      }
+    }
+    else
+    {
+      UTILS_WARNING( "[%u] CPA: Last MPI node %s not found!", mpiRank,
+                     analysis.getNodeInfo( currentNode ).c_str() );
     }
   }
   
-  // allocated before this loop and not bound to any other object
-  delete mpiGraph;
-
-  // make sure that every process is leaving
-  MPI_CHECK( MPI_Barrier( MPI_COMM_WORLD ) );
+  // after round k, all exits within 2^k successors of a marked exit are marked
+  for ( size_t k = jumps.size(); k > 0; --k )
+  {
+    const ExitRefList& jump = jumps[ k - 1 ];
+    
+    for ( uint64_t i = 0; i < numExits; ++i )
+    {
+      if ( onPath[ i ] && jump[ i ].first != UINT32_MAX )
+      {
+        sendRecords[ jump[ i ].first ].push_back( jump[ i ].second );
+      }
+    }
+    
+    exchangeRecords( sendRecords, recvRecords );
+    
+    for ( size_t i = 0; i < recvRecords.size(); ++i )
+    {
+      onPath[ recvRecords[ i ] ] = true;
+    }
+  }
+  
+  // the path continues at the partner nodes of the critical exits
+  for ( uint64_t i = 0; i < numExits; ++i )
+  {
+    if ( onPath[ i ] )
+    {
+      const MPIAnalysis::RemoteNode& partner = walk.exitPartners[ i ];
+      uint32_t partnerRank = mpiAnalysis.getAnalysisRank( 
+        mpiAnalysis.getMPIRank( partner.streamID ) );
+      
+      sendRecords[ partnerRank ].push_back( partner.nodeID );
+    }
+  }
+  
+  exchangeRecords( sendRecords, recvRecords );
+  
+  for ( size_t i = 0; i < recvRecords.size(); ++i )
+  {
+    std::map< uint64_t, uint32_t >::const_iterator posIter = 
+      walk.leavePositions.find( recvRecords[ i ] );
+    if ( posIter != walk.leavePositions.end() )
+    {
+      entries.push_back( posIter->second );
+    }
+    else
+    {
+      UTILS_WARNING( "[%d] CPA: Node ID %" PRIu64 " not found!", mpiRank,
+                     recvRecords[ i ] );
+    }
+  }
+  
+  //////////////////// create the local critical sections ////////////////////
+  
+  for ( std::vector< uint32_t >::const_iterator iter = entries.begin();
+        iter != entries.end(); ++iter )
+  {
+    processCriticalSegment( walk, *iter, sectionList, criticalNodes );
+  }
 }
 
 /**
@@ -2283,15 +2966,19 @@ Runner::writeActivityRating()
     ///////////////// some more statistics ///////////////
     Statistics& stats = analysis.getStatistics();
     
+    // number of MPI ranks in the trace (can be larger than mpiSize)
+    const int numRanks = 
+      ( int ) analysis.getMPIAnalysis().getNumTracedRanks();
+    
     // print stream summary to console
-    fprintf( sFile, "\nStream summary: %d MPI rank", mpiSize);
-    if( mpiSize > 1)
+    fprintf( sFile, "\nStream summary: %d MPI rank", numRanks);
+    if( numRanks > 1)
     {
       fprintf( sFile, "s" );
     }
     
     uint64_t num_streams = stats.getActivityCounts()[ STAT_HOST_STREAMS ];
-    if( mpiSize < (int)num_streams)
+    if( numRanks < (int)num_streams)
     {
       fprintf( sFile, ", %" PRIu64 " host stream", num_streams );
       if( num_streams > 1 )
@@ -2326,10 +3013,10 @@ Runner::writeActivityRating()
     if( stats.getActivityCounts()[ STAT_HOST_STREAMS ] > 1 )
     {
       fprintf( sFile, " (" );
-      if( mpiSize > 1 )
+      if( numRanks > 1 )
       {
         fprintf( sFile, "%lf s per rank, ",
-                 analysis.getRealTime( sumWaitingTime ) / mpiSize );
+                 analysis.getRealTime( sumWaitingTime ) / numRanks );
       }
       
       fprintf( sFile, 
@@ -2343,7 +3030,8 @@ Runner::writeActivityRating()
               );
     }
 
-    if( mpiSize > 1 )
+    // min/max waiting times are per analysis process (not per rank in M:N mode)
+    if( mpiSize > 1 && !analysis.getMPIAnalysis().isMultiRankMode() )
     {
       const char* minNode = this->definitions.getNodeName( this->minWtimeRank );
       const char* maxNode = this->definitions.getNodeName( this->maxWtimeRank );
@@ -2384,7 +3072,7 @@ Runner::writeActivityRating()
       
       fprintf( sFile, " %-30.30s: %11lf s (%lf s per rank; %" PRIu64 " overall occurrences)\n",
               "MPI wait patterns",
-              ptime, ptime/(double)analysis.getMPISize(), patternCount );
+              ptime, ptime/(double)numRanks, patternCount );
     }
                             
     patternCount = stats.getStats()[MPI_STAT_LATE_SENDER];
@@ -2394,7 +3082,7 @@ Runner::writeActivityRating()
           analysis.getRealTime( stats.getStats()[MPI_STAT_LATE_SENDER_WTIME] );
       fprintf( sFile, " %-30.30s: %11lf s (%lf s per rank; %" PRIu64 " overall occurrences)\n",
               " Late sender", 
-              ptime, ptime/(double)analysis.getMPISize(), patternCount );
+              ptime, ptime/(double)numRanks, patternCount );
     }
     
     patternCount = stats.getStats()[ MPI_STAT_LATE_RECEIVER ];
@@ -2404,7 +3092,7 @@ Runner::writeActivityRating()
           analysis.getRealTime( stats.getStats()[MPI_STAT_LATE_RECEIVER_WTIME] );
       fprintf( sFile, " %-30.30s: %11lf s (%lf s per rank; %" PRIu64 " overall occurrences)\n",
               " Late receiver",
-              ptime, ptime/(double)analysis.getMPISize(), patternCount );
+              ptime, ptime/(double)numRanks, patternCount );
     }
     
     patternCount = stats.getStats()[MPI_STAT_SENDRECV];
@@ -2414,7 +3102,7 @@ Runner::writeActivityRating()
           analysis.getRealTime( stats.getStats()[MPI_STAT_SENDRECV_WTIME] );
       fprintf( sFile, " %-30.30s: %11lf s (%lf s per rank; %" PRIu64 " overall occurrences)\n",
               " Wait in MPI_Sendrecv",
-              ptime, ptime/(double)analysis.getMPISize(), patternCount );
+              ptime, ptime/(double)numRanks, patternCount );
     }
     
     patternCount = stats.getStats()[ MPI_STAT_WAITALL_LATEPARTNER ];
@@ -2424,7 +3112,7 @@ Runner::writeActivityRating()
           analysis.getRealTime( stats.getStats()[MPI_STAT_WAITALL_LATEPARTNER_WTIME] );
       fprintf( sFile, " %-30.30s: %11lf s (%lf s per rank; %" PRIu64 " overall occurrences)\n",
               " MPI_Waitall late partner",
-              ptime, ptime/(double)analysis.getMPISize(), patternCount );
+              ptime, ptime/(double)numRanks, patternCount );
     }
     
     patternCount = stats.getStats()[ MPI_STAT_COLLECTIVE ];
@@ -2434,7 +3122,7 @@ Runner::writeActivityRating()
           analysis.getRealTime( stats.getStats()[MPI_STAT_COLLECTIVE_WTIME] );
       fprintf( sFile, " %-30.30s: %11lf s (%lf s per rank; %" PRIu64 " overall occurrences)\n",
               " Wait in MPI collective",
-              ptime, ptime/(double)analysis.getMPISize(), patternCount );
+              ptime, ptime/(double)numRanks, patternCount );
     }
     
     //// OpenMP ////
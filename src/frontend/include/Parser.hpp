@@ -28,6 +28,7 @@ namespace casita
    string      inFileName;
    bool        createTraceFile;
    string      outFileName;
+   bool        metricsOnly;
    bool        replaceCASITAoutput;
    bool        createRatingCSV;
    size_t      topX;
@@ -46,6 +47,14 @@ namespace casita
    bool        propagateBlame;
    bool        extendedBlame;
    uint32_t    analysisInterval;
+   uint32_t    memoryLimit;
+   double      timeInterval;
+   uint32_t    eventBufferSize;
+   bool        parallelRead;
+   string      traceCache;
+   string      graphStore;
+   bool        bulkP2P;
+   bool        pipelineWrite;
    int         verbose;
    int         eventsProcessed;
  } ProgramOptions;
@@ -29,6 +29,7 @@
 #include "Parser.hpp"
 #include "AnalysisEngine.hpp"
 #include "CallbackHandler.hpp"
+#include "GraphStore.hpp"
 #include "otf/OTF2DefinitionHandler.hpp"
 #include "otf/OTF2TraceReader.hpp"
 #include "otf/OTF2ParallelTraceWriter.hpp"
@@ -162,6 +163,24 @@ namespace casita
      //<! summarizes and writes the analysis results
      io::OTF2ParallelTraceWriter* writer;
      
+     //<! analyzed graph of all intervals (NULL, if not stored)
+     GraphStore* graphStore;
+     
+     //<! events of the current interval for the trace writer
+     io::OTF2EventBuffer eventBuffer;
+     
+     //<! events of the interval that is written (with --pipeline-write)
+     io::OTF2EventBuffer writeEventBuffer;
+     
+     //!< events of the interval that is written and events that have been 
+     //!< written by the writer task (with --pipeline-write)
+     uint64_t pendingWriteEvents;
+     uint64_t writtenEvents;
+     bool     writeFailed;
+     
+     //!< message of the exception of the writer task
+     std::string writeError;
+     
      //!< class members to determine the critical path length
      uint64_t globalLengthCP;
      
@@ -171,6 +190,26 @@ namespace casita
      
      uint64_t totalEventsRead;
      
+     //!< local MPI nodes in the order of the critical path detection
+     typedef struct
+     {
+       //!< MPI nodes of all local MPI streams (each stream backwards in time)
+       std::vector< GraphNode* > nodes;
+       
+       //!< position where a path that enters at a leave node leaves the stream
+       std::vector< uint32_t > segmentEnd;
+       
+       //!< index of the exit at a position (UINT32_MAX, if it is not an exit)
+       std::vector< uint32_t > exitIndex;
+       
+       //!< positions and remote nodes of the exits (blocking with remote node)
+       std::vector< uint32_t > exits;
+       std::vector< MPIAnalysis::RemoteNode > exitPartners;
+       
+       //!< enter and leave node IDs -> position of the leave node
+       std::map< uint64_t, uint32_t > leavePositions;
+     } CriticalPathWalk;
+     
      /////// \todo: only used on rank 0 /////
      uint64_t maxWaitingTime;
      uint64_t minWaitingTime;
@@ -189,6 +228,21 @@ namespace casita
       */
      void
      processTrace( OTF2TraceReader* traceReader );
+     
+     void
+     processIntervals( OTF2TraceReader* traceReader );
+     
+     void
+     startIntervalWrite( uint64_t eventsToWrite );
+     
+     bool
+     finishIntervalWrite();
+     
+     void
+     storeRemoteNodes();
+     
+     void
+     storeGraph();
 
      /* critical path */
      void
@@ -218,6 +272,18 @@ namespace casita
 
      int
      findLastMpiNode( GraphNode** node );
+     
+     void
+     buildCriticalPathWalk( CriticalPathWalk& walk, Graph* mpiGraph );
+     
+     void
+     exchangeRecords( std::vector< std::vector< uint64_t > >& sendRecords,
+                      std::vector< uint64_t >& recvRecords );
+     
+     void
+     processCriticalSegment( CriticalPathWalk& walk, uint32_t entry,
+                             MPIAnalysis::CriticalSectionsList& sectionList,
+                             EventStream::SortedGraphNodeList& criticalNodes );
 
      void
      detectCriticalPathMPIP2P( MPIAnalysis::CriticalSectionsList& sectionsList,
@@ -0,0 +1,658 @@
+/*
+ * This file is part of the CASITA software
+ *
+ * Copyright (c) 2019,
+ * Technische Universitaet Dresden, Germany
+ *
+ * This software may be modified and distributed under the terms of
+ * a BSD-style license. See the COPYING file in the package base
+ * directory for details.
+ *
+ * What this file does:
+ * This file contains the main routine of the merge utility.
+ * - read an input trace and the CASITA metrics overlay (casita --metrics-only)
+ * - write a single OTF2 archive with the events of both traces
+ *
+ */
+
+// the following definition and include is needed for the printf PRIu64 macro
+#define __STDC_FORMAT_MACROS
+#include <inttypes.h>
+#include <string.h>
+
+#include <otf2/otf2.h>
+#include <map>
+#include <vector>
+#include <string>
+
+#include "common.hpp"
+#include "utils/Utils.hpp"
+#include "otf/OTF2EventBuffer.hpp"
+#include "otf/OTF2ParallelEventReader.hpp"
+
+using namespace casita;
+using namespace casita::io;
+
+#define OTF2_CHECK( cmd ) \
+  { \
+   int _status = cmd; \
+   if ( _status ) \
+   { throw RTException( "OTF2 command '%s' returned error %d", #cmd, _status );} \
+  }
+
+typedef std::vector< OTF2_LocationRef > LocationList;
+
+static OTF2_FlushType
+preFlush( void* userData, OTF2_FileType fileType,
+          OTF2_LocationRef location, void* callerData, bool final )
+{
+  return OTF2_FLUSH;
+}
+
+static OTF2_TimeStamp
+postFlush( void* userData, OTF2_FileType fileType,
+           OTF2_LocationRef location )
+{
+  return 0;
+}
+
+static OTF2_FlushCallbacks flushCallbacks = { preFlush, postFlush };
+
+/*
+ * Callbacks to copy the global definitions of the overlay archive. The overlay
+ * contains all definitions of the input trace and the CASITA metrics. Every
+ * callback has the definition copy data as user data.
+ */
+
+typedef struct
+{
+  OTF2_GlobalDefWriter* defWriter;
+  LocationList*         locations; //!< all locations of the trace
+} DefinitionCopyData;
+
+static OTF2_GlobalDefWriter*
+getDefWriter( void* userData )
+{
+  return ( ( DefinitionCopyData* )userData )->defWriter;
+}
+
+static OTF2_CallbackCode
+copyClockProperties( void* userData, uint64_t timerResolution,
+                     uint64_t globalOffset, uint64_t traceLength )
+{
+  OTF2_CHECK( OTF2_GlobalDefWriter_WriteClockProperties(
+    getDefWriter( userData ), timerResolution, globalOffset,
+    traceLength ) );
+  return OTF2_CALLBACK_SUCCESS;
+}
+
+static OTF2_CallbackCode
+copyString( void* userData, OTF2_StringRef self, const char* string )
+{
+  OTF2_CHECK( OTF2_GlobalDefWriter_WriteString(
+    getDefWriter( userData ), self, string ) );
+  return OTF2_CALLBACK_SUCCESS;
+}
+
+static OTF2_CallbackCode
+copySystemTreeNode( void* userData, OTF2_SystemTreeNodeRef self,
+                    OTF2_StringRef name, OTF2_StringRef className,
+                    OTF2_SystemTreeNodeRef parent )
+{
+  OTF2_CHECK( OTF2_GlobalDefWriter_WriteSystemTreeNode(
+    getDefWriter( userData ), self, name, className, parent ) );
+  return OTF2_CALLBACK_SUCCESS;
+}
+
+static OTF2_CallbackCode
+copySystemTreeNodeProperty( void* userData,
+                            OTF2_SystemTreeNodeRef systemTreeNode,
+                            OTF2_StringRef name, OTF2_Type type,
+                            OTF2_AttributeValue value )
+{
+  OTF2_CHECK( OTF2_GlobalDefWriter_WriteSystemTreeNodeProperty(
+    getDefWriter( userData ), systemTreeNode, name, type, value ) );
+  return OTF2_CALLBACK_SUCCESS;
+}
+
+static OTF2_CallbackCode
+copySystemTreeNodeDomain( void* userData, OTF2_SystemTreeNodeRef systemTreeNode,
+                          OTF2_SystemTreeDomain systemTreeDomain )
+{
+  OTF2_CHECK( OTF2_GlobalDefWriter_WriteSystemTreeNodeDomain(
+    getDefWriter( userData ), systemTreeNode, systemTreeDomain ) );
+  return OTF2_CALLBACK_SUCCESS;
+}
+
+static OTF2_CallbackCode
+copyLocationGroup( void* userData, OTF2_LocationGroupRef self,
+                   OTF2_StringRef name, OTF2_LocationGroupType locationGroupType,
+                   OTF2_SystemTreeNodeRef systemTreeParent )
+{
+  OTF2_CHECK( OTF2_GlobalDefWriter_WriteLocationGroup(
+    getDefWriter( userData ), self, name, locationGroupType,
+    systemTreeParent ) );
+  return OTF2_CALLBACK_SUCCESS;
+}
+
+static OTF2_CallbackCode
+copyRegion( void* userData, OTF2_RegionRef self, OTF2_StringRef name,
+            OTF2_StringRef cannonicalName, OTF2_StringRef description,
+            OTF2_RegionRole regionRole, OTF2_Paradigm paradigm,
+            OTF2_RegionFlag regionFlags, OTF2_StringRef sourceFile,
+            uint32_t beginLineNumber, uint32_t endLineNumber )
+{
+  OTF2_CHECK( OTF2_GlobalDefWriter_WriteRegion(
+    getDefWriter( userData ), self, name, cannonicalName, description,
+    regionRole, paradigm, regionFlags, sourceFile, beginLineNumber,
+    endLineNumber ) );
+  return OTF2_CALLBACK_SUCCESS;
+}
+
+static OTF2_CallbackCode
+copyGroup( void* userData, OTF2_GroupRef self, OTF2_StringRef name,
+           OTF2_GroupType groupType, OTF2_Paradigm paradigm,
+           OTF2_GroupFlag groupFlags, uint32_t numberOfMembers,
+           const uint64_t* members )
+{
+  OTF2_CHECK( OTF2_GlobalDefWriter_WriteGroup(
+    getDefWriter( userData ), self, name, groupType, paradigm,
+    groupFlags, numberOfMembers, members ) );
+  return OTF2_CALLBACK_SUCCESS;
+}
+
+static OTF2_CallbackCode
+copyComm( void* userData, OTF2_CommRef self, OTF2_StringRef name,
+          OTF2_GroupRef group, OTF2_CommRef parent )
+{
+  OTF2_CHECK( OTF2_GlobalDefWriter_WriteComm(
+    getDefWriter( userData ), self, name, group, parent ) );
+  return OTF2_CALLBACK_SUCCESS;
+}
+
+static OTF2_CallbackCode
+copyAttribute( void* userData, OTF2_AttributeRef self, OTF2_StringRef name,
+               OTF2_StringRef description, OTF2_Type type )
+{
+  OTF2_CHECK( OTF2_GlobalDefWriter_WriteAttribute(
+    getDefWriter( userData ), self, name, description, type ) );
+  return OTF2_CALLBACK_SUCCESS;
+}
+
+static OTF2_CallbackCode
+copyMetricMember( void* userData, OTF2_MetricMemberRef self,
+                  OTF2_StringRef name, OTF2_StringRef description,
+                  OTF2_MetricType metricType, OTF2_MetricMode metricMode,
+                  OTF2_Type valueType, OTF2_Base base, int64_t exponent,
+                  OTF2_StringRef unit )
+{
+  OTF2_CHECK( OTF2_GlobalDefWriter_WriteMetricMember(
+    getDefWriter( userData ), self, name, description, metricType,
+    metricMode, valueType, base, exponent, unit ) );
+  return OTF2_CALLBACK_SUCCESS;
+}
+
+static OTF2_CallbackCode
+copyMetricClass( void* userData, OTF2_MetricRef self, uint8_t numberOfMetrics,
+                 const OTF2_MetricMemberRef* metricMembers,
+                 OTF2_MetricOccurrence metricOccurrence,
+                 OTF2_RecorderKind recorderKind )
+{
+  OTF2_CHECK( OTF2_GlobalDefWriter_WriteMetricClass(
+    getDefWriter( userData ), self, numberOfMetrics, metricMembers,
+    metricOccurrence, recorderKind ) );
+  return OTF2_CALLBACK_SUCCESS;
+}
+
+static OTF2_CallbackCode
+copyMetricInstance( void* userData, OTF2_MetricRef self,
+                    OTF2_MetricRef metricClass, OTF2_LocationRef recorder,
+                    OTF2_MetricScope metricScope, uint64_t scope )
+{
+  OTF2_CHECK( OTF2_GlobalDefWriter_WriteMetricInstance(
+    getDefWriter( userData ), self, metricClass, recorder,
+    metricScope, scope ) );
+  return OTF2_CALLBACK_SUCCESS;
+}
+
+static OTF2_CallbackCode
+copyRmaWin( void* userData, OTF2_RmaWinRef self, OTF2_StringRef name,
+            OTF2_CommRef comm )
+{
+  OTF2_CHECK( OTF2_GlobalDefWriter_WriteRmaWin(
+    getDefWriter( userData ), self, name, comm ) );
+  return OTF2_CALLBACK_SUCCESS;
+}
+
+static OTF2_CallbackCode
+copyLocation( void* userData, OTF2_LocationRef self, OTF2_StringRef name,
+              OTF2_LocationType locationType, uint64_t numberOfEvents,
+              OTF2_LocationGroupRef locationGroup )
+{
+  DefinitionCopyData* data = ( DefinitionCopyData* )userData;
+
+  OTF2_CHECK( OTF2_GlobalDefWriter_WriteLocation( data->defWriter, self, name,
+                                                  locationType, numberOfEvents,
+                                                  locationGroup ) );
+  data->locations->push_back( self );
+
+  return OTF2_CALLBACK_SUCCESS;
+}
+
+/**
+ * Copy the global definitions of the overlay archive to the merged archive.
+ *
+ * @param reader reader of the overlay archive
+ * @param defWriter global definition writer of the merged archive
+ * @param locations list of all locations (filled)
+ */
+static void
+copyGlobalDefinitions( OTF2_Reader* reader, OTF2_GlobalDefWriter* defWriter,
+                       LocationList& locations )
+{
+  OTF2_GlobalDefReader* defReader = OTF2_Reader_GetGlobalDefReader( reader );
+
+  OTF2_GlobalDefReaderCallbacks* callbacks = OTF2_GlobalDefReaderCallbacks_New();
+
+  OTF2_GlobalDefReaderCallbacks_SetClockPropertiesCallback( callbacks,
+                                                      &copyClockProperties );
+  OTF2_GlobalDefReaderCallbacks_SetStringCallback( callbacks, &copyString );
+  OTF2_GlobalDefReaderCallbacks_SetSystemTreeNodeCallback( callbacks,
+                                                      &copySystemTreeNode );
+  OTF2_GlobalDefReaderCallbacks_SetSystemTreeNodePropertyCallback( callbacks,
+                                                &copySystemTreeNodeProperty );
+  OTF2_GlobalDefReaderCallbacks_SetSystemTreeNodeDomainCallback( callbacks,
+                                                  &copySystemTreeNodeDomain );
+  OTF2_GlobalDefReaderCallbacks_SetLocationGroupCallback( callbacks,
+                                                          &copyLocationGroup );
+  OTF2_GlobalDefReaderCallbacks_SetLocationCallback( callbacks, &copyLocation );
+  OTF2_GlobalDefReaderCallbacks_SetRegionCallback( callbacks, &copyRegion );
+  OTF2_GlobalDefReaderCallbacks_SetGroupCallback( callbacks, &copyGroup );
+  OTF2_GlobalDefReaderCallbacks_SetCommCallback( callbacks, &copyComm );
+  OTF2_GlobalDefReaderCallbacks_SetAttributeCallback( callbacks,
+                                                      &copyAttribute );
+  OTF2_GlobalDefReaderCallbacks_SetMetricMemberCallback( callbacks,
+                                                         &copyMetricMember );
+  OTF2_GlobalDefReaderCallbacks_SetMetricClassCallback( callbacks,
+                                                        &copyMetricClass );
+  OTF2_GlobalDefReaderCallbacks_SetMetricInstanceCallback( callbacks,
+                                                       &copyMetricInstance );
+  OTF2_GlobalDefReaderCallbacks_SetRmaWinCallback( callbacks, &copyRmaWin );
+
+  DefinitionCopyData data;
+  data.defWriter = defWriter;
+  data.locations = &locations;
+
+  OTF2_Reader_RegisterGlobalDefCallbacks( reader, defReader, callbacks, &data );
+  OTF2_GlobalDefReaderCallbacks_Delete( callbacks );
+
+  uint64_t definitionsRead = 0;
+  OTF2_CHECK( OTF2_Reader_ReadAllGlobalDefinitions( reader, defReader,
+                                                    &definitionsRead ) );
+  OTF2_Reader_CloseGlobalDefReader( reader, defReader );
+
+  UTILS_OUT( "Copied %" PRIu64 " global definitions", definitionsRead );
+}
+
+/**
+ * Write a buffered event record to the given OTF2 event writer. The generic
+ * event fields are used as in the OTF2 trace reader callbacks.
+ *
+ * @param writer OTF2 event writer of the event location
+ * @param event buffered event
+ * @param buffer buffer that contains attributes and metric values of the event
+ * @param attributes attribute list that is used to write the event
+ */
+static void
+writeEvent( OTF2_EvtWriter* writer, const BufferedEvent& event,
+            const OTF2EventBuffer& buffer, OTF2_AttributeList* attributes )
+{
+  buffer.getAttributes( event, attributes );
+
+  switch( event.type )
+  {
+    case BUFFERED_ENTER:
+      OTF2_CHECK( OTF2_EvtWriter_Enter( writer, attributes, event.time,
+                                        event.ref ) );
+      break;
+
+    case BUFFERED_LEAVE:
+      OTF2_CHECK( OTF2_EvtWriter_Leave( writer, attributes, event.time,
+                                        event.ref ) );
+      break;
+
+    case BUFFERED_THREAD_FORK:
+      OTF2_CHECK( OTF2_EvtWriter_ThreadFork( writer, attributes, event.time,
+                                             ( OTF2_Paradigm ) event.tag,
+                                             event.partner ) );
+      break;
+
+    case BUFFERED_THREAD_JOIN:
+      OTF2_CHECK( OTF2_EvtWriter_ThreadJoin( writer, attributes, event.time,
+                                             ( OTF2_Paradigm ) event.tag ) );
+      break;
+
+    case BUFFERED_THREAD_TEAM_BEGIN:
+      OTF2_CHECK( OTF2_EvtWriter_ThreadTeamBegin( writer, attributes,
+                                                  event.time, event.ref ) );
+      break;
+
+    case BUFFERED_THREAD_TEAM_END:
+      OTF2_CHECK( OTF2_EvtWriter_ThreadTeamEnd( writer, attributes,
+                                                event.time, event.ref ) );
+      break;
+
+    case BUFFERED_METRIC:
+      OTF2_CHECK( OTF2_EvtWriter_Metric( writer, attributes, event.time,
+                                         event.ref, ( uint8_t ) event.dataCount,
+                                         buffer.getMetricTypes( event ),
+                                         buffer.getMetricValues( event ) ) );
+      break;
+
+    case BUFFERED_MPI_SEND:
+      OTF2_CHECK( OTF2_EvtWriter_MpiSend( writer, attributes, event.time,
+                                          event.partner, event.ref, event.tag,
+                                          event.size ) );
+      break;
+
+    case BUFFERED_MPI_RECV:
+      OTF2_CHECK( OTF2_EvtWriter_MpiRecv( writer, attributes, event.time,
+                                          event.partner, event.ref, event.tag,
+                                          event.size ) );
+      break;
+
+    case BUFFERED_MPI_ISEND:
+      OTF2_CHECK( OTF2_EvtWriter_MpiIsend( writer, attributes, event.time,
+                                           event.partner, event.ref, event.tag,
+                                           event.size, event.id ) );
+      break;
+
+    case BUFFERED_MPI_ISEND_COMPLETE:
+      OTF2_CHECK( OTF2_EvtWriter_MpiIsendComplete( writer, attributes,
+                                                   event.time, event.id ) );
+      break;
+
+    case BUFFERED_MPI_IRECV:
+      OTF2_CHECK( OTF2_EvtWriter_MpiIrecv( writer, attributes, event.time,
+                                           event.partner, event.ref, event.tag,
+                                           event.size, event.id ) );
+      break;
+
+    case BUFFERED_MPI_IRECV_REQUEST:
+      OTF2_CHECK( OTF2_EvtWriter_MpiIrecvRequest( writer, attributes,
+                                                  event.time, event.id ) );
+      break;
+
+    case BUFFERED_MPI_COLLECTIVE_BEGIN:
+      OTF2_CHECK( OTF2_EvtWriter_MpiCollectiveBegin( writer, attributes,
+                                                     event.time ) );
+      break;
+
+    case BUFFERED_MPI_COLLECTIVE_END:
+      OTF2_CHECK( OTF2_EvtWriter_MpiCollectiveEnd( writer, attributes,
+        event.time, ( OTF2_CollectiveOp ) event.tag, event.ref, event.partner,
+        event.size, event.id ) );
+      break;
+
+    case BUFFERED_RMA_WIN_CREATE:
+      OTF2_CHECK( OTF2_EvtWriter_RmaWinCreate( writer, attributes, event.time,
+                                               event.ref ) );
+      break;
+
+    case BUFFERED_RMA_WIN_DESTROY:
+      OTF2_CHECK( OTF2_EvtWriter_RmaWinDestroy( writer, attributes, event.time,
+                                                event.ref ) );
+      break;
+
+    case BUFFERED_RMA_PUT:
+      OTF2_CHECK( OTF2_EvtWriter_RmaPut( writer, attributes, event.time,
+                                         event.ref, event.partner, event.size,
+                                         event.id ) );
+      break;
+
+    case BUFFERED_RMA_GET:
+      OTF2_CHECK( OTF2_EvtWriter_RmaGet( writer, attributes, event.time,
+                                         event.ref, event.partner, event.size,
+                                         event.id ) );
+      break;
+
+    case BUFFERED_RMA_OP_COMPLETE_BLOCKING:
+      OTF2_CHECK( OTF2_EvtWriter_RmaOpCompleteBlocking( writer, attributes,
+                                                        event.time, event.ref,
+                                                        event.id ) );
+      break;
+
+    default:
+      UTILS_WARNING( "Unknown buffered event type %d", ( int ) event.type );
+  }
+}
+
+/**
+ * Check whether the overlay event has to be written before the input event.
+ * The trace writer writes the CASITA counters before the event they belong to.
+ * Enter events of the overlay (device idle regions) are written after the
+ * input events with the same time stamp (e.g. after a device task leave).
+ *
+ * @param overlayEvent next event of the overlay archive
+ * @param inputEvent next event of the input trace
+ *
+ * @return true, if the overlay event is written first
+ */
+static bool
+overlayFirst( const BufferedEvent& overlayEvent,
+              const BufferedEvent& inputEvent )
+{
+  if( overlayEvent.time != inputEvent.time )
+  {
+    return overlayEvent.time < inputEvent.time;
+  }
+
+  return overlayEvent.type != BUFFERED_ENTER;
+}
+
+/**
+ * Open an OTF2 archive for reading.
+ *
+ * @param fileName OTF2 anchor file
+ *
+ * @return the OTF2 reader
+ */
+static OTF2_Reader*
+openReader( const char* fileName )
+{
+  OTF2_Reader* reader = OTF2_Reader_Open( fileName );
+
+  if( !reader )
+  {
+    throw RTException( "Failed to open OTF2 trace file %s", fileName );
+  }
+
+  OTF2_CHECK( OTF2_Reader_SetSerialCollectiveCallbacks( reader ) );
+
+  return reader;
+}
+
+/**
+ * Select the locations and open the event readers. The local definitions
+ * (e.g. mapping tables) are read, if available.
+ *
+ * @param reader the OTF2 reader
+ * @param locations the locations to be read
+ * @param readLocalDefs true, to read the local definitions
+ */
+static void
+openEventReaders( OTF2_Reader* reader, const LocationList& locations,
+                  bool readLocalDefs )
+{
+  for( LocationList::const_iterator it = locations.begin();
+       it != locations.end(); ++it )
+  {
+    OTF2_Reader_SelectLocation( reader, *it );
+  }
+
+  OTF2_Reader_OpenEvtFiles( reader );
+
+  if( readLocalDefs )
+  {
+    OTF2_Reader_OpenDefFiles( reader );
+  }
+
+  for( LocationList::const_iterator it = locations.begin();
+       it != locations.end(); ++it )
+  {
+    if( readLocalDefs )
+    {
+      OTF2_DefReader* defReader = OTF2_Reader_GetDefReader( reader, *it );
+      if( defReader )
+      {
+        uint64_t defReads = 0;
+        OTF2_Reader_ReadAllLocalDefinitions( reader, defReader, &defReads );
+        OTF2_Reader_CloseDefReader( reader, defReader );
+      }
+    }
+
+    OTF2_Reader_GetEvtReader( reader, *it );
+  }
+
+  if( readLocalDefs )
+  {
+    OTF2_Reader_CloseDefFiles( reader );
+  }
+}
+
+static void
+printUsage()
+{
+  UTILS_OUT( "Usage: casita-merge <input-trace> <overlay-trace> <output-dir> "
+             "[archive-name]\n\n"
+             "Merge the CASITA metrics overlay (casita --metrics-only) with its "
+             "input trace\ninto a single OTF2 archive (default archive name: "
+             "traces)." );
+}
+
+int
+main( int argc, char** argv )
+{
+  if( argc < 4 || argc > 5 || strcmp( argv[ 1 ], "-h" ) == 0 ||
+      strcmp( argv[ 1 ], "--help" ) == 0 )
+  {
+    printUsage();
+    return argc == 2 ? 0 : 1;
+  }
+
+  const char* inputFile   = argv[ 1 ];
+  const char* overlayFile = argv[ 2 ];
+  const char* outputDir   = argv[ 3 ];
+  const char* archiveName = ( argc == 5 ) ? argv[ 4 ] : "traces";
+
+  try
+  {
+    OTF2_Reader* inputReader   = openReader( inputFile );
+    OTF2_Reader* overlayReader = openReader( overlayFile );
+
+    OTF2_Archive* archive = OTF2_Archive_Open( outputDir, archiveName,
+                                               OTF2_FILEMODE_WRITE,
+                                               1024 * 1024, 4 * 1024 * 1024,
+                                               OTF2_SUBSTRATE_POSIX,
+                                               OTF2_COMPRESSION_NONE );
+    if( !archive )
+    {
+      throw RTException( "Failed to create OTF2 archive %s/%s", outputDir,
+                         archiveName );
+    }
+
+    OTF2_CHECK( OTF2_Archive_SetFlushCallbacks( archive, &flushCallbacks,
+                                                NULL ) );
+    OTF2_CHECK( OTF2_Archive_SetSerialCollectiveCallbacks( archive ) );
+
+    // the overlay contains all global definitions of the input trace
+    LocationList locations;
+    copyGlobalDefinitions( overlayReader,
+                           OTF2_Archive_GetGlobalDefWriter( archive ),
+                           locations );
+
+    openEventReaders( inputReader, locations, true );
+    openEventReaders( overlayReader, locations, false );
+
+    OTF2_CHECK( OTF2_Archive_OpenEvtFiles( archive ) );
+
+    std::map< OTF2_LocationRef, OTF2_EvtWriter* > evtWriters;
+
+    OTF2ParallelEventReader inputEvents( inputReader );
+    OTF2ParallelEventReader overlayEvents( overlayReader );
+
+    for( LocationList::const_iterator it = locations.begin();
+         it != locations.end(); ++it )
+    {
+      evtWriters[ *it ] = OTF2_Archive_GetEvtWriter( archive, *it );
+
+      inputEvents.addLocation( *it, true, true, true, true );
+      overlayEvents.addLocation( *it, true, true, true, true );
+    }
+
+    OTF2_AttributeList* attributes = OTF2_AttributeList_New();
+
+    const BufferedEvent*   inputEvent    = NULL;
+    const OTF2EventBuffer* inputBuffer   = NULL;
+    const BufferedEvent*   overlayEvent  = NULL;
+    const OTF2EventBuffer* overlayBuffer = NULL;
+
+    bool inputAvailable   = inputEvents.nextEvent( &inputEvent, &inputBuffer );
+    bool overlayAvailable = overlayEvents.nextEvent( &overlayEvent,
+                                                     &overlayBuffer );
+
+    uint64_t inputCount   = 0;
+    uint64_t overlayCount = 0;
+
+    // merge both event streams in time order
+    while( inputAvailable || overlayAvailable )
+    {
+      if( overlayAvailable &&
+          ( !inputAvailable || overlayFirst( *overlayEvent, *inputEvent ) ) )
+      {
+        writeEvent( evtWriters[ overlayEvent->location ], *overlayEvent,
+                    *overlayBuffer, attributes );
+        overlayCount++;
+
+        overlayAvailable = overlayEvents.nextEvent( &overlayEvent,
+                                                    &overlayBuffer );
+      }
+      else
+      {
+        writeEvent( evtWriters[ inputEvent->location ], *inputEvent,
+                    *inputBuffer, attributes );
+        inputCount++;
+
+        inputAvailable = inputEvents.nextEvent( &inputEvent, &inputBuffer );
+      }
+    }
+
+    UTILS_OUT( "Merged %" PRIu64 " input and %" PRIu64 " overlay events of "
+               "%lu locations", inputCount, overlayCount, locations.size() );
+
+    OTF2_AttributeList_Delete( attributes );
+
+    inputEvents.close();
+    overlayEvents.close();
+
+    for( std::map< OTF2_LocationRef, OTF2_EvtWriter* >::const_iterator it =
+           evtWriters.begin(); it != evtWriters.end(); ++it )
+    {
+      OTF2_Archive_CloseEvtWriter( archive, it->second );
+    }
+
+    OTF2_Archive_CloseEvtFiles( archive );
+    OTF2_CHECK( OTF2_Archive_Close( archive ) );
+
+    OTF2_Reader_CloseEvtFiles( inputReader );
+    OTF2_Reader_CloseEvtFiles( overlayReader );
+    OTF2_Reader_Close( inputReader );
+    OTF2_Reader_Close( overlayReader );
+  }
+  catch( const RTException& e )
+  {
+    return 1;
+  }
+
+  return 0;
+}
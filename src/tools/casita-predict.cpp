@@ -0,0 +1,928 @@
+/*
+ * This file is part of the CASITA software
+ *
+ * Copyright (c) 2019,
+ * Technische Universitaet Dresden, Germany
+ *
+ * This software may be modified and distributed under the terms of
+ * a BSD-style license. See the COPYING file in the package base
+ * directory for details.
+ *
+ * What this file does:
+ * This file contains the main routine of the prediction utility.
+ * - read the analyzed graphs of all analysis processes (casita --graph-store)
+ * - replay the critical path without the time of the given regions (for all
+ *   given filters in one pass over the graph)
+ * - print the predicted length and the top activities of the critical path
+ *
+ */
+
+// the following definition and include is needed for the printf PRIu64 macro
+#define __STDC_FORMAT_MACROS
+#include <inttypes.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include <algorithm>
+#include <map>
+#include <set>
+#include <vector>
+#include <string>
+
+#include "common.hpp"
+#include "utils/Utils.hpp"
+#include "GraphStore.hpp"
+
+using namespace casita;
+
+/*
+ * The stored graphs of all analysis processes are combined into one graph. The
+ * length of the critical path is the longest path through this graph, if the
+ * activities between two nodes of a stream keep their duration, wait states
+ * are reduced to zero and the remote MPI partners (which ended the wait
+ * states) keep their distance to the waiting node. The removed regions shorten
+ * the activities of their streams by the time, which they cover.
+ */
+
+enum PredictEdgeKind
+{
+  EDGE_ACTIVITY = 0,  //!< activity on a stream (shortened by removed regions)
+  EDGE_LATENCY,       //!< dependency to another stream (keeps its duration)
+  EDGE_WAIT           //!< wait state (no duration)
+};
+
+typedef struct
+{
+  uint64_t id;
+  uint64_t time;
+  uint64_t streamId;
+  bool     critical;
+} PredictNode;
+
+typedef struct
+{
+  uint32_t        from;
+  uint32_t        to;
+  PredictEdgeKind kind;
+} PredictEdge;
+
+typedef std::vector< GraphStore::RegionRecord > RegionList;
+
+/**
+ * Exclusive time of the regions on a stream (sorted, disjoint segments with
+ * the innermost region).
+ */
+typedef struct
+{
+  std::vector< uint64_t > starts;
+  std::vector< uint64_t > ends;
+  std::vector< uint32_t > regionRefs;
+} RegionSegments;
+
+typedef struct
+{
+  std::vector< PredictNode > nodes;
+  std::vector< PredictEdge > edges;
+
+  //!< in-edges of the nodes (edge indices, the edges of node i start at
+  //!< inOffsets[ i ])
+  std::vector< uint32_t > inOffsets;
+  std::vector< uint32_t > inEdges;
+
+  //!< nodes in topological order
+  std::vector< uint32_t > order;
+
+  //!< region instances and exclusive region time per stream
+  std::map< uint64_t, RegionList > streamRegions;
+  std::map< uint64_t, RegionSegments > streamSegments;
+  std::map< uint32_t, std::string > regionNames;
+
+  uint64_t criticalPathLength;
+  uint64_t timerResolution;
+  uint64_t startTime;
+} PredictionGraph;
+
+/**
+ * Union of the removed region instances on a stream (sorted, disjoint).
+ */
+typedef struct
+{
+  std::vector< uint64_t > starts;
+  std::vector< uint64_t > ends;
+
+  //!< removed time before the interval with the same index
+  std::vector< uint64_t > sums;
+} RemovedTime;
+
+typedef std::map< uint64_t, RemovedTime > RemovedTimeMap;
+
+//!< (time on the critical path, region reference)
+typedef std::vector< std::pair< uint64_t, uint32_t > > RegionTimeList;
+
+/**
+ * Prediction for a set of removed regions.
+ */
+typedef struct
+{
+  std::string    filter;
+  RemovedTimeMap removed;
+
+  //!< predicted length of the critical path
+  uint64_t       length;
+
+  //!< removed time on the stored critical path
+  uint64_t       removedOnCP;
+
+  //!< regions with the most time on the predicted critical path
+  RegionTimeList topRegions;
+} Scenario;
+
+/**
+ * Get the removed time of a stream before the given time.
+ */
+static uint64_t
+getRemovedBefore( const RemovedTime& removed, uint64_t time )
+{
+  size_t pos = std::upper_bound( removed.starts.begin(), removed.starts.end(),
+                                 time ) - removed.starts.begin();
+  if( pos == 0 )
+  {
+    return 0;
+  }
+
+  --pos;
+  return removed.sums[ pos ] +
+         std::min( time, removed.ends[ pos ] ) - removed.starts[ pos ];
+}
+
+static uint64_t
+getRemovedTime( const RemovedTimeMap& removedMap, uint64_t streamId,
+                uint64_t start, uint64_t end )
+{
+  RemovedTimeMap::const_iterator iter = removedMap.find( streamId );
+  if( iter == removedMap.end() || end <= start )
+  {
+    return 0;
+  }
+
+  return getRemovedBefore( iter->second, end ) -
+         getRemovedBefore( iter->second, start );
+}
+
+/**
+ * Combine the graph files of all analysis processes. Nodes that are kept for
+ * the next analysis interval are stored twice and merged by their ID.
+ */
+static void
+loadGraph( const std::vector< std::string >& files, PredictionGraph& graph )
+{
+  graph.criticalPathLength = 0;
+  graph.timerResolution    = 0;
+  graph.startTime          = UINT64_MAX;
+
+  // analysis process of the streams
+  std::map< uint64_t, uint32_t > streamProcess;
+
+  // node IDs per analysis process -> node index
+  std::vector< std::map< uint64_t, uint32_t > > nodeIndices( files.size() );
+
+  std::vector< GraphStore* > stores( files.size(), ( GraphStore* )NULL );
+
+  for( size_t i = 0; i < files.size(); ++i )
+  {
+    stores[ i ] = new GraphStore();
+    if( !stores[ i ]->open( files[ i ] ) )
+    {
+      throw RTException( "Could not read graph file %s (incomplete?)",
+                         files[ i ].c_str() );
+    }
+
+    GraphStore& store = *stores[ i ];
+
+    if( i == 0 && store.getMPISize() != files.size() )
+    {
+      UTILS_WARNING( "The graph was stored by %u processes, but %lu graph "
+                     "files are given.", store.getMPISize(), files.size() );
+    }
+
+    graph.criticalPathLength = std::max( graph.criticalPathLength,
+                                         store.getCriticalPathLength() );
+    graph.timerResolution    = store.getTimerResolution();
+
+    if( graph.regionNames.empty() )
+    {
+      graph.regionNames = store.regionNames;
+    }
+
+    for( std::vector< GraphStore::NodeRecord >::const_iterator iter =
+           store.nodes.begin(); iter != store.nodes.end(); ++iter )
+    {
+      std::map< uint64_t, uint32_t >::iterator nIter =
+        nodeIndices[ i ].find( iter->id );
+
+      if( nIter != nodeIndices[ i ].end() )
+      {
+        graph.nodes[ nIter->second ].critical |=
+          ( bool )( iter->flags & GraphStore::NODE_CRITICAL );
+        continue;
+      }
+
+      PredictNode node;
+      node.id       = iter->id;
+      node.time     = iter->time;
+      node.streamId = iter->streamId;
+      node.critical = iter->flags & GraphStore::NODE_CRITICAL;
+
+      nodeIndices[ i ][ iter->id ] = graph.nodes.size();
+      streamProcess[ iter->streamId ] = i;
+      graph.nodes.push_back( node );
+
+      graph.startTime = std::min( graph.startTime, node.time );
+    }
+
+    for( RegionList::const_iterator iter = store.regions.begin();
+         iter != store.regions.end(); ++iter )
+    {
+      graph.streamRegions[ iter->streamId ].push_back( *iter );
+    }
+
+    store.nodes.clear();
+    store.regions.clear();
+  }
+
+  // edges and remote partners (the nodes of all processes are known now)
+  std::vector< bool > hasStreamPredecessor( graph.nodes.size(), false );
+
+  for( size_t i = 0; i < files.size(); ++i )
+  {
+    GraphStore& store = *stores[ i ];
+
+    for( std::vector< GraphStore::EdgeRecord >::const_iterator iter =
+           store.edges.begin(); iter != store.edges.end(); ++iter )
+    {
+      std::map< uint64_t, uint32_t >::const_iterator start =
+        nodeIndices[ i ].find( iter->startId );
+      std::map< uint64_t, uint32_t >::const_iterator end =
+        nodeIndices[ i ].find( iter->endId );
+
+      if( start == nodeIndices[ i ].end() || end == nodeIndices[ i ].end() )
+      {
+        continue;
+      }
+
+      PredictEdge edge;
+      edge.from = start->second;
+      edge.to   = end->second;
+
+      const PredictNode& from = graph.nodes[ edge.from ];
+      const PredictNode& to   = graph.nodes[ edge.to ];
+
+      if( iter->flags & GraphStore::EDGE_BLOCKING || from.time > to.time )
+      {
+        edge.kind = EDGE_WAIT;
+      }
+      else if( from.streamId == to.streamId )
+      {
+        edge.kind = EDGE_ACTIVITY;
+      }
+      else
+      {
+        edge.kind = EDGE_LATENCY;
+      }
+
+      if( from.streamId == to.streamId )
+      {
+        hasStreamPredecessor[ edge.to ] = true;
+      }
+
+      graph.edges.push_back( edge );
+    }
+
+    for( std::vector< GraphStore::RemoteRecord >::const_iterator iter =
+           store.remoteNodes.begin(); iter != store.remoteNodes.end(); ++iter )
+    {
+      std::map< uint64_t, uint32_t >::const_iterator process =
+        streamProcess.find( iter->remoteStreamId );
+      if( process == streamProcess.end() )
+      {
+        continue;
+      }
+
+      std::map< uint64_t, uint32_t >::const_iterator local =
+        nodeIndices[ i ].find( iter->nodeId );
+      std::map< uint64_t, uint32_t >::const_iterator remote =
+        nodeIndices[ process->second ].find( iter->remoteNodeId );
+
+      if( local == nodeIndices[ i ].end() ||
+          remote == nodeIndices[ process->second ].end() )
+      {
+        continue;
+      }
+
+      PredictEdge edge;
+      edge.from = remote->second;
+      edge.to   = local->second;
+      edge.kind = EDGE_LATENCY;
+
+      graph.edges.push_back( edge );
+    }
+
+    delete stores[ i ];
+  }
+
+  // exclusive region segments (the region instances of a stream are nested)
+  for( std::map< uint64_t, RegionList >::iterator iter =
+         graph.streamRegions.begin(); iter != graph.streamRegions.end(); ++iter )
+  {
+    std::vector< std::pair< std::pair< uint64_t, uint32_t >, uint32_t > > order;
+    for( size_t i = 0; i < iter->second.size(); ++i )
+    {
+      order.push_back( std::make_pair( std::make_pair(
+        iter->second[ i ].start, iter->second[ i ].depth ), i ) );
+    }
+    std::sort( order.begin(), order.end() );
+
+    RegionSegments& segments = graph.streamSegments[ iter->first ];
+
+    // open regions (region reference, leave time)
+    std::vector< std::pair< uint32_t, uint64_t > > stack;
+    uint64_t cursor = 0;
+
+    for( size_t i = 0; i <= order.size(); ++i )
+    {
+      uint64_t next = UINT64_MAX;
+      if( i < order.size() )
+      {
+        next = iter->second[ order[ i ].second ].start;
+      }
+
+      // close the regions that end before the next region starts
+      while( !stack.empty() && stack.back().second <= next )
+      {
+        if( cursor < stack.back().second )
+        {
+          segments.starts.push_back( cursor );
+          segments.ends.push_back( stack.back().second );
+          segments.regionRefs.push_back( stack.back().first );
+          cursor = stack.back().second;
+        }
+        stack.pop_back();
+      }
+
+      if( i == order.size() )
+      {
+        break;
+      }
+
+      if( !stack.empty() && cursor < next )
+      {
+        segments.starts.push_back( cursor );
+        segments.ends.push_back( next );
+        segments.regionRefs.push_back( stack.back().first );
+      }
+
+      const GraphStore::RegionRecord& region = iter->second[ order[ i ].second ];
+      stack.push_back( std::make_pair( region.regionRef, region.end ) );
+      cursor = region.start;
+    }
+  }
+
+  // connect the nodes of a stream across analysis intervals (the first node
+  // of an interval has no in-edge on its stream)
+  std::map< uint64_t, std::vector< std::pair< uint64_t, uint32_t > > > streams;
+  for( uint32_t i = 0; i < graph.nodes.size(); ++i )
+  {
+    const PredictNode& node = graph.nodes[ i ];
+    streams[ node.streamId ].push_back(
+      std::make_pair( node.time, i ) );
+  }
+
+  for( std::map< uint64_t, std::vector< std::pair< uint64_t, uint32_t > > >::
+         iterator iter = streams.begin(); iter != streams.end(); ++iter )
+  {
+    std::vector< std::pair< uint64_t, uint32_t > >& sequence = iter->second;
+    std::sort( sequence.begin(), sequence.end() );
+
+    for( size_t pos = 1; pos < sequence.size(); ++pos )
+    {
+      if( !hasStreamPredecessor[ sequence[ pos ].second ] )
+      {
+        PredictEdge edge;
+        edge.from = sequence[ pos - 1 ].second;
+        edge.to   = sequence[ pos ].second;
+        edge.kind = EDGE_ACTIVITY;
+
+        graph.edges.push_back( edge );
+      }
+    }
+  }
+
+  // in-edges of the nodes
+  const uint32_t numNodes = graph.nodes.size();
+
+  graph.inOffsets.assign( numNodes + 1, 0 );
+  for( size_t i = 0; i < graph.edges.size(); ++i )
+  {
+    graph.inOffsets[ graph.edges[ i ].to + 1 ]++;
+  }
+
+  for( uint32_t i = 0; i < numNodes; ++i )
+  {
+    graph.inOffsets[ i + 1 ] += graph.inOffsets[ i ];
+  }
+
+  std::vector< uint32_t > fill( graph.inOffsets.begin(),
+                                graph.inOffsets.end() - 1 );
+  graph.inEdges.resize( graph.edges.size() );
+  for( size_t i = 0; i < graph.edges.size(); ++i )
+  {
+    graph.inEdges[ fill[ graph.edges[ i ].to ]++ ] = i;
+  }
+
+  // topological order (the order is the same for all predictions)
+  std::vector< uint32_t > outOffsets( numNodes + 1, 0 );
+  for( size_t i = 0; i < graph.edges.size(); ++i )
+  {
+    outOffsets[ graph.edges[ i ].from + 1 ]++;
+  }
+
+  for( uint32_t i = 0; i < numNodes; ++i )
+  {
+    outOffsets[ i + 1 ] += outOffsets[ i ];
+  }
+
+  std::vector< uint32_t > outEdges( graph.edges.size() );
+  fill.assign( outOffsets.begin(), outOffsets.end() - 1 );
+  for( size_t i = 0; i < graph.edges.size(); ++i )
+  {
+    outEdges[ fill[ graph.edges[ i ].from ]++ ] = i;
+  }
+
+  std::vector< uint32_t > inDegree( numNodes );
+  for( uint32_t i = 0; i < numNodes; ++i )
+  {
+    inDegree[ i ] = graph.inOffsets[ i + 1 ] - graph.inOffsets[ i ];
+    if( inDegree[ i ] == 0 )
+    {
+      graph.order.push_back( i );
+    }
+  }
+
+  for( size_t pos = 0; pos < graph.order.size(); ++pos )
+  {
+    uint32_t node = graph.order[ pos ];
+    for( uint32_t e = outOffsets[ node ]; e < outOffsets[ node + 1 ]; ++e )
+    {
+      uint32_t to = graph.edges[ outEdges[ e ] ].to;
+      if( --inDegree[ to ] == 0 )
+      {
+        graph.order.push_back( to );
+      }
+    }
+  }
+
+  if( graph.order.size() < numNodes )
+  {
+    UTILS_WARNING( "The graph contains cycles. %lu of %u nodes are ignored.",
+                   numNodes - graph.order.size(), numNodes );
+  }
+}
+
+/**
+ * Get the region references of the given region names.
+ */
+static std::set< uint32_t >
+getRegionRefs( const PredictionGraph& graph,
+               const std::vector< std::string >& names )
+{
+  std::set< uint32_t > refs;
+
+  for( std::vector< std::string >::const_iterator name = names.begin();
+       name != names.end(); ++name )
+  {
+    bool found = false;
+    for( std::map< uint32_t, std::string >::const_iterator iter =
+           graph.regionNames.begin(); iter != graph.regionNames.end(); ++iter )
+    {
+      if( iter->second == *name )
+      {
+        refs.insert( iter->first );
+        found = true;
+      }
+    }
+
+    if( !found )
+    {
+      UTILS_WARNING( "Region %s is not defined in the graph.", name->c_str() );
+    }
+  }
+
+  return refs;
+}
+
+/**
+ * Compute the union of the instances of the given regions per stream.
+ */
+static void
+getRemovedTime( const PredictionGraph& graph,
+                const std::set< uint32_t >& regionRefs,
+                RemovedTimeMap& removedMap )
+{
+  for( std::map< uint64_t, RegionList >::const_iterator iter =
+         graph.streamRegions.begin(); iter != graph.streamRegions.end(); ++iter )
+  {
+    std::vector< std::pair< uint64_t, uint64_t > > instances;
+    for( RegionList::const_iterator region = iter->second.begin();
+         region != iter->second.end(); ++region )
+    {
+      if( regionRefs.count( region->regionRef ) )
+      {
+        instances.push_back( std::make_pair( region->start, region->end ) );
+      }
+    }
+
+    if( instances.empty() )
+    {
+      continue;
+    }
+
+    std::sort( instances.begin(), instances.end() );
+
+    RemovedTime& removed = removedMap[ iter->first ];
+    uint64_t sum = 0;
+
+    for( size_t i = 0; i < instances.size(); ++i )
+    {
+      // nested and overlapping instances are merged
+      if( !removed.ends.empty() && instances[ i ].first <= removed.ends.back() )
+      {
+        if( instances[ i ].second > removed.ends.back() )
+        {
+          sum += instances[ i ].second - removed.ends.back();
+          removed.ends.back() = instances[ i ].second;
+        }
+        continue;
+      }
+
+      removed.starts.push_back( instances[ i ].first );
+      removed.ends.push_back( instances[ i ].second );
+      removed.sums.push_back( sum );
+      sum += instances[ i ].second - instances[ i ].first;
+    }
+  }
+}
+
+/**
+ * Add the exclusive region time of an activity on the critical path. The time
+ * of removed regions is not added.
+ *
+ * @param graph combined graph
+ * @param removedMap removed time per stream
+ * @param streamId stream of the activity
+ * @param start start time of the activity
+ * @param end end time of the activity
+ * @param regionTimes time per region reference
+ */
+static void
+addRegionTime( const PredictionGraph& graph, const RemovedTimeMap& removedMap,
+               uint64_t streamId, uint64_t start, uint64_t end,
+               std::map< uint32_t, uint64_t >& regionTimes )
+{
+  std::map< uint64_t, RegionSegments >::const_iterator iter =
+    graph.streamSegments.find( streamId );
+  if( iter == graph.streamSegments.end() )
+  {
+    return;
+  }
+
+  const RegionSegments& segments = iter->second;
+
+  // first segment that ends after the start
+  size_t pos = std::upper_bound( segments.ends.begin(), segments.ends.end(),
+                                 start ) - segments.ends.begin();
+
+  for( ; pos < segments.starts.size() && segments.starts[ pos ] < end; ++pos )
+  {
+    uint64_t first = std::max( start, segments.starts[ pos ] );
+    uint64_t last  = std::min( end, segments.ends[ pos ] );
+    uint64_t time  = last - first -
+                     getRemovedTime( removedMap, streamId, first, last );
+
+    if( time > 0 )
+    {
+      regionTimes[ segments.regionRefs[ pos ] ] += time;
+    }
+  }
+}
+
+/**
+ * Compute the longest path through the graph for all scenarios in one pass
+ * over the nodes in topological order. The duration of an edge is computed
+ * once and only changed for the scenarios that remove regions on the stream
+ * of the edge. The top regions of each scenario are taken from the exclusive
+ * region time of the activities on its critical path.
+ *
+ * @param graph combined graph
+ * @param scenarios scenarios with the removed time per stream
+ * @param topX number of top regions per scenario
+ */
+static void
+predictScenarios( const PredictionGraph& graph,
+                  std::vector< Scenario >& scenarios, size_t topX )
+{
+  const size_t numScenarios = scenarios.size();
+  const size_t numNodes     = graph.nodes.size();
+
+  // scenarios that remove time on a stream
+  typedef std::vector< std::pair< size_t, const RemovedTime* > > RemovalList;
+  std::map< uint64_t, RemovalList > streamRemovals;
+
+  for( size_t s = 0; s < numScenarios; ++s )
+  {
+    scenarios[ s ].removedOnCP = 0;
+
+    for( RemovedTimeMap::const_iterator iter = scenarios[ s ].removed.begin();
+         iter != scenarios[ s ].removed.end(); ++iter )
+    {
+      streamRemovals[ iter->first ].push_back(
+        std::make_pair( s, &( iter->second ) ) );
+    }
+  }
+
+  // finish time and critical in-edge per node and scenario
+  std::vector< uint64_t > finish( numNodes * numScenarios, 0 );
+  std::vector< uint32_t > critical( numNodes * numScenarios, UINT32_MAX );
+  std::vector< uint64_t > duration( numScenarios );
+
+  const RemovalList noRemovals;
+
+  for( std::vector< uint32_t >::const_iterator iter = graph.order.begin();
+       iter != graph.order.end(); ++iter )
+  {
+    const PredictNode& node = graph.nodes[ *iter ];
+    const uint32_t first = graph.inOffsets[ *iter ];
+    const uint32_t last  = graph.inOffsets[ *iter + 1 ];
+
+    uint64_t* nodeFinish   = &finish[ *iter * numScenarios ];
+    uint32_t* nodeCritical = &critical[ *iter * numScenarios ];
+
+    // nodes without predecessor keep their time
+    if( first == last )
+    {
+      std::fill( nodeFinish, nodeFinish + numScenarios, node.time );
+      continue;
+    }
+
+    std::map< uint64_t, RemovalList >::const_iterator rIter =
+      streamRemovals.find( node.streamId );
+    const RemovalList& removals =
+      ( rIter != streamRemovals.end() ) ? rIter->second : noRemovals;
+
+    for( uint32_t e = first; e < last; ++e )
+    {
+      const uint32_t edgeIdx = graph.inEdges[ e ];
+      const PredictEdge& edge = graph.edges[ edgeIdx ];
+      const PredictNode& from = graph.nodes[ edge.from ];
+
+      uint64_t shared = 0;
+      if( edge.kind != EDGE_WAIT && node.time > from.time )
+      {
+        shared = node.time - from.time;
+      }
+
+      std::fill( duration.begin(), duration.end(), shared );
+
+      if( edge.kind == EDGE_ACTIVITY )
+      {
+        for( RemovalList::const_iterator sIter = removals.begin();
+             sIter != removals.end(); ++sIter )
+        {
+          uint64_t removed = getRemovedBefore( *( sIter->second ), node.time ) -
+                             getRemovedBefore( *( sIter->second ), from.time );
+          duration[ sIter->first ] -= std::min( shared, removed );
+
+          if( from.critical && node.critical )
+          {
+            scenarios[ sIter->first ].removedOnCP += removed;
+          }
+        }
+      }
+
+      const uint64_t* fromFinish = &finish[ edge.from * numScenarios ];
+      for( size_t s = 0; s < numScenarios; ++s )
+      {
+        if( nodeCritical[ s ] == UINT32_MAX ||
+            fromFinish[ s ] + duration[ s ] > nodeFinish[ s ] )
+        {
+          nodeFinish[ s ]   = fromFinish[ s ] + duration[ s ];
+          nodeCritical[ s ] = edgeIdx;
+        }
+      }
+    }
+  }
+
+  // length and top regions of the critical path per scenario
+  for( size_t s = 0; s < numScenarios; ++s )
+  {
+    Scenario& scenario = scenarios[ s ];
+
+    uint32_t endNode = UINT32_MAX;
+    uint64_t end     = graph.startTime;
+    for( std::vector< uint32_t >::const_iterator iter = graph.order.begin();
+         iter != graph.order.end(); ++iter )
+    {
+      if( endNode == UINT32_MAX || finish[ *iter * numScenarios + s ] > end )
+      {
+        endNode = *iter;
+        end     = finish[ *iter * numScenarios + s ];
+      }
+    }
+
+    scenario.length = end - graph.startTime;
+
+    std::map< uint32_t, uint64_t > regionTimes;
+    for( uint32_t node = endNode; node != UINT32_MAX &&
+         critical[ node * numScenarios + s ] != UINT32_MAX; )
+    {
+      const PredictEdge& edge = 
+        graph.edges[ critical[ node * numScenarios + s ] ];
+
+      if( edge.kind == EDGE_ACTIVITY )
+      {
+        addRegionTime( graph, scenario.removed, graph.nodes[ node ].streamId,
+                       graph.nodes[ edge.from ].time, graph.nodes[ node ].time,
+                       regionTimes );
+      }
+
+      node = edge.from;
+    }
+
+    scenario.topRegions.clear();
+    for( std::map< uint32_t, uint64_t >::const_iterator iter =
+           regionTimes.begin(); iter != regionTimes.end(); ++iter )
+    {
+      scenario.topRegions.push_back(
+        std::make_pair( iter->second, iter->first ) );
+    }
+
+    std::sort( scenario.topRegions.rbegin(), scenario.topRegions.rend() );
+    if( scenario.topRegions.size() > topX )
+    {
+      scenario.topRegions.resize( topX );
+    }
+  }
+}
+
+static double
+toSeconds( const PredictionGraph& graph, uint64_t ticks )
+{
+  return graph.timerResolution ?
+         ( double )ticks / ( double )graph.timerResolution : 0.0;
+}
+
+static void
+printTopRegions( const PredictionGraph& graph, const Scenario& scenario )
+{
+  for( RegionTimeList::const_iterator iter = scenario.topRegions.begin();
+       iter != scenario.topRegions.end(); ++iter )
+  {
+    std::map< uint32_t, std::string >::const_iterator name =
+      graph.regionNames.find( iter->second );
+
+    UTILS_OUT( "    %-40s %f sec (%.2f%%)",
+               name != graph.regionNames.end() ? name->second.c_str() : "?",
+               toSeconds( graph, iter->first ),
+               scenario.length ? 100.0 * ( double )iter->first /
+               ( double )scenario.length : 0.0 );
+  }
+}
+
+/**
+ * Split a filter option into region names (separated by ';').
+ */
+static std::vector< std::string >
+getFilterRegions( const std::string& regions )
+{
+  std::vector< std::string > names;
+
+  size_t start = 0, end;
+  while( ( end = regions.find( ";", start ) ) != std::string::npos )
+  {
+    if( end > start )
+    {
+      names.push_back( regions.substr( start, end - start ) );
+    }
+    start = end + 1;
+  }
+
+  if( start < regions.length() )
+  {
+    names.push_back( regions.substr( start ) );
+  }
+
+  return names;
+}
+
+static void
+printUsage()
+{
+  UTILS_OUT( "Usage: casita-predict [--filter=REGIONS]... [--top=INTEGER] "
+             "<graph-file>...\n\n"
+             "Predict the critical path length of the analyzed trace without "
+             "the time of the\ngiven regions (separated by ';') from the "
+             "graph files of all analysis\nprocesses (casita "
+             "--graph-store=DIR). Every --filter option is a scenario,\nall "
+             "scenarios are evaluated in one pass over the graph." );
+}
+
+int
+main( int argc, char** argv )
+{
+  std::vector< std::string > files;
+  std::vector< std::string > filters;
+  size_t topX = 10;
+
+  for( int i = 1; i < argc; ++i )
+  {
+    std::string arg( argv[ i ] );
+
+    if( arg == "-h" || arg == "--help" )
+    {
+      printUsage();
+      return 0;
+    }
+    else if( arg.find( "--filter=" ) == 0 )
+    {
+      filters.push_back( arg.substr( std::string( "--filter=" ).length() ) );
+    }
+    else if( arg.find( "--top=" ) == 0 )
+    {
+      topX = atoi( arg.substr( std::string( "--top=" ).length() ).c_str() );
+    }
+    else
+    {
+      files.push_back( arg );
+    }
+  }
+
+  if( files.empty() )
+  {
+    printUsage();
+    return 1;
+  }
+
+  try
+  {
+    PredictionGraph graph;
+    loadGraph( files, graph );
+
+    UTILS_OUT( "Read %lu nodes and %lu edges from %lu graph files",
+               graph.nodes.size(), graph.edges.size(), files.size() );
+
+    // the model without removed regions (first scenario) is the reference
+    // for the predictions
+    std::vector< Scenario > scenarios( filters.size() + 1 );
+    for( size_t s = 0; s < filters.size(); ++s )
+    {
+      scenarios[ s + 1 ].filter = filters[ s ];
+      getRemovedTime( graph, getRegionRefs( graph, 
+                        getFilterRegions( filters[ s ] ) ),
+                      scenarios[ s + 1 ].removed );
+    }
+
+    predictScenarios( graph, scenarios, topX );
+
+    const uint64_t modelLength = scenarios[ 0 ].length;
+
+    UTILS_OUT( "Critical path length: %f sec (model: %f sec)",
+               toSeconds( graph, graph.criticalPathLength ),
+               toSeconds( graph, modelLength ) );
+    printTopRegions( graph, scenarios[ 0 ] );
+
+    for( size_t s = 1; s < scenarios.size(); ++s )
+    {
+      const Scenario& scenario = scenarios[ s ];
+
+      // apply the change of the model to the measured critical path
+      uint64_t reduction = modelLength > scenario.length ?
+                           modelLength - scenario.length : 0;
+      uint64_t predicted = graph.criticalPathLength > reduction ?
+                           graph.criticalPathLength - reduction : 0;
+
+      UTILS_OUT( "\nScenario %lu: --filter=%s", s, scenario.filter.c_str() );
+      UTILS_OUT( "  Removed regions on the critical path: %f sec",
+                 toSeconds( graph, scenario.removedOnCP ) );
+      UTILS_OUT( "  Predicted critical path length: %f sec (%.2f%%)",
+                 toSeconds( graph, predicted ),
+                 graph.criticalPathLength ? 100.0 * ( double )predicted /
+                 ( double )graph.criticalPathLength : 0.0 );
+      printTopRegions( graph, scenario );
+    }
+  }
+  catch( RTException& e )
+  {
+    return 1;
+  }
+
+  return 0;
+}
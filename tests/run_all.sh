@@ -20,6 +20,9 @@ NUM_TESTS_SUCCESS=0
 NUM_TOTAL_TESTS=0
 TRACE_OUTPUT_DIR=
 OTF2_PRINT_EXE=otf2-print
+MERGE_EXE=casita-merge
+PREDICT_EXE=casita-predict
+BASELINE_EXE=
 
 # functions
 
@@ -28,6 +31,8 @@ function check_setup {
     command -v $EXE &> /dev/null || { echo "Could not find CASITA executable '$EXE', abort." >&2; return 1; }
     command -v $PERL &> /dev/null || { echo "Could not find perl executable, abort." >&2; return 1; }
     command -v $OTF2_PRINT_EXE &> /dev/null || { echo "Warning: Could not find otf2-print executable." >&2; OTF2_PRINT_EXE=; }
+    command -v $MERGE_EXE &> /dev/null || { echo "Warning: Could not find casita-merge executable." >&2; MERGE_EXE=; }
+    command -v $PREDICT_EXE &> /dev/null || { echo "Warning: Could not find casita-predict executable." >&2; PREDICT_EXE=; }
 
     # try to run casita
     $EXE --help 2>&1 | grep "casita" &> /dev/null
@@ -61,7 +66,7 @@ function check_setup {
 function run_single_test {
     echo "Testing '$1'" >&2
 
-    $PERL $TEST_SCRIPT $1 $EXE $TRACE_OUTPUT_DIR $OTF2_PRINT_EXE
+    $PERL $TEST_SCRIPT $1 $EXE $TRACE_OUTPUT_DIR "$OTF2_PRINT_EXE" "$MERGE_EXE" "$PREDICT_EXE" "$BASELINE_EXE"
 }
 
 function run_tests {
@@ -81,6 +86,20 @@ function run_tests {
 if [ "$#" -gt 0 ]; then
     echo "Using '$1' as casita executable"
     EXE=$1
+
+    # use the tools next to the given executable
+    if [ -x "$(dirname $1)/casita-merge" ]; then
+        MERGE_EXE="$(dirname $1)/casita-merge"
+    fi
+    if [ -x "$(dirname $1)/casita-predict" ]; then
+        PREDICT_EXE="$(dirname $1)/casita-predict"
+    fi
+fi
+
+# the default runs are compared with the runs of a baseline casita executable
+if [ "$#" -gt 1 ]; then
+    echo "Using '$2' as baseline casita executable"
+    BASELINE_EXE=$2
 fi
 
 check_setup
@@ -16,6 +16,661 @@ use warnings;
 
 my $num_args = $#ARGV + 1;
 
+# size of a trace directory in K
+sub trace_size
+{
+    my ($trace_dir) = @_;
+
+    my $otf2_size = qx(du -s ${trace_dir});
+    if ( $otf2_size =~ m/^(\d+)/ ) {
+      return $1;
+    }
+
+    return 0;
+}
+
+# run CASITA with the given options, returns the output or an empty list on error
+sub run_casita
+{
+    my ($test, $options) = @_;
+
+    my $command = "mpirun -n $test->{nprocs} $test->{casita} $test->{trace_dir}/traces.otf2 $options --verbose=1";
+    print "Executing '$command'\n";
+    my @output = qx($command 2>&1);
+    my $status = $? >> 8;
+
+    if (not ($status == 0))
+    {
+        print "@output \n\n";
+        print "Error: CASITA returned error ${status} ($options)\n";
+        return ();
+    }
+
+    return @output;
+}
+
+# count the events and the METRIC events of an OTF2 trace, returns -1 if the
+# events are not counted
+sub count_events
+{
+    my ($test, $otf2_file) = @_;
+
+    if (length $test->{otf2_print} == 0)
+    {
+        return (-1, -1);
+    }
+
+    my @otf2_output = qx($test->{otf2_print} $otf2_file 2>&1);
+    if (not (($? >> 8) == 0))
+    {
+        print "Error: Could not run otf2-print on $otf2_file\n";
+        return (-1, -1);
+    }
+
+    my @events = grep (/^[A-Z][A-Z_]+\s+\d+\s+\d+/, @otf2_output);
+    my @metrics = grep (/^METRIC/, @events);
+    return ($#events + 1, $#metrics + 1);
+}
+
+# critical path length, ratings and number of output events of a CASITA run
+# (the events are not counted without output trace)
+sub get_result
+{
+    my ($test, $output, $otf2_file) = @_;
+    my %result = (cp => "", ratings => {}, events => undef, metrics => undef);
+
+    foreach (@$output)
+    {
+        my $oline = $_;
+
+        if ($oline =~ /Critical path length = (\d+\.\d+) sec/)
+        {
+            $result{cp} = $1;
+        }
+        elsif ($oline =~ /(.+)\s+(\d+)\s+(\d+\.\d+)\s+(\d+\.\d+)\s+(\d+\.\d+)\s+(\d+\.\d+)\s+(\d+\.\d+)\s+(\d+\.\d+)/)
+        {
+            my $fname  = $1;
+            my $rating = $7;
+            $fname =~ s/^\s+|\s+$//g;
+            $result{ratings}{$fname} = $rating;
+        }
+    }
+
+    if (length $otf2_file > 0)
+    {
+        ($result{events}, $result{metrics}) = count_events($test, $otf2_file);
+    }
+
+    return \%result;
+}
+
+# compare the result of a mode with the result of the reference run, the
+# optional tolerance allows a relative deviation of the critical path length
+# (cp) and an absolute deviation of the ratings (rating, a missing rating is 0),
+# then only the events apart from METRIC are compared
+sub compare_result
+{
+    my ($mode, $reference, $result, $tolerance) = @_;
+
+    if (defined $tolerance)
+    {
+        if (abs($result->{cp} - $reference->{cp}) > $tolerance->{cp} * $reference->{cp})
+        {
+            print "Error: $mode: critical path length ($result->{cp}) deviates more than " .
+                  ($tolerance->{cp} * 100) . "% from the reference run ($reference->{cp})\n";
+            return 1;
+        }
+    }
+    elsif (not ($result->{cp} eq $reference->{cp}))
+    {
+        print "Error: $mode: critical path length ($result->{cp}) differs from the reference run ($reference->{cp})\n";
+        return 1;
+    }
+
+    my %ratings = %{$result->{ratings}};
+    foreach my $fname (keys %{$reference->{ratings}})
+    {
+        my $expected = $reference->{ratings}{$fname};
+
+        if (defined $tolerance)
+        {
+            my $rating = exists $ratings{$fname} ? $ratings{$fname} : 0;
+            if (abs($rating - $expected) > $tolerance->{rating})
+            {
+                print "Error: $mode: rating of $fname ($rating) deviates more than $tolerance->{rating} from the reference run ($expected)\n";
+                return 1;
+            }
+        }
+        elsif (not (exists $ratings{$fname} && $ratings{$fname} eq $expected))
+        {
+            my $rating = exists $ratings{$fname} ? $ratings{$fname} : "none";
+            print "Error: $mode: rating of $fname ($rating) differs from the reference run ($expected)\n";
+            return 1;
+        }
+        delete $ratings{$fname};
+    }
+
+    foreach my $fname (keys %ratings)
+    {
+        if (defined $tolerance && $ratings{$fname} <= $tolerance->{rating})
+        {
+            next;
+        }
+
+        print "Error: $mode: rating of $fname ($ratings{$fname}) is not in the reference run\n";
+        return 1;
+    }
+
+    if (defined $result->{events} && defined $reference->{events} && $reference->{events} >= 0)
+    {
+        my $events = $result->{events};
+        my $expected = $reference->{events};
+        if (defined $tolerance)
+        {
+            $events -= $result->{metrics};
+            $expected -= $reference->{metrics};
+        }
+
+        if (not ($events == $expected))
+        {
+            print "Error: $mode: output trace has $events events, reference run $expected\n";
+            return 1;
+        }
+    }
+
+    return 0;
+}
+
+# run CASITA with an output trace and compare it with the reference run, the
+# output has to contain the optional message
+sub test_mode
+{
+    my ($test, $mode, $name, $options, $reference, $message, $tolerance) = @_;
+
+    my $otf2_file = "$test->{tmp_dir}/$test->{trace_name}_${name}.otf2";
+    my @output = run_casita($test, "-o $otf2_file $options");
+    if (not (@output))
+    {
+        return 1;
+    }
+
+    if (defined $message && not (grep (/\Q$message\E/, @output)))
+    {
+        print "@output \n\n";
+        print "Error: $mode: CASITA did not print '$message'\n";
+        return 1;
+    }
+
+    return compare_result($mode, $reference, get_result($test, \@output, $otf2_file), $tolerance);
+}
+
+# the default run has to match the run of the baseline CASITA executable (the
+# version before the bulk matching of MPI operations)
+sub test_baseline
+{
+    my ($test) = @_;
+
+    if (length $test->{baseline} == 0)
+    {
+        print "Warning: No baseline CASITA, skipping baseline test\n";
+        return 0;
+    }
+
+    my %baseline = (%$test, casita => $test->{baseline});
+    my @output = run_casita(\%baseline, "-o $test->{tmp_dir}/$test->{trace_name}_baseline.otf2");
+    if (not (@output))
+    {
+        return 1;
+    }
+
+    # the modes are compared with the default run, hence compare the default
+    # run with the baseline run
+    return compare_result("default run (baseline)", get_result($test, \@output, ""), $test->{reference});
+}
+
+# keep the events of the analysis intervals in memory (--event-buffer)
+sub test_event_buffer
+{
+    my ($test) = @_;
+
+    return test_mode($test, "--event-buffer", "event_buffer", "--event-buffer=64", $test->{reference});
+}
+
+# decode the events of the local locations in parallel (--parallel-read)
+sub test_parallel_read
+{
+    my ($test) = @_;
+
+    return test_mode($test, "--parallel-read", "parallel_read", "--parallel-read", $test->{reference});
+}
+
+# number of analysis intervals in the CASITA output, 0 if not printed
+sub count_intervals
+{
+    my ($output) = @_;
+
+    foreach (@$output)
+    {
+        if ($_ =~ /Number of analysis intervals: (\d+)/)
+        {
+            return $1;
+        }
+    }
+
+    return 0;
+}
+
+# run CASITA with intervals between global collectives and compare it with the
+# reference run, a trace with less than two intervals is reported
+sub test_intervals
+{
+    my ($test, $mode, $name, $options, $reference) = @_;
+
+    my $otf2_file = "$test->{tmp_dir}/$test->{trace_name}_${name}.otf2";
+    my @output = run_casita($test, "-o $otf2_file $options");
+    if (not (@output))
+    {
+        return 1;
+    }
+
+    if (count_intervals(\@output) < 2)
+    {
+        print "Warning: $mode: single analysis interval (no global collective to cut at)\n";
+    }
+
+    return compare_result($mode, $reference, get_result($test, \@output, $otf2_file));
+}
+
+# start an analysis run after every pending graph node (--interval-analysis)
+sub test_interval_analysis
+{
+    my ($test) = @_;
+
+    return test_intervals($test, "--interval-analysis", "interval_analysis", "--interval-analysis=1",
+                          $test->{reference});
+}
+
+# start an analysis run before the graph exceeds 1 MiB (--memory-limit)
+sub test_memory_limit
+{
+    my ($test) = @_;
+
+    return test_intervals($test, "--memory-limit", "memory_limit", "--memory-limit=1", $test->{reference});
+}
+
+# the bulk matching ignores non-blocking MPI, its reference is the default
+# run with --ignore-impi (undef on error)
+sub get_blocking_reference
+{
+    my ($test) = @_;
+
+    if (not (exists $test->{blocking_reference}))
+    {
+        my $otf2_file = "$test->{tmp_dir}/$test->{trace_name}_ignore_impi.otf2";
+        my @output = run_casita($test, "-o $otf2_file --ignore-impi");
+        $test->{blocking_reference} = @output ? get_result($test, \@output, $otf2_file) : undef;
+    }
+
+    return $test->{blocking_reference};
+}
+
+# match the blocking MPI point-to-point operations in bulk (--bulk-p2p)
+sub test_bulk_p2p
+{
+    my ($test) = @_;
+
+    my $reference = get_blocking_reference($test);
+    if (not (defined $reference))
+    {
+        return 1;
+    }
+
+    return test_mode($test, "--bulk-p2p", "bulk_p2p", "--bulk-p2p", $reference);
+}
+
+# analyze two traced ranks per analysis process (M:N mode), non-blocking MPI is
+# ignored in M:N mode, hence the reference is the default run with --ignore-impi
+sub test_m_to_n
+{
+    my ($test) = @_;
+
+    if ($test->{nprocs} < 2)
+    {
+        print "Warning: Single process, skipping M:N test\n";
+        return 0;
+    }
+
+    my $reference = get_blocking_reference($test);
+    if (not (defined $reference))
+    {
+        return 1;
+    }
+
+    my $nprocs = int($test->{nprocs} / 2);
+    my %m_to_n = (%$test, nprocs => $nprocs);
+
+    return test_mode(\%m_to_n, "M:N ($nprocs processes)", "m_to_n", "", $reference);
+}
+
+# cut the analysis intervals by trace time (--time-interval) with shorter
+# intervals until a cut splits a point-to-point message (CASITA reports the
+# operations without partner in the interval). Runs without split messages have
+# to match the reference run. The wait state of a split message is not
+# attributed, hence that run may deviate by the stated tolerance.
+my %time_cut_tolerance = (cp => 0.05, rating => 0.1);
+
+sub test_time_interval
+{
+    my ($test) = @_;
+
+    if ($test->{nprocs} < 2)
+    {
+        print "Warning: Single process, skipping --time-interval test\n";
+        return 0;
+    }
+
+    my $reference = get_blocking_reference($test);
+    if (not (defined $reference))
+    {
+        return 1;
+    }
+
+    if (not ($reference->{cp} > 0))
+    {
+        print "Warning: Empty critical path, skipping --time-interval test\n";
+        return 0;
+    }
+
+    foreach my $intervals (4, 16, 64)
+    {
+        my $interval = sprintf("%g", $reference->{cp} / $intervals);
+        my $otf2_file = "$test->{tmp_dir}/$test->{trace_name}_time_interval_${intervals}.otf2";
+        my @output = run_casita($test, "-o $otf2_file --time-interval=$interval");
+        if (not (@output))
+        {
+            return 1;
+        }
+
+        my $split = grep (/without matching partner operation/, @output);
+        my $status = compare_result("--time-interval=$interval", $reference, get_result($test, \@output, $otf2_file),
+                                    $split ? \%time_cut_tolerance : undef);
+        if (not ($status == 0) || $split)
+        {
+            return $status;
+        }
+    }
+
+    print "Warning: No time cut splits a message, --time-interval tested without split messages\n";
+    return 0;
+}
+
+# write the analysis intervals on another thread (--pipeline-write)
+sub test_pipeline_write
+{
+    my ($test) = @_;
+
+    return test_mode($test, "--pipeline-write", "pipeline_write", "--pipeline-write", $test->{reference});
+}
+
+# write only the CASITA metrics (--metrics-only) and merge them with the input
+# trace (casita-merge), the waiting time is written as METRIC instead of an
+# attribute, hence only the other events are compared
+sub test_metrics_only
+{
+    my ($test) = @_;
+
+    my $overlay_file = "$test->{tmp_dir}/$test->{trace_name}_metrics.otf2";
+    my @output = run_casita($test, "-o $overlay_file --metrics-only");
+    if (not (@output))
+    {
+        return 1;
+    }
+
+    my $status = compare_result("--metrics-only", $test->{reference}, get_result($test, \@output, ""));
+    if (not ($status == 0))
+    {
+        return $status;
+    }
+
+    if (length $test->{merge} == 0)
+    {
+        print "Warning: No casita-merge, skipping merge test\n";
+        return 0;
+    }
+
+    my $merged_dir = "$test->{tmp_dir}/$test->{trace_name}_merged";
+    my $command = "$test->{merge} $test->{trace_dir}/traces.otf2 $overlay_file $merged_dir";
+    print "Executing '$command'\n";
+    my @merge_output = qx($command 2>&1);
+    $status = $? >> 8;
+    if (not ($status == 0))
+    {
+        print "@merge_output \n\n";
+        print "Error: casita-merge returned error ${status}\n";
+        return $status;
+    }
+
+    if ($test->{reference}{events} < 0)
+    {
+        return 0;
+    }
+
+    my ($input_events, $input_metrics) = count_events($test, "$test->{trace_dir}/traces.otf2");
+    my ($overlay_events, $overlay_metrics) = count_events($test, $overlay_file);
+    my ($merged_events, $merged_metrics) = count_events($test, "$merged_dir/traces.otf2");
+
+    if (not ($merged_events == $input_events + $overlay_events))
+    {
+        print "Error: casita-merge: merged trace has $merged_events events, input and overlay $input_events + $overlay_events\n";
+        return 1;
+    }
+
+    my $reference_other = $test->{reference}{events} - $test->{reference}{metrics};
+    if (not ($merged_events - $merged_metrics == $reference_other))
+    {
+        print "Error: casita-merge: merged trace has " . ($merged_events - $merged_metrics) .
+              " events without METRIC, default run $reference_other\n";
+        return 1;
+    }
+
+    return 0;
+}
+
+# write the trace cache with the first run and read the events from the cache
+# with the second run (--trace-cache)
+sub test_trace_cache
+{
+    my ($test) = @_;
+
+    my $cache_dir = "$test->{tmp_dir}/$test->{trace_name}_cache";
+    mkdir $cache_dir;
+
+    my $status = test_mode($test, "--trace-cache (write)", "cache_write", "--trace-cache=$cache_dir",
+                           $test->{reference}, "Write trace cache");
+    if (not ($status == 0))
+    {
+        return $status;
+    }
+
+    return test_mode($test, "--trace-cache (read)", "cache_read", "--trace-cache=$cache_dir",
+                     $test->{reference}, "Read events from trace cache");
+}
+
+# run casita-predict on the stored graph files, returns the output or an empty
+# list on error
+sub run_predict
+{
+    my ($test, $options) = @_;
+
+    my $command = join(" ", grep (length, $test->{predict}, $options, "$test->{graph_dir}/*.graph"));
+    print "Executing '$command'\n";
+    my @output = qx($command 2>&1);
+    my $status = $? >> 8;
+
+    if (not ($status == 0))
+    {
+        print "@output \n\n";
+        print "Error: casita-predict returned error ${status}\n";
+        return ();
+    }
+
+    return @output;
+}
+
+# store the analyzed graph (--graph-store), the critical path of the graph
+# model without removed regions has to match the default run (casita-predict)
+sub test_graph_store
+{
+    my ($test) = @_;
+
+    $test->{graph_dir} = "$test->{tmp_dir}/$test->{trace_name}_graph";
+    mkdir $test->{graph_dir};
+
+    my $status = test_mode($test, "--graph-store", "graph_store", "--graph-store=$test->{graph_dir}",
+                           $test->{reference});
+    if (not ($status == 0))
+    {
+        return $status;
+    }
+
+    if (length $test->{predict} == 0)
+    {
+        print "Warning: No casita-predict, skipping prediction tests\n";
+        return 0;
+    }
+
+    my @output = run_predict($test, "");
+    if (not (@output))
+    {
+        return 1;
+    }
+
+    foreach (@output)
+    {
+        if ($_ =~ /Critical path length: (\d+\.\d+) sec \(model: (\d+\.\d+) sec\)/)
+        {
+            if (not ($1 eq $test->{reference}{cp} && $2 eq $test->{reference}{cp}))
+            {
+                print "@output \n\n";
+                print "Error: casita-predict: critical path length ($1, model: $2) differs from the default run ($test->{reference}{cp})\n";
+                return 1;
+            }
+
+            return 0;
+        }
+    }
+
+    print "@output \n\n";
+    print "Error: casita-predict did not print the critical path length\n";
+    return 1;
+}
+
+# predicted critical path lengths of the scenarios in the casita-predict output
+sub get_predictions
+{
+    my ($output) = @_;
+
+    my @predictions = ();
+    foreach (@$output)
+    {
+        if ($_ =~ /Predicted critical path length: (\d+\.\d+) sec/)
+        {
+            push(@predictions, $1);
+        }
+    }
+
+    return @predictions;
+}
+
+# the scenarios of several --filter options are evaluated in one pass over the
+# graph, each prediction has to match the prediction of the scenario alone
+sub test_predict_scenarios
+{
+    my ($test) = @_;
+
+    if (length $test->{predict} == 0)
+    {
+        print "Warning: No casita-predict, skipping prediction scenario test\n";
+        return 0;
+    }
+
+    if (not (exists $test->{graph_dir}))
+    {
+        print "Warning: No stored graph, skipping prediction scenario test\n";
+        return 0;
+    }
+
+    # the regions with the highest ratings (names without shell characters)
+    my %ratings = %{$test->{reference}{ratings}};
+    my @regions = grep (/^[\w.:]+$/, sort { $ratings{$b} <=> $ratings{$a} } keys %ratings);
+    if ($#regions + 1 < 2)
+    {
+        print "Warning: Too few regions, skipping prediction scenario test\n";
+        return 0;
+    }
+
+    my @filters = ($regions[0], $regions[1], "$regions[0];$regions[1]");
+
+    my @output = run_predict($test, join(" ", map { "'--filter=$_'" } @filters));
+    if (not (@output))
+    {
+        return 1;
+    }
+
+    my @predictions = get_predictions(\@output);
+    if (not ($#predictions == $#filters))
+    {
+        print "@output \n\n";
+        print "Error: casita-predict printed " . ($#predictions + 1) . " predictions for " . ($#filters + 1) . " scenarios\n";
+        return 1;
+    }
+
+    for (my $i = 0; $i <= $#filters; $i++)
+    {
+        my @single_output = run_predict($test, "'--filter=$filters[$i]'");
+        my @single = get_predictions(\@single_output);
+        if (not ($#single == 0 && $single[0] eq $predictions[$i]))
+        {
+            my $prediction = $#single == 0 ? $single[0] : "none";
+            print "Error: casita-predict: prediction for --filter=$filters[$i] ($predictions[$i]) differs from the single scenario ($prediction)\n";
+            return 1;
+        }
+    }
+
+    return 0;
+}
+
+# run the modes of CASITA on the trace and compare them with the default run
+sub test_modes
+{
+    my ($test) = @_;
+
+    my @mode_tests = (\&test_baseline,
+                      \&test_event_buffer,
+                      \&test_parallel_read,
+                      \&test_interval_analysis,
+                      \&test_memory_limit,
+                      \&test_bulk_p2p,
+                      \&test_m_to_n,
+                      \&test_time_interval,
+                      \&test_pipeline_write,
+                      \&test_metrics_only,
+                      \&test_trace_cache,
+                      \&test_graph_store,
+                      \&test_predict_scenarios);
+
+    foreach my $mode_test (@mode_tests)
+    {
+        my $result = $mode_test->($test);
+        if (not ($result == 0))
+        {
+            return $result;
+        }
+    }
+
+    return 0;
+}
+
 sub test_trace
 {
     my $full_trace_dir = $ARGV[0];
@@ -36,8 +691,8 @@ sub test_trace
 
     my $nprocs = $1;
     my $trace_name = $2;
-    print "Executing 'mpirun -n $nprocs casita ${full_trace_dir}/traces.otf2 -o $tmp_dir/${trace_name}.otf2 --verbose=1'\n";
-    my @output = qx(mpirun -n $nprocs casita ${full_trace_dir}/traces.otf2 -o $tmp_dir/${trace_name}.otf2 --verbose=1 2>&1);
+    print "Executing 'mpirun -n $nprocs $casita ${full_trace_dir}/traces.otf2 -o $tmp_dir/${trace_name}.otf2 --verbose=1'\n";
+    my @output = qx(mpirun -n $nprocs $casita ${full_trace_dir}/traces.otf2 -o $tmp_dir/${trace_name}.otf2 --verbose=1 2>&1);
     my $status = $? >> 8;
 
     if (not ($status == 0))
@@ -154,18 +809,36 @@ sub test_trace
         }
     }
 
+    # the output traces of large input traces are not validated
+    my $otf2_size = trace_size($full_trace_dir);
+    my $validate = ($num_args > 3 && length $otf2_print > 0 && $otf2_size <= 300000);
+
+    # run the modes of CASITA and compare them with the default run
+    my %test = (trace_dir  => $full_trace_dir,
+                casita     => $casita,
+                tmp_dir    => $tmp_dir,
+                nprocs     => $nprocs,
+                trace_name => $trace_name,
+                otf2_print => $validate ? $otf2_print : "",
+                merge      => $num_args > 4 ? $ARGV[4] : "",
+                predict    => $num_args > 5 ? $ARGV[5] : "",
+                baseline   => $num_args > 6 ? $ARGV[6] : "");
+    $test{reference} = get_result(\%test, \@output, "$tmp_dir/${trace_name}.otf2");
+
+    my $modes_status = test_modes(\%test);
+    if (not ($modes_status == 0))
+    {
+        return $modes_status;
+    }
+
     # run otf2-print on trace
     if ($num_args > 3 && length $otf2_print > 0)
     {
         # check trace file size
-        my $otf2_size = qx(du -s ${full_trace_dir});
-        if ( $otf2_size =~ m/^(\d+)*/ ) {
-          if( $1 > 300000 ){
-            print "Input trace ($1 K) is too large  for validation check!\n";
-            return 0;
-          }
+        if( $otf2_size > 300000 ){
+          print "Input trace ($otf2_size K) is too large  for validation check!\n";
+          return 0;
         }
-        
     
         my @otf2_output = qx($otf2_print $tmp_dir/${trace_name}.otf2 2>&1);
         my $otf2_status = $? >> 8;
@@ -196,7 +869,7 @@ sub main
     if ($num_args < 3)
     {
         print "Error: Invalid number of arguments.\n";
-        print "Usage: test_trace.pl <casita-binary> <trace-dir> <tmp-dir> [<otf2-binary>]\n";
+        print "Usage: test_trace.pl <trace-dir> <casita-binary> <tmp-dir> [<otf2-binary> [<casita-merge> [<casita-predict> [<casita-baseline>]]]]\n";
         exit 1;
     }
 